@@ -1,4 +1,16 @@
 ﻿#include "ApiManager.h"
+#include "LogCategories.h"
+#include <algorithm>
+#include <QGuiApplication>
+
+namespace {
+/// @brief 请求统计快照路径
+const char* const kMetricsPath = "AppData/metrics/request_metrics.json";
+/// @brief 统计发布间隔（毫秒）
+const int kMetricsIntervalMs = 5000;
+/// @brief 每发布多少次保存一次快照
+const int kMetricsSaveEveryTicks = 12;
+}
 
 /**
  * @brief 构造函数
@@ -12,12 +24,63 @@ ApiManager::ApiManager(QObject *parent)
     , m_networkManager(new QNetworkAccessManager(this))
     , m_internalBaseUrl("http://172.20.117.53:9898/api")  // 默认内网地址
     , m_publicBaseUrl("http://111.6.178.34:24603/api")   // 默认公网地址
+#ifdef QT_DEBUG
+    , m_logBodies(true)        // 调试版本默认记录请求/响应体
+#else
+    , m_logBodies(false)       // 发布版本默认不记录请求/响应体
+#endif
+    , m_bodyLogLimit(2048)
+    , m_metricsTicks(0)
+    , m_metricsUnsaved(false)
+    , m_keepAliveSeconds(30)
+    , m_sessionActive(false)
 {
+    std::fill(m_requestCounts, m_requestCounts + RequestTypeCount, 0);
+    
+    // 在上次保存的统计上继续累加
+    m_metrics.load(kMetricsPath);
+    m_requestMetrics = m_metrics.toJson().toVariantMap();
+    m_metricsTimer.setInterval(kMetricsIntervalMs);
+    connect(&m_metricsTimer, &QTimer::timeout, this, &ApiManager::publishMetrics);
+    m_metricsTimer.start();
+    if (QCoreApplication::instance()) {
+        connect(QCoreApplication::instance(), &QCoreApplication::aboutToQuit, this, [this]() {
+            publishMetrics();
+            if (m_metricsUnsaved && m_metrics.save(kMetricsPath)) {
+                m_metricsUnsaved = false;
+            }
+        });
+    }
+    
     // 从配置文件加载配置
     loadConfig();
     
     connect(m_networkManager, &QNetworkAccessManager::finished,
             this, &ApiManager::onNetworkReply);
+    
+    // 预连接：启动时、登录成功后、切换网络后
+    m_lastActivity.start();
+    warmUpConnection();
+    connect(this, &ApiManager::usePublicNetworkChanged, this, &ApiManager::warmUpConnection);
+    connect(this, &ApiManager::loginResponse, this, [this](bool success, const QString&, const QJsonObject&) {
+        if (success) {
+            warmUpConnection();
+            setSessionActive(true);
+        }
+    });
+    
+    // 保活只在已登录且程序处于前台时进行，回到前台时先预连接；按半个保活间隔检查一次是否空闲
+    m_keepAliveTimer.setInterval(qMax(5, m_keepAliveSeconds / 2) * 1000);
+    connect(&m_keepAliveTimer, &QTimer::timeout, this, &ApiManager::onKeepAliveTimeout);
+    if (auto* guiApp = qobject_cast<QGuiApplication*>(QCoreApplication::instance())) {
+        connect(guiApp, &QGuiApplication::applicationStateChanged, this, [this](Qt::ApplicationState state) {
+            if (state == Qt::ApplicationActive && m_sessionActive
+                && m_lastActivity.elapsed() >= m_keepAliveSeconds * 1000LL) {
+                warmUpConnection();
+            }
+            updateKeepAliveTimer();
+        });
+    }
 }
 
 /**
@@ -56,52 +119,300 @@ QNetworkRequest ApiManager::createRequest(const QString& endpoint, bool setJsonC
     
     request.setRawHeader("User-Agent", "ScoreReport/1.0");
     
-    qDebug() << "[ApiManager] Creating request to:" << url.toString();
+    LOG_DEBUG(lcNet) << "[ApiManager] Creating request to:" << url.toString();
     return request;
 }
 
+/**
+ * @brief 按配置记录请求/响应体
+ * @param label 日志前缀
+ * @param body 请求或响应的原始字节
+ * 
+ * 关闭body日志时不做任何格式化；超过上限的内容只记录前 m_bodyLogLimit 个字节及总长度，
+ * 避免多MB的提示词或下载文件被完整写入日志。
+ */
+void ApiManager::logBody(const char* label, const QByteArray& body) const
+{
+    if (!m_logBodies) {
+        return;
+    }
+    
+    if (m_bodyLogLimit > 0 && body.size() > m_bodyLogLimit) {
+        // 截断位置落在多字节字符中间时退回到该字符的起始字节（跳过 10xxxxxx 后续字节），避免日志出现乱码
+        int cut = m_bodyLogLimit;
+        while (cut > 0 && (static_cast<uchar>(body.at(cut)) & 0xC0) == 0x80) {
+            --cut;
+        }
+        LOG_DEBUG(lcNet).noquote() << "[ApiManager]" << label << QString::fromUtf8(body.constData(), cut)
+                                   << QStringLiteral("... (truncated, %1 bytes total)").arg(body.size());
+    } else {
+        LOG_DEBUG(lcNet).noquote() << "[ApiManager]" << label << QString::fromUtf8(body);
+    }
+}
+
+/**
+ * @brief 请求类型描述表
+ * 
+ * 按 RequestType 枚举顺序排列，每一项记录请求名称（用于日志和X-Request-Type请求头）
+ * 以及完成时要发出的响应信号。新增接口时只需在枚举和此表中各加一项。
+ * 流式聊天和文件下载的响应由专门的流程处理，这里的信号只用于错误回调。
+ */
+const ApiManager::RequestDescriptor ApiManager::s_requestTable[ApiManager::RequestTypeCount] = {
+    { "",                            nullptr,                                        false },
+    { "login",                       &ApiManager::loginResponse,                     false },
+    { "register",                    &ApiManager::registerResponse,                  false },
+    { "test-connection",             &ApiManager::emitConnectionTestResult,          false },
+    { "tnm-ai-score",                &ApiManager::tnmAiQualityScoreResponse,         false },
+    { "renal-ai-score",              &ApiManager::renalAiQualityScoreResponse,       false },
+    { "stream-chat",                 nullptr,                                        false },
+    { "stream-knowledge-chat",       nullptr,                                        false },
+    { "delete-chat",                 &ApiManager::deleteChatResponse,                false },
+    { "add-quality-record",          &ApiManager::addQualityRecordResponse,          false },
+    { "get-quality-list",            &ApiManager::getQualityListResponse,            false },
+    { "cancer-diagnose-type",        &ApiManager::cancerDiagnoseTypeResponse,        false },
+    { "save-report-template",        &ApiManager::saveReportTemplateResponse,        false },
+    { "delete-report-template",      &ApiManager::deleteReportTemplateResponse,      false },
+    { "generate-quality-report",     &ApiManager::generateQualityReportResponse,     false },
+    { "get-report-template-list",    &ApiManager::getReportTemplateListResponse,     true  },
+    { "upload-file",                 &ApiManager::uploadFileResponse,                false },
+    { "create-knowledge-base",       &ApiManager::createKnowledgeBaseResponse,       false },
+    { "delete-knowledge-base",       &ApiManager::deleteKnowledgeBaseResponse,       false },
+    { "update-knowledge-base",       &ApiManager::updateKnowledgeBaseResponse,       false },
+    { "get-knowledge-base",          &ApiManager::getKnowledgeBaseResponse,          false },
+    { "get-knowledge-base-list",     &ApiManager::getKnowledgeBaseListResponse,      false },
+    { "delete-knowledge-base-files", &ApiManager::deleteKnowledgeBaseFilesResponse,  false },
+    { "get-system-update-list",      &ApiManager::getSystemUpdateListResponse,       true  },
+    { "download-app-file",           &ApiManager::downloadAppFileResponse,           false },
+    { "keep-alive",                  nullptr,                                        false },
+};
+
+/**
+ * @brief 为请求打上类型标记
+ * @param request 待发送的请求
+ * @param requestType 请求类型
+ * 
+ * 类型以整数形式保存在请求属性中，响应时直接读取，无需再解析请求头。
+ * X-Request-Type请求头仍然保留发送给服务器。
+ */
+void ApiManager::tagRequest(QNetworkRequest& request, RequestType requestType) const
+{
+    request.setAttribute(kRequestTypeAttribute, static_cast<int>(requestType));
+    if (requestType != UnknownRequest) {
+        request.setRawHeader("X-Request-Type", s_requestTable[requestType].name);
+    }
+}
+
+/**
+ * @brief 读取回复对应的请求类型
+ * @param reply 网络回复对象
+ * @return 请求类型，未标记时返回 UnknownRequest
+ */
+ApiManager::RequestType ApiManager::requestTypeOf(QNetworkReply* reply)
+{
+    int type = reply->request().attribute(kRequestTypeAttribute, UnknownRequest).toInt();
+    return (type > UnknownRequest && type < RequestTypeCount) ? static_cast<RequestType>(type) : UnknownRequest;
+}
+
+/**
+ * @brief 获取指定类型已完成的请求数
+ * @param requestType 请求类型
+ * @return 自程序启动以来该类型请求完成（含失败）的次数
+ */
+int ApiManager::requestCount(RequestType requestType) const
+{
+    return (requestType >= 0 && requestType < RequestTypeCount) ? m_requestCounts[requestType] : 0;
+}
+
+/**
+ * @brief 带上传ID的回复发出 uploadFileFinished 信号
+ * @param reply 网络回复对象
+ * @param success 是否上传成功
+ * @param retryable 失败是否可以重试
+ * @param message 服务器返回的消息或错误描述
+ * @param data 上传结果数据
+ * @return 回复没有上传ID时返回false
+ */
+bool ApiManager::emitUploadFinished(QNetworkReply* reply, bool success, bool retryable, const QString& message, const QJsonObject& data)
+{
+    QString uploadId = reply->request().attribute(kUploadIdAttribute).toString();
+    if (uploadId.isEmpty()) {
+        return false;
+    }
+    emit uploadFileFinished(uploadId, success, retryable, message, data);
+    return true;
+}
+
+/**
+ * @brief 连接测试结果的响应适配
+ * 
+ * connectionTestResult 信号没有data参数，通过此函数接入统一的响应分发表。
+ */
+void ApiManager::emitConnectionTestResult(bool success, const QString& message, const QJsonObject& data)
+{
+    Q_UNUSED(data);
+    emit connectionTestResult(success, message);
+}
+
 /**
  * @brief 发送POST请求的通用方法
  * @param endpoint API端点路径
  * @param data 要发送的JSON数据
- * @param requestType 请求类型标识，用于在响应时区分不同的请求
+ * @param requestType 请求类型，用于在响应时区分不同的请求
  * 
  * 将JSON数据序列化为字节数组并发送POST请求。
- * requestType会被添加到请求头中，便于在onNetworkReply中识别响应类型。
+ * requestType会被保存在请求上，便于在onNetworkReply中直接查表分发响应。
  */
-void ApiManager::makePostRequest(const QString& endpoint, const QJsonObject& data, const QString& requestType)
+void ApiManager::makePostRequest(const QString& endpoint, const QJsonObject& data, RequestType requestType)
 {
     QNetworkRequest request = createRequest(endpoint);
     
     // 添加请求类型标识，用于在回复中区分不同的请求
-    if (!requestType.isEmpty()) {
-        request.setRawHeader("X-Request-Type", requestType.toUtf8());
-    }
+    tagRequest(request, requestType);
     
-    QByteArray body = QJsonDocument(data).toJson(QJsonDocument::Indented);
-    qDebug().noquote() << "[ApiManager] POST request body:" << QString::fromUtf8(body);
+    QByteArray body = QJsonDocument(data).toJson(QJsonDocument::Compact);
+    logBody("POST request body:", body);
     
     QNetworkReply* reply = m_networkManager->post(request, body);
-    m_activeReplies.insert(reply);  // 跟踪活跃的请求
+    trackReply(reply, body.size());  // 跟踪活跃的请求
 }
 
 /**
  * @brief 发送GET请求的通用方法
  * @param endpoint API端点路径
- * @param requestType 请求类型标识
+ * @param requestType 请求类型
  * 
  * 发送GET请求，主要用于查询操作。
  */
-void ApiManager::makeGetRequest(const QString& endpoint, const QString& requestType)
+void ApiManager::makeGetRequest(const QString& endpoint, RequestType requestType)
 {
     QNetworkRequest request = createRequest(endpoint);
+    tagRequest(request, requestType);
+    
+    QNetworkReply* reply = m_networkManager->get(request);
+    trackReply(reply);  // 跟踪活跃的请求
+}
+
+/**
+ * @brief 跟踪已发出的请求
+ * @param reply 网络回复对象
+ * @param bytesOut 请求体字节数
+ * 
+ * Qt 5 不提供DNS和TCP连接的单独耗时，不统计连接阶段；
+ * 首字节以收到响应头（metaDataChanged）为准，其中包含连接建立的时间。
+ */
+void ApiManager::trackReply(QNetworkReply* reply, qint64 bytesOut)
+{
+    m_activeReplies.insert(reply);
+    m_lastActivity.restart();
     
-    if (!requestType.isEmpty()) {
-        request.setRawHeader("X-Request-Type", requestType.toUtf8());
+    // 保活请求不代表用户操作，不计入统计
+    const RequestType requestType = requestTypeOf(reply);
+    if (requestType == KeepAlive) {
+        return;
     }
     
-    QNetworkReply* reply = m_networkManager->get(request);
-    m_activeReplies.insert(reply);  // 跟踪活跃的请求
+    m_metrics.start(reply, s_requestTable[requestType].name, networkName());
+    m_metrics.updateBytes(reply, 0, bytesOut);
+    connect(reply, &QNetworkReply::uploadProgress, this, [this, reply](qint64 bytesSent, qint64 bytesTotal) {
+        Q_UNUSED(bytesTotal);
+        m_metrics.updateBytes(reply, 0, bytesSent);
+    });
+    connect(reply, &QNetworkReply::metaDataChanged, this, [this, reply]() {
+        m_metrics.markPhase(reply, RequestMetrics::FirstBytePhase);
+    });
+    connect(reply, &QNetworkReply::downloadProgress, this, [this, reply](qint64 bytesReceived, qint64 bytesTotal) {
+        Q_UNUSED(bytesTotal);
+        m_metrics.updateBytes(reply, bytesReceived, 0);
+    });
+}
+
+/**
+ * @brief 预先建立到当前API地址的连接
+ * 
+ * 连接建立后放入QNetworkAccessManager的连接池，同一主机的下一个请求直接复用。
+ * https地址同时完成TLS握手。
+ */
+void ApiManager::warmUpConnection()
+{
+    const QUrl baseUrl(getBaseUrl());
+    if (!baseUrl.isValid() || baseUrl.host().isEmpty()) {
+        return;
+    }
+    
+    if (baseUrl.scheme() == QLatin1String("https")) {
+        m_networkManager->connectToHostEncrypted(baseUrl.host(), static_cast<quint16>(baseUrl.port(443)));
+    } else {
+        m_networkManager->connectToHost(baseUrl.host(), static_cast<quint16>(baseUrl.port(80)));
+    }
+    m_lastActivity.restart();
+    LOG_DEBUG(lcNet) << "[ApiManager] Pre-connecting to:" << baseUrl.host() << baseUrl.port();
+}
+
+/**
+ * @brief 保活定时器处理函数
+ * 
+ * 有请求在进行或最近发出过请求时不做任何事；空闲超过 m_keepAliveSeconds 时
+ * 对系统更新列表接口（已有的轻量GET接口）发送一个HEAD请求，没有响应体，只用于保持连接，结果直接丢弃。
+ */
+void ApiManager::onKeepAliveTimeout()
+{
+    if (!m_sessionActive || !m_activeReplies.isEmpty() || m_lastActivity.elapsed() < m_keepAliveSeconds * 1000LL) {
+        return;
+    }
+    
+    QNetworkRequest request(QUrl(getBaseUrl() + "/system-updates/list?appType=1"));
+    request.setRawHeader("User-Agent", "ScoreReport/1.0");
+    tagRequest(request, KeepAlive);
+    trackReply(m_networkManager->head(request));
+}
+
+/**
+ * @brief 设置是否有已登录的会话
+ * @param active 是否已登录
+ */
+void ApiManager::setSessionActive(bool active)
+{
+    if (m_sessionActive == active) {
+        return;
+    }
+    m_sessionActive = active;
+    updateKeepAliveTimer();
+}
+
+void ApiManager::updateKeepAliveTimer()
+{
+    const bool foreground = QGuiApplication::applicationState() == Qt::ApplicationActive;
+    if (m_sessionActive && foreground && m_keepAliveSeconds > 0) {
+        if (!m_keepAliveTimer.isActive()) {
+            m_keepAliveTimer.start();
+        }
+    } else {
+        m_keepAliveTimer.stop();
+    }
+}
+
+QString ApiManager::networkName() const
+{
+    return getusePublicNetwork() ? QStringLiteral("public") : QStringLiteral("internal");
+}
+
+/**
+ * @brief 发布请求统计
+ * 
+ * 有新数据时更新 requestMetrics 属性，每 kMetricsSaveEveryTicks 次检查保存一次快照。
+ */
+void ApiManager::publishMetrics()
+{
+    if (m_metrics.takeDirty()) {
+        setrequestMetrics(m_metrics.toJson().toVariantMap());
+        m_metricsUnsaved = true;
+    }
+    
+    if (++m_metricsTicks % kMetricsSaveEveryTicks == 0 && m_metricsUnsaved) {
+        if (m_metrics.save(kMetricsPath)) {
+            m_metricsUnsaved = false;
+        }
+    }
 }
 
 /**
@@ -118,7 +429,7 @@ void ApiManager::loginUser(const QString& username, const QString& password)
     loginData["userAccount"] = username;
     loginData["userPassword"] = password;
     
-    makePostRequest("/admin/user/login", loginData, "login");
+    makePostRequest("/admin/user/login", loginData, Login);
 }
 
 /**
@@ -137,7 +448,7 @@ void ApiManager::registerUser(const QString& userAccount, const QString& userPas
     registerData["userPassword"] = userPassword;
     registerData["checkPassword"] = checkPassword;
     
-    makePostRequest("/admin/user/register", registerData, "register");
+    makePostRequest("/admin/user/register", registerData, Register);
 }
 
 /**
@@ -158,7 +469,7 @@ void ApiManager::getTnmAiQualityScore(const QString& chatId, const QString& user
     requestData["language"] = language;
     requestData["diagnoseType"] = diagnoseType;
     
-    makePostRequest("/admin/Ai/get/aiQualityScore", requestData, "tnm-ai-score");
+    makePostRequest("/admin/Ai/get/aiQualityScore", requestData, TnmAiScore);
 }
 
 /**
@@ -178,7 +489,7 @@ void ApiManager::getRenalAiQualityScore(const QString& chatId, const QString& us
     requestData["content"] = content;
     requestData["language"] = language;
     
-    makePostRequest("/admin/Ai/get/aiQualityScore", requestData, "renal-ai-score");
+    makePostRequest("/admin/Ai/get/aiQualityScore", requestData, RenalAiScore);
 }
 
 /**
@@ -202,20 +513,7 @@ void ApiManager::streamChat(const QString& query, const QString& userId, const Q
         requestData["chatId"] = chatId;
     }
     
-    QNetworkRequest request = createRequest("/admin/Ai/chat");
-    request.setRawHeader("X-Request-Type", "stream-chat");
-    
-    QByteArray body = QJsonDocument(requestData).toJson(QJsonDocument::Indented);
-    qDebug().noquote() << "[ApiManager] Stream chat request body:" << QString::fromUtf8(body);
-    
-    QNetworkReply* reply = m_networkManager->post(request, body);
-    m_activeReplies.insert(reply);
-    
-    // 保存chatId映射，用于在接收数据时识别会话
-    m_streamChatIds[reply] = chatId;
-    
-    // 连接流式数据读取信号
-    connect(reply, &QNetworkReply::readyRead, this, &ApiManager::onStreamDataReady);
+    startStream(StreamSession::Chat, "/admin/Ai/chat", requestData, chatId);
 }
 
 /**
@@ -248,20 +546,7 @@ void ApiManager::streamKnowledgeChat(const QString& query, const QString& userId
         requestData["chatId"] = chatId;
     }
     
-    QNetworkRequest request = createRequest("/admin/Ai/doc/chat");
-    request.setRawHeader("X-Request-Type", "stream-knowledge-chat");
-    
-    QByteArray body = QJsonDocument(requestData).toJson(QJsonDocument::Indented);
-    qDebug().noquote() << "[ApiManager] Stream knowledge chat request body:" << QString::fromUtf8(body);
-    
-    QNetworkReply* reply = m_networkManager->post(request, body);
-    m_activeReplies.insert(reply);
-    
-    // 保存chatId映射，用于在接收数据时识别会话
-    m_streamKnowledgeChatIds[reply] = chatId;
-    
-    // 连接流式数据读取信号
-    connect(reply, &QNetworkReply::readyRead, this, &ApiManager::onStreamKnowledgeDataReady);
+    startStream(StreamSession::KnowledgeChat, "/admin/Ai/doc/chat", requestData, chatId);
 }
 
 /**
@@ -276,7 +561,7 @@ void ApiManager::deleteChatById(const QString& chatId)
     QJsonObject requestData;
     requestData["chatId"] = chatId;
     
-    makePostRequest("/admin/Ai/delete/chat", requestData, "delete-chat");
+    makePostRequest("/admin/Ai/delete/chat", requestData, DeleteChat);
 }
 
 /**
@@ -304,7 +589,7 @@ void ApiManager::addQualityRecord(const QString& type, const QString& title, con
         requestData["chatId"] = chatId;
     }
     
-    makePostRequest("/quality/add", requestData, "add-quality-record");
+    makePostRequest("/quality/add", requestData, AddQualityRecord);
 }
 
 /**
@@ -346,7 +631,7 @@ void ApiManager::getQualityList(const QString& type, const QString& title, const
     requestData["current"] = current;
     requestData["pageSize"] = pageSize;
     
-    makePostRequest("/quality/list", requestData, "get-quality-list");
+    makePostRequest("/quality/list", requestData, GetQualityList);
 }
 
 /**
@@ -363,7 +648,7 @@ void ApiManager::getCancerDiagnoseType(const QString& content, const QString& la
     requestData["content"] = content;
     requestData["language"] = language;
     
-    makePostRequest("/admin/Ai/cancerDiagnoseType", requestData, "cancer-diagnose-type");
+    makePostRequest("/admin/Ai/cancerDiagnoseType", requestData, CancerDiagnoseType);
 }
 
 /**
@@ -386,7 +671,7 @@ void ApiManager::saveReportTemplate(const QString& templateContent, const QStrin
         requestData["id"] = templateId;
     }
     
-    makePostRequest("/report/template/save", requestData, "save-report-template");
+    makePostRequest("/report/template/save", requestData, SaveReportTemplate);
 }
 
 /**
@@ -401,7 +686,7 @@ void ApiManager::deleteReportTemplate(const QString& templateId)
     QJsonObject requestData;
     requestData["id"] = templateId;
     
-    makePostRequest("/report/template/delete", requestData, "delete-report-template");
+    makePostRequest("/report/template/delete", requestData, DeleteReportTemplate);
 }
 
 /**
@@ -420,7 +705,7 @@ void ApiManager::generateQualityReport(const QString& query, const QString& temp
     requestData["template"] = templateContent;
     requestData["language"] = language;
     
-    makePostRequest("/report/template/generateReport", requestData, "generate-quality-report");
+    makePostRequest("/report/template/generateReport", requestData, GenerateQualityReport);
 }
 
 /**
@@ -431,7 +716,7 @@ void ApiManager::generateQualityReport(const QString& query, const QString& temp
  */
 void ApiManager::getReportTemplateList()
 {
-    makeGetRequest("/report/template/list", "get-report-template-list");
+    makeGetRequest("/report/template/list", GetReportTemplateList);
 }
 
 /**
@@ -439,26 +724,37 @@ void ApiManager::getReportTemplateList()
  * @param filePath 要上传的文件路径
  * @param knowledgeBaseId 知识库ID
  * @param userId 用户ID（可选）
+ * @param uploadId 上传ID（可选）
  * 
  * 发送文件上传请求到服务器的 /ai/knowledge/file/upload 端点。
  * 使用multipart/form-data格式上传文件。
- * 请求类型标记为 "upload-file"，结果会通过 uploadFileResponse 信号返回。
+ * 请求类型标记为 "upload-file"，未指定uploadId时结果会通过 uploadFileResponse 信号返回；
+ * 指定uploadId时上传ID保存在请求上，进度和结果通过 uploadFileProgress / uploadFileFinished 按ID返回。
  */
-void ApiManager::uploadFileToKnowledgeBase(const QString& filePath, const QString& knowledgeBaseId, const QString& userId)
+void ApiManager::uploadFileToKnowledgeBase(const QString& filePath, const QString& knowledgeBaseId, const QString& userId,
+                                           const QString& uploadId)
 {
+    auto fail = [this, &uploadId](const QString& message) {
+        if (uploadId.isEmpty()) {
+            emit uploadFileResponse(false, message, QJsonObject());
+        } else {
+            emit uploadFileFinished(uploadId, false, false, message, QJsonObject());
+        }
+    };
+    
     // 检查文件是否存在
     QFileInfo fileInfo(filePath);
     if (!fileInfo.exists() || !fileInfo.isFile()) {
-        qWarning() << "[ApiManager] File does not exist:" << filePath;
-        emit uploadFileResponse(false, "文件不存在或不是有效的文件", QJsonObject());
+        LOG_WARNING(lcFile) << "[ApiManager] File does not exist:" << filePath;
+        fail("文件不存在或不是有效的文件");
         return;
     }
     
     // 打开文件
     QFile* file = new QFile(filePath);
     if (!file->open(QIODevice::ReadOnly)) {
-        qWarning() << "[ApiManager] Cannot open file:" << filePath;
-        emit uploadFileResponse(false, "无法打开文件进行读取", QJsonObject());
+        LOG_WARNING(lcFile) << "[ApiManager] Cannot open file:" << filePath;
+        fail("无法打开文件进行读取");
         file->deleteLater();
         return;
     }
@@ -492,15 +788,24 @@ void ApiManager::uploadFileToKnowledgeBase(const QString& filePath, const QStrin
     
     // 创建请求 - 不设置JSON Content-Type，让Qt自动设置multipart/form-data
     QNetworkRequest request = createRequest("/ai/knowledge/file/upload", false);
-    request.setRawHeader("X-Request-Type", "upload-file");
+    tagRequest(request, UploadFile);
+    if (!uploadId.isEmpty()) {
+        request.setAttribute(kUploadIdAttribute, uploadId);
+    }
     
     // 发送请求
     QNetworkReply* reply = m_networkManager->post(request, multiPart);
     multiPart->setParent(reply);
-    m_activeReplies.insert(reply);
+    trackReply(reply, fileInfo.size());
+    
+    if (!uploadId.isEmpty()) {
+        connect(reply, &QNetworkReply::uploadProgress, this, [this, uploadId](qint64 bytesSent, qint64 bytesTotal) {
+            emit uploadFileProgress(uploadId, bytesSent, bytesTotal);
+        });
+    }
     
-    qDebug() << "[ApiManager] Uploading file:" << filePath 
-             << "to knowledge base:" << knowledgeBaseId;
+    LOG_DEBUG(lcFile) << "[ApiManager] Uploading file:" << filePath 
+                      << "to knowledge base:" << knowledgeBaseId;
 }
 
 /**
@@ -523,8 +828,8 @@ void ApiManager::createKnowledgeBase(const QString& name, const QString& descrip
         requestData["description"] = description;
     }
     
-    makePostRequest("/ai/knowledge/add", requestData, "create-knowledge-base");
-    qDebug() << "[ApiManager] Creating knowledge base with name:" << name;
+    makePostRequest("/ai/knowledge/add", requestData, CreateKnowledgeBase);
+    LOG_DEBUG(lcFile) << "[ApiManager] Creating knowledge base with name:" << name;
 }
 
 /**
@@ -537,8 +842,8 @@ void ApiManager::createKnowledgeBase(const QString& name, const QString& descrip
 void ApiManager::deleteKnowledgeBase(const QString& id)
 {
     QString endpoint = QString("/ai/knowledge/delete?id=%1").arg(id);
-    makePostRequest(endpoint, QJsonObject(), "delete-knowledge-base");
-    qDebug() << "[ApiManager] Deleting knowledge base with id:" << id;
+    makePostRequest(endpoint, QJsonObject(), DeleteKnowledgeBase);
+    LOG_DEBUG(lcFile) << "[ApiManager] Deleting knowledge base with id:" << id;
 }
 
 /**
@@ -565,8 +870,8 @@ void ApiManager::updateKnowledgeBase(const QString& id, const QString& name, con
         requestData["description"] = description;
     }
     
-    makePostRequest("/ai/knowledge/update", requestData, "update-knowledge-base");
-    qDebug() << "[ApiManager] Updating knowledge base with id:" << id << "name:" << name;
+    makePostRequest("/ai/knowledge/update", requestData, UpdateKnowledgeBase);
+    LOG_DEBUG(lcFile) << "[ApiManager] Updating knowledge base with id:" << id << "name:" << name;
 }
 
 /**
@@ -579,8 +884,8 @@ void ApiManager::updateKnowledgeBase(const QString& id, const QString& name, con
 void ApiManager::getKnowledgeBase(const QString& id)
 {
     QString endpoint = QString("/ai/knowledge/get?id=%1").arg(id);
-    makeGetRequest(endpoint, "get-knowledge-base");
-    qDebug() << "[ApiManager] Getting knowledge base with id:" << id;
+    makeGetRequest(endpoint, GetKnowledgeBase);
+    LOG_DEBUG(lcFile) << "[ApiManager] Getting knowledge base with id:" << id;
 }
 
 /**
@@ -622,8 +927,8 @@ void ApiManager::getKnowledgeBaseList(int current, int pageSize, const QString&
         requestData["userId"] = userId;
     }
     
-    makePostRequest("/ai/knowledge/list/page", requestData, "get-knowledge-base-list");
-    qDebug() << "[ApiManager] Getting knowledge base list, page:" << current << "size:" << pageSize;
+    makePostRequest("/ai/knowledge/list/page", requestData, GetKnowledgeBaseList);
+    LOG_DEBUG(lcFile) << "[ApiManager] Getting knowledge base list, page:" << current << "size:" << pageSize;
 }
 
 /**
@@ -636,15 +941,15 @@ void ApiManager::getKnowledgeBaseList(int current, int pageSize, const QString&
 void ApiManager::deleteKnowledgeBaseFiles(const QList<QString>& ids)
 {
     if (ids.isEmpty()) {
-        qWarning() << "[ApiManager] Cannot delete files: empty id list";
+        LOG_WARNING(lcFile) << "[ApiManager] Cannot delete files: empty id list";
         emit deleteKnowledgeBaseFilesResponse(false, "文件ID列表为空", QJsonObject());
         return;
     }
     
     // 构建查询字符串 - 直接使用字符串ID列表
     QString endpoint = QString("/ai/knowledge/file/delete?ids=%1").arg(ids.join(","));
-    makePostRequest(endpoint, QJsonObject(), "delete-knowledge-base-files");
-    qDebug() << "[ApiManager] Deleting knowledge base files with ids:" << ids.join(",");
+    makePostRequest(endpoint, QJsonObject(), DeleteKnowledgeBaseFiles);
+    LOG_DEBUG(lcFile) << "[ApiManager] Deleting knowledge base files with ids:" << ids.join(",");
 }
 
 /**
@@ -658,7 +963,7 @@ void ApiManager::getSystemUpdateList(int appType)
 {
     // 创建带参数的GET请求
     QString endpoint = QString("/system-updates/list?appType=%1").arg(appType);
-    makeGetRequest(endpoint, "get-system-update-list");
+    makeGetRequest(endpoint, GetSystemUpdateList);
 }
 
 /**
@@ -667,329 +972,293 @@ void ApiManager::getSystemUpdateList(int appType)
  * 
  * 发送下载App文件请求到服务器的 /system-updates/download/app 端点。
  * 请求类型标记为 "download-app-file"，结果会通过 downloadAppFileResponse 信号返回。
+ * 临时目录中有上次中断留下的部分文件时，只请求剩余部分（HTTP Range）。
  */
 void ApiManager::downloadAppFile(const QString& fileName)
 {
     // 创建带参数的GET请求
     QString endpoint = QString("/system-updates/download/app?fileName=%1").arg(fileName);
-    makeGetRequest(endpoint, "download-app-file");
+    QNetworkRequest request = createRequest(endpoint);
+    tagRequest(request, DownloadAppFile);
+    
+    // 保存到临时目录，只取文件名部分，避免服务器文件名中带路径
+    QString tempDir = QStandardPaths::writableLocation(QStandardPaths::TempLocation);
+    QDir().mkpath(tempDir);
+    QString saveName = QFileInfo(fileName).fileName();
+    if (saveName.isEmpty()) {
+        saveName = "update_file.exe";  // 默认文件名
+    }
+    
+    // 数据到达时逐块写入磁盘，不在内存中缓存整个安装包
+    DownloadSession* session = new DownloadSession(tempDir + "/" + saveName);
+    if (!session->open()) {
+        LOG_WARNING(lcFile) << "[ApiManager] Failed to create temp file:" << session->filePath();
+        delete session;
+        emit downloadAppFileResponse(false, "无法创建临时文件", QJsonObject());
+        return;
+    }
+    session->prepareRequest(request);
+    
+    QNetworkReply* reply = m_networkManager->get(request);
+    trackReply(reply);
+    session->attach(reply);
+    
+    connect(reply, &QNetworkReply::readyRead, session, [this, session]() {
+        onDownloadDataReady(session);
+    });
+    // 续传时Qt报告的是本次请求的进度，需要加上已有的部分
+    connect(reply, &QNetworkReply::downloadProgress, session, [this, session](qint64 bytesReceived, qint64 bytesTotal) {
+        const qint64 offset = session->resumeOffset();
+        emit downloadAppFileProgress(offset + bytesReceived, bytesTotal > 0 ? offset + bytesTotal : -1);
+    });
+}
+
+/**
+ * @brief 下载数据就绪处理函数
+ * @param session 对应的下载会话
+ * 
+ * 将当前可用的数据写入临时文件并更新SHA-256，写入失败时终止下载。
+ */
+void ApiManager::onDownloadDataReady(DownloadSession* session)
+{
+    QNetworkReply* reply = session->reply();
+    
+    QByteArray data = reply->readAll();
+    if (data.isEmpty() || session->isFinished()) {
+        return;
+    }
+    
+    if (!session->write(data)) {
+        // 状态码不可接受时丢弃响应体，等请求结束后按错误报告
+        if (session->isRejected()) {
+            return;
+        }
+        finishDownloadSession(session, false, "文件保存失败");
+        reply->abort();
+    }
 }
 
 /**
- * @brief 流式数据就绪槽函数实现
+ * @brief 结束下载会话并发出 downloadAppFileResponse 信号
+ * @param session 对应的下载会话
+ * @param success 网络传输是否成功完成
+ * @param message 失败时的错误信息
+ * @param resumable 失败时是否保留部分文件供下次续传（网络中断）
  * 
- * 当流式聊天接口有新数据可读时调用此函数。
- * 读取当前可用的数据块并通过 streamChatResponse 信号发出。
- * 处理Server-Sent Events (SSE) 格式的数据。
+ * 成功时校验收到的字节数与文件总大小一致后提交文件，
+ * 结果中附带文件路径、大小和下载过程中计算的SHA-256。
+ * 失败结果中的 resumable 表示重新下载可以接着已有数据继续。每个会话只发出一次信号。
  */
-void ApiManager::onStreamDataReady()
+void ApiManager::finishDownloadSession(DownloadSession* session, bool success, const QString& message, bool resumable)
 {
-    QNetworkReply* reply = qobject_cast<QNetworkReply*>(sender());
-    if (!reply) {
-        qWarning() << "[ApiManager] onStreamDataReady: Invalid sender";
+    if (session->isFinished()) {
         return;
     }
     
-    // 获取对应的chatId
-    QString chatId = m_streamChatIds.value(reply, "");
+    // 连接提前断开时Qt不一定报错，按文件总大小检查数据是否完整
+    if (success && session->totalSize() >= 0 && session->totalSize() != session->bytesWritten()) {
+        LOG_WARNING(lcFile) << "[ApiManager] Download incomplete:" << session->bytesWritten() << "of" << session->totalSize();
+        finishDownloadSession(session, false, "文件下载不完整", true);
+        return;
+    }
     
-    // 读取所有可用数据
-    QByteArray data = reply->readAll();
-    if (data.isEmpty()) {
+    if (!success) {
+        QJsonObject failData;
+        if (resumable) {
+            session->suspend();
+            failData["resumable"] = true;
+            failData["bytesReceived"] = session->isResumable() ? session->bytesWritten() : 0;
+        } else {
+            session->cancel();
+        }
+        emit downloadAppFileResponse(false, message, failData);
         return;
     }
     
-    QString newDataString = QString::fromUtf8(data);
-    qDebug() << "[ApiManager] Stream data received:" << newDataString;
+    if (!session->commit()) {
+        LOG_WARNING(lcFile) << "[ApiManager] Failed to save downloaded file:" << session->errorString();
+        emit downloadAppFileResponse(false, "文件保存失败", QJsonObject());
+        return;
+    }
     
-    // 将新数据追加到缓冲区
-    QString& buffer = m_streamDataBuffers[reply];
-    buffer += newDataString;
+    QJsonObject fileData;
+    fileData["success"] = true;
+    fileData["filePath"] = session->filePath();
+    fileData["fileName"] = QFileInfo(session->filePath()).fileName();
+    fileData["fileSize"] = session->bytesWritten();
+    fileData["sha256"] = session->sha256();
+    
+    LOG_DEBUG(lcFile) << "[ApiManager] File saved successfully to:" << session->filePath()
+                      << "size:" << session->bytesWritten() << "resumed from:" << session->resumeOffset()
+                      << "sha256:" << session->sha256();
+    emit downloadAppFileResponse(true, "文件下载成功", fileData);
+}
+
+/**
+ * @brief 发起流式请求的通用方法
+ * @param kind 流式请求种类
+ * @param endpoint API端点路径
+ * @param requestData 请求数据
+ * @param chatId 会话ID
+ * 
+ * 两种流式接口共用同一套处理流程：创建请求、挂载StreamSession、
+ * 将readyRead直接绑定到该会话，接收数据时无需再按回复指针查表。
+ */
+void ApiManager::startStream(StreamSession::Kind kind, const QString& endpoint, const QJsonObject& requestData, const QString& chatId)
+{
+    const bool isKnowledge = (kind == StreamSession::KnowledgeChat);
     
-    // 处理换行符：先将额外的换行符标记出来，然后按标准SSE格式分割
-    QString processedBuffer = buffer;
+    QNetworkRequest request = createRequest(endpoint);
+    tagRequest(request, isKnowledge ? StreamKnowledgeChat : StreamChat);
     
-    // 将 \n\n\n\n 替换为 <<DOUBLE_NEWLINE>>\n\n (保留两个换行符)
-    processedBuffer.replace("\n\n\n\n", "<<DOUBLE_NEWLINE>>\n\n");
+    QByteArray body = QJsonDocument(requestData).toJson(QJsonDocument::Compact);
+    logBody("Stream request body:", body);
     
-    // 将 \n\n\n 替换为 <<SINGLE_NEWLINE>>\n\n (保留一个换行符)  
-    processedBuffer.replace("\n\n\n", "<<SINGLE_NEWLINE>>\n\n");
+    QNetworkReply* reply = m_networkManager->post(request, body);
+    trackReply(reply, body.size());
     
-    // 按标准SSE格式分割事件
-    QStringList events = processedBuffer.split("\n\n");
+    // 文本逐条发出，由接收方按渲染帧合并后刷新UI
+    StreamSession* session = new StreamSession(kind, chatId, reply);
     
-    // 保留最后一个可能不完整的事件在缓冲区中
-    if (!processedBuffer.endsWith("\n\n")) {
-        // 最后一个事件可能不完整，保留在缓冲区中
-        buffer = events.takeLast();
-        // 恢复原始的换行符标记到缓冲区
-        buffer.replace("<<DOUBLE_NEWLINE>>", "\n\n");
-        buffer.replace("<<SINGLE_NEWLINE>>", "\n");
-    } else {
-        // 如果以双换行符结尾，说明所有事件都是完整的
-        buffer.clear();
+    connect(reply, &QNetworkReply::readyRead, session, [this, session]() {
+        onStreamDataReady(session);
+    });
+}
+
+/**
+ * @brief 流式数据就绪处理函数实现
+ * @param session 对应的流式会话
+ * 
+ * 当流式接口有新数据可读时调用此函数。
+ * 读取当前可用的数据块，增量解析Server-Sent Events (SSE) 格式的数据，
+ * 并通过 streamChatResponse / streamKnowledgeChatResponse 信号发出。
+ */
+void ApiManager::onStreamDataReady(StreamSession* session)
+{
+    QNetworkReply* reply = session->reply();
+    
+    // 读取所有可用数据
+    QByteArray data = reply->readAll();
+    if (data.isEmpty() || session->isFinished()) {
+        return;
     }
     
-    // 处理完整的SSE事件
-    for (const QString& event : events) {
-        if (event.trimmed().isEmpty()) {
+    LOG_DEBUG(lcStream) << "[ApiManager] Stream data received, bytes:" << data.size();
+    
+    // 增量解析SSE事件，解析器中只保留未完成事件的尾部
+    QVector<SseParser::Event> events;
+    session->parser().feed(data, events);
+    
+    for (const SseParser::Event& event : events) {
+        const QString& eventType = event.type;
+        const QString& content = event.data;
+        
+        // 处理完整的SSE事件
+        if (eventType.isEmpty() || content.isEmpty() || content == "[DONE]") {
             continue;
         }
         
-        QStringList lines = event.split('\n');
-        QString eventType = "";
-        QString content = "";
-        
-        for (const QString& line : lines) {
-            // 处理 event: 行
-            if (line.trimmed().startsWith("event:")) {
-                eventType = line.trimmed().mid(6).trimmed();
-            }
-            // 处理 data: 行（保持原始格式，不要trim）
-            else if (line.startsWith("data:")) {
-                // 从 "data:" 后面开始取所有内容，保留空格
-                content = line.mid(5);
-                
-                // 恢复额外的换行符
-                content.replace("<<DOUBLE_NEWLINE>>", "\n\n");
-                content.replace("<<SINGLE_NEWLINE>>", "\n");
+        if (eventType == "message") {
+            // 消息事件，直接发送文本内容（保留所有空格）
+            emitStreamResponse(session, content);
+        } else if (eventType == "complete") {
+            QJsonDocument doc = QJsonDocument::fromJson(content.toUtf8());
+            QJsonObject obj = doc.object();
+            
+            if (session->kind() == StreamSession::KnowledgeChat) {
+                // 完成事件先发送检索到的元数据
+                if (obj.contains("retrieved_metadata")) {
+                    emit knowledgeChatMetadataReceived(session->chatId(), parseRetrievedMetadata(obj["retrieved_metadata"].toArray()));
+                }
+                finishStreamSession(session, true, "知识库聊天完成");
+            } else {
+                finishStreamSession(session, true, obj["content"].toString());
             }
-        }
-        
-        // 处理完整的SSE事件
-        if (!eventType.isEmpty() && !content.isEmpty()) {
-            if (content != "[DONE]") {
-                if (eventType == "message") {
-                    // 消息事件，直接发送文本内容（保留所有空格）
-                    qDebug() << "[ApiManager] Sending content:" << QStringLiteral("'%1'").arg(content) << "Length:" << content.length();
-                    emit streamChatResponse(content, chatId);
-                } else if (eventType == "complete") {
-                    QJsonDocument doc = QJsonDocument::fromJson(content.toUtf8());
-                    if (doc.isObject()) {
-                        QJsonObject obj = doc.object();
-                        QString string = obj["content"].toString();
-                        emit streamChatFinished(true, string, chatId);
-                    }
-                    // 清理映射和缓冲区
-                    m_streamChatIds.remove(reply);
-                    m_streamDataBuffers.remove(reply);
-                    return; // 完成后退出
-                } else {
-                    // 其他事件，尝试解析JSON数据
-                    QJsonDocument doc = QJsonDocument::fromJson(content.toUtf8());
-                    if (doc.isObject()) {
-                        QJsonObject obj = doc.object();
-                        QString text = obj.value("content").toString();
-                        if (!text.isEmpty()) {
-                            emit streamChatResponse(text, chatId);
-                        }
-                    } else {
-                        // 如果不是JSON，直接发送文本内容（保留空格）
-                        emit streamChatResponse(content, chatId);
-                    }
+            return; // 完成后退出
+        } else {
+            // 其他事件，尝试解析JSON数据
+            QJsonDocument doc = QJsonDocument::fromJson(content.toUtf8());
+            if (doc.isObject()) {
+                QString text = doc.object().value("content").toString();
+                if (!text.isEmpty()) {
+                    emitStreamResponse(session, text);
                 }
+            } else {
+                // 如果不是JSON，直接发送文本内容（保留空格）
+                emitStreamResponse(session, content);
             }
         }
     }
 }
 
 /**
- * @brief 知识库流式数据就绪槽函数实现
+ * @brief 结束流式会话并发出对应的完成信号
+ * @param session 对应的流式会话
+ * @param success 是否成功完成
+ * @param message 完成消息或错误信息
  * 
- * 当知识库流式聊天接口有新数据可读时调用此函数。
- * 读取当前可用的数据块并通过 streamKnowledgeChatResponse 信号发出。
- * 处理Server-Sent Events (SSE) 格式的数据。
+ * 每个会话只会发出一次完成信号，之后到达的数据和回复完成事件都会被忽略。
  */
-void ApiManager::onStreamKnowledgeDataReady()
+void ApiManager::finishStreamSession(StreamSession* session, bool success, const QString& message)
 {
-    QNetworkReply* reply = qobject_cast<QNetworkReply*>(sender());
-    if (!reply) {
-        qWarning() << "[ApiManager] onStreamKnowledgeDataReady: Invalid sender";
+    if (session->isFinished()) {
         return;
     }
     
-    // 获取对应的chatId
-    QString chatId = m_streamKnowledgeChatIds.value(reply, "");
+    session->setFinished();
     
-    // 读取所有可用数据
-    QByteArray data = reply->readAll();
-    if (data.isEmpty()) {
-        return;
+    if (session->kind() == StreamSession::KnowledgeChat) {
+        emit streamKnowledgeChatFinished(success, message, session->chatId());
+    } else {
+        emit streamChatFinished(success, message, session->chatId());
     }
-    
-    QString newDataString = QString::fromUtf8(data);
-    qDebug() << "[ApiManager] Knowledge stream data received:" << newDataString;
-    
-    // 将新数据追加到缓冲区
-    QString& buffer = m_streamKnowledgeDataBuffers[reply];
-    buffer += newDataString;
-    
-    // 处理换行符：先将额外的换行符标记出来，然后按标准SSE格式分割
-    QString processedBuffer = buffer;
-    
-    // 将 \n\n\n\n 替换为 <<DOUBLE_NEWLINE>>\n\n (保留两个换行符)
-    processedBuffer.replace("\n\n\n\n", "<<DOUBLE_NEWLINE>>\n\n");
-    
-    // 将 \n\n\n 替换为 <<SINGLE_NEWLINE>>\n\n (保留一个换行符)  
-    processedBuffer.replace("\n\n\n", "<<SINGLE_NEWLINE>>\n\n");
-    
-    // 按标准SSE格式分割事件
-    QStringList events = processedBuffer.split("\n\n");
-    
-    // 保留最后一个可能不完整的事件在缓冲区中
-    if (!processedBuffer.endsWith("\n\n")) {
-        // 最后一个事件可能不完整，保留在缓冲区中
-        buffer = events.takeLast();
-        // 恢复原始的换行符标记到缓冲区
-        buffer.replace("<<DOUBLE_NEWLINE>>", "\n\n");
-        buffer.replace("<<SINGLE_NEWLINE>>", "\n");
+}
+
+/**
+ * @brief 按会话种类发出流式文本信号
+ */
+void ApiManager::emitStreamResponse(StreamSession* session, const QString& text)
+{
+    m_metrics.markPhase(session->reply(), RequestMetrics::FirstTokenPhase);
+    if (session->kind() == StreamSession::KnowledgeChat) {
+        emit streamKnowledgeChatResponse(text, session->chatId());
     } else {
-        // 如果以双换行符结尾，说明所有事件都是完整的
-        buffer.clear();
+        emit streamChatResponse(text, session->chatId());
     }
-    
-    // 处理完整的SSE事件
-    for (const QString& event : events) {
-        if (event.trimmed().isEmpty()) {
-            continue;
-        }
-        
-        QStringList lines = event.split('\n');
-        QString eventType = "";
-        QString content = "";
-        
-        for (const QString& line : lines) {
-            // 处理 event: 行
-            if (line.trimmed().startsWith("event:")) {
-                eventType = line.trimmed().mid(6).trimmed();
-            }
-            // 处理 data: 行（保持原始格式，不要trim）
-            else if (line.startsWith("data:")) {
-                // 从 "data:" 后面开始取所有内容，保留空格
-                content = line.mid(5);
-                
-                // 恢复额外的换行符
-                content.replace("<<DOUBLE_NEWLINE>>", "\n\n");
-                content.replace("<<SINGLE_NEWLINE>>", "\n");
-            }
-        }
-        
-        // 处理完整的SSE事件
-        if (!eventType.isEmpty() && !content.isEmpty()) {
-            if (content != "[DONE]") {
-                if (eventType == "message") {
-                    // 消息事件，累积到待发送缓冲区而不是立即发送
-                    qDebug() << "[ApiManager] Knowledge buffering content:" << QStringLiteral("'%1'").arg(content) << "Length:" << content.length();
-                    m_streamKnowledgePendingBuffers[reply] += content;
-                    
-                    // 如果定时器不存在，创建并启动
-                    if (!m_streamKnowledgeTimers.contains(reply)) {
-                        QTimer* timer = new QTimer(this);
-                        timer->setInterval(30);  // 每30ms批量发送一次
-                        timer->setSingleShot(true);
-                        m_streamKnowledgeTimers[reply] = timer;
-                        
-                        // 连接定时器信号，使用lambda捕获reply指针
-                        connect(timer, &QTimer::timeout, this, [this, reply]() {
-                            // 检查reply是否仍然有效
-                            if (m_streamKnowledgePendingBuffers.contains(reply)) {
-                                QString bufferedContent = m_streamKnowledgePendingBuffers[reply];
-                                if (!bufferedContent.isEmpty()) {
-                                    QString chatId = m_streamKnowledgeChatIds.value(reply, "");
-                                    qDebug() << "[ApiManager] Knowledge sending batched content, Length:" << bufferedContent.length();
-                                    emit streamKnowledgeChatResponse(bufferedContent, chatId);
-                                    m_streamKnowledgePendingBuffers[reply].clear();
-                                }
-                            }
-                        });
-                    }
-                    
-                    // 启动或重启定时器
-                    QTimer* timer = m_streamKnowledgeTimers[reply];
-                    if (!timer->isActive()) {
-                        timer->start();
-                    }
-                } else if (eventType == "complete") {
-                    // 完成事件，先立即刷新所有待发送的内容
-                    if (m_streamKnowledgeTimers.contains(reply)) {
-                        QTimer* timer = m_streamKnowledgeTimers[reply];
-                        timer->stop();
-                        
-                        // 立即发送所有缓冲的内容
-                        if (m_streamKnowledgePendingBuffers.contains(reply)) {
-                            QString bufferedContent = m_streamKnowledgePendingBuffers[reply];
-                            if (!bufferedContent.isEmpty()) {
-                                qDebug() << "[ApiManager] Knowledge flushing final content, Length:" << bufferedContent.length();
-                                emit streamKnowledgeChatResponse(bufferedContent, chatId);
-                            }
-                        }
-                        
-                        // 清理定时器
-                        timer->deleteLater();
-                        m_streamKnowledgeTimers.remove(reply);
-                    }
-                    
-                    // 完成事件，解析JSON数据并发送元数据
-                    QJsonDocument doc = QJsonDocument::fromJson(content.toUtf8());
-                    if (doc.isObject()) {
-                        QJsonObject obj = doc.object();
-                        
-                        // 提取retrieved_metadata
-                        if (obj.contains("retrieved_metadata")) {
-                            QJsonArray metadataArray = obj["retrieved_metadata"].toArray();
-                            QVariantList metadataList;
-                            
-                            for (const QJsonValue& value : metadataArray) {
-                                if (value.isObject()) {
-                                    QJsonObject metaObj = value.toObject();
-                                    QVariantMap metaMap;
-                                    metaMap["retriever_name"] = metaObj["retriever_name"].toString();
-                                    metaMap["url"] = metaObj["url"].toString();
-                                    metaMap["file_name"] = metaObj["file_name"].toString();
-                                    
-                                    // 处理页码数组
-                                    if (metaObj.contains("page_numbers") && metaObj["page_numbers"].isArray()) {
-                                        QJsonArray pageArray = metaObj["page_numbers"].toArray();
-                                        QVariantList pageList;
-                                        for (const QJsonValue& pageValue : pageArray) {
-                                            pageList.append(pageValue.toInt());
-                                        }
-                                        metaMap["page_numbers"] = pageList;
-                                    }
-                                    
-                                    metadataList.append(metaMap);
-                                }
-                            }
-                            
-                            // 发送元数据信号
-                            emit knowledgeChatMetadataReceived(chatId, metadataList);
-                        }
-                    }
-                    
-                    // 发送完成信号
-                    emit streamKnowledgeChatFinished(true, "知识库聊天完成", chatId);
-                    // 清理映射和缓冲区
-                    m_streamKnowledgeChatIds.remove(reply);
-                    m_streamKnowledgeDataBuffers.remove(reply);
-                    m_streamKnowledgePendingBuffers.remove(reply);
-                    return; // 完成后退出
-                } else {
-                    // 其他事件，尝试解析JSON数据
-                    QJsonDocument doc = QJsonDocument::fromJson(content.toUtf8());
-                    if (doc.isObject()) {
-                        QJsonObject obj = doc.object();
-                        QString text = obj.value("content").toString();
-                        if (!text.isEmpty()) {
-                            emit streamKnowledgeChatResponse(text, chatId);
-                        }
-                    } else {
-                        // 如果不是JSON，直接发送文本内容（保留空格）
-                        emit streamKnowledgeChatResponse(content, chatId);
-                    }
+}
+
+/**
+ * @brief 解析知识库聊天完成事件中的检索元数据
+ * @param metadataArray retrieved_metadata 数组
+ * @return 供QML使用的元数据列表
+ */
+QVariantList ApiManager::parseRetrievedMetadata(const QJsonArray& metadataArray) const
+{
+    QVariantList metadataList;
+    
+    for (const QJsonValue& value : metadataArray) {
+        if (value.isObject()) {
+            QJsonObject metaObj = value.toObject();
+            QVariantMap metaMap;
+            metaMap["retriever_name"] = metaObj["retriever_name"].toString();
+            metaMap["url"] = metaObj["url"].toString();
+            metaMap["file_name"] = metaObj["file_name"].toString();
+            
+            // 处理页码数组
+            if (metaObj.contains("page_numbers") && metaObj["page_numbers"].isArray()) {
+                QJsonArray pageArray = metaObj["page_numbers"].toArray();
+                QVariantList pageList;
+                for (const QJsonValue& pageValue : pageArray) {
+                    pageList.append(pageValue.toInt());
                 }
+                metaMap["page_numbers"] = pageList;
             }
+            
+            metadataList.append(metaMap);
         }
     }
+    
+    return metadataList;
 }
 
 /**
@@ -1012,80 +1281,65 @@ void ApiManager::onStreamKnowledgeDataReady()
  */
 void ApiManager::onNetworkReply(QNetworkReply* reply)
 {
-    QString requestType = QString::fromUtf8(reply->request().rawHeader("X-Request-Type"));
+    const RequestType requestType = requestTypeOf(reply);
+    const RequestDescriptor& descriptor = s_requestTable[requestType];
     QUrl replyUrl = reply->url();
     
-    qDebug() << "[ApiManager] Reply received from:" << replyUrl.toString() 
-             << "Type:" << requestType;
+    LOG_DEBUG(lcNet) << "[ApiManager] Reply received from:" << replyUrl.toString() 
+                     << "Type:" << descriptor.name;
     
-    // 从活跃请求集合中移除
+    // 从活跃请求集合中移除，按类型计数并记录耗时
     m_activeReplies.remove(reply);
+    ++m_requestCounts[requestType];
+    m_metrics.finish(reply);
+    
+    // 保活请求只用于维持连接，不论结果如何都不分发
+    if (requestType == KeepAlive) {
+        reply->deleteLater();
+        return;
+    }
+    
+    // 文件下载的数据已在readyRead中写入磁盘，这里只需结束会话
+    if (DownloadSession* download = DownloadSession::fromReply(reply)) {
+        const int status = reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt();
+        if (reply->error() == QNetworkReply::NoError) {
+            onDownloadDataReady(download);
+            if (download->isRejected()) {
+                finishDownloadSession(download, false, download->errorString(), true);
+            } else {
+                finishDownloadSession(download, true, QString());
+            }
+        } else if (reply->error() == QNetworkReply::OperationCanceledError) {
+            // 手动终止的下载保留已有数据，下次可以继续
+            LOG_DEBUG(lcNet) << "[ApiManager] Request was manually aborted:" << descriptor.name;
+            download->suspend();
+        } else if (status == 416) {
+            // 续传起点超出服务器上的文件大小（文件已变化），只有这种情况需要丢弃部分文件
+            LOG_WARNING(lcNet) << "[ApiManager] Download range not satisfiable, discarding partial file";
+            finishDownloadSession(download, false, reply->errorString(), false);
+        } else {
+            // 其余错误视为网络中断或服务器临时错误，保留部分文件以便续传
+            LOG_WARNING(lcNet) << "[ApiManager] Download error:" << reply->errorString() << "HTTP status:" << status;
+            finishDownloadSession(download, false, reply->errorString(), true);
+        }
+        reply->deleteLater();
+        return;
+    }
     
     if (reply->error() == QNetworkReply::NoError) {
         // 网络请求成功，解析响应数据
         QByteArray responseData = reply->readAll();
-        qDebug().noquote() << "[ApiManager] Response data:" << QString::fromUtf8(responseData);
+        logBody("Response data:", responseData);
         
-        // 对于流式聊天请求，特殊处理
-        if (requestType == "stream-chat") {
-            // 清理chatId映射和缓冲区
-            m_streamChatIds.remove(reply);
-            m_streamDataBuffers.remove(reply);
-        } else if (requestType == "download-app-file") {
-            // 下载文件请求返回的是文件流，直接处理二进制数据
-            qDebug() << "[ApiManager] Processing file download, data size:" << responseData.size();
-            
-            // 创建包含文件数据的响应对象
-            QJsonObject fileData;
-            fileData["fileSize"] = responseData.size();
-            fileData["success"] = true;
-            
-            // 保存文件数据到临时位置
-            QString tempDir = QStandardPaths::writableLocation(QStandardPaths::TempLocation);
-            qDebug() << "[ApiManager] Temp directory:" << tempDir;
-            QDir().mkpath(tempDir);
-            
-            // 从请求URL中提取文件名，或使用默认名称
-            QString fileName = "update_file.exe";  // 默认文件名
-            QUrl requestUrl = reply->request().url();
-            QString urlQuery = requestUrl.query();
-            QUrlQuery query(urlQuery);
-            if (query.hasQueryItem("fileName")) {
-                fileName = query.queryItemValue("fileName");
-            }
-            
-            QString tempFilePath = tempDir + "/" + fileName;
-            QFile tempFile(tempFilePath);
-            
-            if (tempFile.open(QIODevice::WriteOnly)) {
-                qint64 written = tempFile.write(responseData);
-                tempFile.close();
-                
-                if (written == responseData.size()) {
-                    fileData["filePath"] = tempFilePath;
-                    fileData["fileName"] = fileName;
-                    qDebug() << "[ApiManager] File saved successfully to:" << tempFilePath;
-                    emit downloadAppFileResponse(true, "文件下载成功", fileData);
-                } else {
-                    qWarning() << "[ApiManager] File write incomplete:" << written << "of" << responseData.size();
-                    emit downloadAppFileResponse(false, "文件保存失败", QJsonObject());
-                }
-            } else {
-                qWarning() << "[ApiManager] Failed to create temp file:" << tempFilePath;
-                emit downloadAppFileResponse(false, "无法创建临时文件", QJsonObject());
-            }
-        } else if (requestType == "stream-knowledge-chat") {
-            // 知识库流式聊天完成，发送完成信号
-            QString chatId = m_streamKnowledgeChatIds.value(reply, "");
-            emit streamKnowledgeChatFinished(true, "知识库聊天完成", chatId);
-            // 清理chatId映射和缓冲区
-            m_streamKnowledgeChatIds.remove(reply);
-            m_streamKnowledgeDataBuffers.remove(reply);
+        // 对于流式聊天请求，特殊处理：未收到complete事件时在此发出完成信号
+        if (StreamSession* session = StreamSession::fromReply(reply)) {
+            finishStreamSession(session, true,
+                                session->kind() == StreamSession::KnowledgeChat ? "知识库聊天完成" : "");
         } else {
             // 其他请求需要解析JSON响应
             QJsonDocument doc = QJsonDocument::fromJson(responseData);
             if (!doc.isObject()) {
-                qWarning() << "[ApiManager] Invalid JSON response";
+                LOG_WARNING(lcNet) << "[ApiManager] Invalid JSON response";
                 emit networkError("Invalid server response");
             } else {
                 QJsonObject responseObj = doc.object();
@@ -1093,128 +1347,45 @@ void ApiManager::onNetworkReply(QNetworkReply* reply)
                 QString message = responseObj.value("message").toString();
                 QJsonObject data = responseObj.value("data").toObject();
                 bool success = (code == 0);  // 服务器约定：code为0表示成功
+                if (!success) {
+                    m_metrics.recordApiError(descriptor.name, networkName());
+                }
      
-                // 根据请求类型分发响应到对应的信号
-                if (requestType == "login") {
-                    emit loginResponse(success, message, data);
-                } else if (requestType == "register") {
-                    emit registerResponse(success, message, data);
-                } else if (requestType == "test-connection") {
-                    emit connectionTestResult(success, message);
-                } else if (requestType == "tnm-ai-score") {
-                    emit tnmAiQualityScoreResponse(success, message, data);
-                } else if (requestType == "renal-ai-score") {
-                    emit renalAiQualityScoreResponse(success, message, data);
-                } else if (requestType == "delete-chat") {
-                    emit deleteChatResponse(success, message, data);
-                } else if (requestType == "add-quality-record") {
-                    emit addQualityRecordResponse(success, message, data);
-                } else if (requestType == "get-quality-list") {
-                    emit getQualityListResponse(success, message, data);
-                } else if (requestType == "cancer-diagnose-type") {
-                    emit cancerDiagnoseTypeResponse(success, message, data);
-                } else if (requestType == "save-report-template") {
-                    emit saveReportTemplateResponse(success, message, data);
-                } else if (requestType == "delete-report-template") {
-                    emit deleteReportTemplateResponse(success, message, data);
-                } else if (requestType == "generate-quality-report") {
-                    emit generateQualityReportResponse(success, message, data);
-                } else if (requestType == "get-report-template-list") {
-                    // 模板列表接口的data字段是数组，需要特殊处理
-                    QJsonObject specialData;
-                    specialData["data"] = responseObj.value("data").toArray();
-                    emit getReportTemplateListResponse(success, message, specialData);
-                } else if (requestType == "upload-file") {
-                    emit uploadFileResponse(success, message, data);
-                } else if (requestType == "create-knowledge-base") {
-                    emit createKnowledgeBaseResponse(success, message, data);
-                } else if (requestType == "delete-knowledge-base") {
-                    emit deleteKnowledgeBaseResponse(success, message, data);
-                } else if (requestType == "update-knowledge-base") {
-                    emit updateKnowledgeBaseResponse(success, message, data);
-                } else if (requestType == "get-knowledge-base") {
-                    emit getKnowledgeBaseResponse(success, message, data);
-                } else if (requestType == "get-knowledge-base-list") {
-                    emit getKnowledgeBaseListResponse(success, message, data);
-                } else if (requestType == "delete-knowledge-base-files") {
-                    emit deleteKnowledgeBaseFilesResponse(success, message, data);
-                } else if (requestType == "get-system-update-list") {
-                    // 系统更新列表接口的data字段是数组，需要特殊处理
-                    QJsonObject specialData;
-                    specialData["data"] = responseObj.value("data").toArray();
-                    emit getSystemUpdateListResponse(success, message, specialData);
+                // 根据请求类型查表分发响应到对应的信号；带上传ID的上传请求按ID单独返回
+                if (emitUploadFinished(reply, success, false, message, data)) {
+                    // 已通过 uploadFileFinished 返回
+                } else if (descriptor.responseSignal) {
+                    if (descriptor.arrayData) {
+                        // 模板列表、系统更新列表接口的data字段是数组，需要包装后发送
+                        QJsonObject specialData;
+                        specialData["data"] = responseObj.value("data").toArray();
+                        (this->*descriptor.responseSignal)(success, message, specialData);
+                    } else {
+                        (this->*descriptor.responseSignal)(success, message, data);
+                    }
                 }
             }
         }
     } else {
         // 网络请求失败，处理错误
         QString errorString = reply->errorString();
-        qWarning() << "[ApiManager] Network error:" << errorString;
+        LOG_WARNING(lcNet) << "[ApiManager] Network error:" << errorString;
         
         // 检查是否是手动终止的请求
         if (reply->error() == QNetworkReply::OperationCanceledError) {
-            qDebug() << "[ApiManager] Request was manually aborted:" << requestType;
-            // 被终止的请求不发送错误信号，直接清理即可
+            LOG_DEBUG(lcNet) << "[ApiManager] Request was manually aborted:" << descriptor.name;
+            // 被终止的请求不发送错误信号，直接清理即可；带上传ID的上传需要通知上传队列释放并发名额
+            emitUploadFinished(reply, false, false, errorString, QJsonObject());
         } else {
             // 根据请求类型发送错误响应
-            if (requestType == "login") {
-                emit loginResponse(false, errorString, QJsonObject());
-            } else if (requestType == "register") {
-                emit registerResponse(false, errorString, QJsonObject());
-            } else if (requestType == "test-connection") {
-                emit connectionTestResult(false, errorString);
-            } else if (requestType == "tnm-ai-score") {
-                emit tnmAiQualityScoreResponse(false, errorString, QJsonObject());
-            } else if (requestType == "renal-ai-score") {
-                emit renalAiQualityScoreResponse(false, errorString, QJsonObject());
-            } else if (requestType == "delete-chat") {
-                emit deleteChatResponse(false, errorString, QJsonObject());
-            } else if (requestType == "add-quality-record") {
-                emit addQualityRecordResponse(false, errorString, QJsonObject());
-            } else if (requestType == "get-quality-list") {
-                emit getQualityListResponse(false, errorString, QJsonObject());
-            } else if (requestType == "cancer-diagnose-type") {
-                emit cancerDiagnoseTypeResponse(false, errorString, QJsonObject());
-            } else if (requestType == "save-report-template") {
-                emit saveReportTemplateResponse(false, errorString, QJsonObject());
-            } else if (requestType == "delete-report-template") {
-                emit deleteReportTemplateResponse(false, errorString, QJsonObject());
-            } else if (requestType == "generate-quality-report") {
-                emit generateQualityReportResponse(false, errorString, QJsonObject());
-            } else if (requestType == "get-report-template-list") {
-                emit getReportTemplateListResponse(false, errorString, QJsonObject());
-            } else if (requestType == "upload-file") {
-                emit uploadFileResponse(false, errorString, QJsonObject());
-            } else if (requestType == "create-knowledge-base") {
-                emit createKnowledgeBaseResponse(false, errorString, QJsonObject());
-            } else if (requestType == "delete-knowledge-base") {
-                emit deleteKnowledgeBaseResponse(false, errorString, QJsonObject());
-            } else if (requestType == "update-knowledge-base") {
-                emit updateKnowledgeBaseResponse(false, errorString, QJsonObject());
-            } else if (requestType == "get-knowledge-base") {
-                emit getKnowledgeBaseResponse(false, errorString, QJsonObject());
-            } else if (requestType == "get-knowledge-base-list") {
-                emit getKnowledgeBaseListResponse(false, errorString, QJsonObject());
-            } else if (requestType == "delete-knowledge-base-files") {
-                emit deleteKnowledgeBaseFilesResponse(false, errorString, QJsonObject());
-            } else if (requestType == "get-system-update-list") {
-                emit getSystemUpdateListResponse(false, errorString, QJsonObject());
-            } else if (requestType == "download-app-file") {
-                emit downloadAppFileResponse(false, errorString, QJsonObject());
-            } else if (requestType == "stream-chat") {
+            const int status = reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt();
+            if (StreamSession* session = StreamSession::fromReply(reply)) {
                 // 流式聊天错误，发送错误完成信号
-                QString chatId = m_streamChatIds.value(reply, "");
-                emit streamChatFinished(false, errorString, chatId);
-                // 清理chatId映射和缓冲区
-                m_streamChatIds.remove(reply);
-                m_streamDataBuffers.remove(reply);
-            } else if (requestType == "stream-knowledge-chat") {
-                // 知识库流式聊天错误，发送错误完成信号
-                QString chatId = m_streamKnowledgeChatIds.value(reply, "");
-                emit streamKnowledgeChatFinished(false, errorString, chatId);
-                // 清理chatId映射和缓冲区
-                m_streamKnowledgeChatIds.remove(reply);
-                m_streamKnowledgeDataBuffers.remove(reply);
+                finishStreamSession(session, false, errorString);
+            } else if (emitUploadFinished(reply, false, status < 400 || status >= 500, errorString, QJsonObject())) {
+                // 网络中断和5xx可以重试，4xx为请求本身的问题
+            } else if (descriptor.responseSignal) {
+                (this->*descriptor.responseSignal)(false, errorString, QJsonObject());
             } else {
                 emit networkError(errorString);
             }
@@ -1234,53 +1405,46 @@ void ApiManager::onNetworkReply(QNetworkReply* reply)
  */
 void ApiManager::abortAllRequests()
 {
-    qDebug() << "[ApiManager] Aborting all active requests, count:" << m_activeReplies.size();
+    LOG_DEBUG(lcNet) << "[ApiManager] Aborting all active requests, count:" << m_activeReplies.size();
     
     // 复制集合，因为abort()会触发finished信号，导致集合在遍历时被修改
     QSet<QNetworkReply*> repliesToAbort = m_activeReplies;
     
     for (QNetworkReply* reply : repliesToAbort) {
         if (reply && reply->isRunning()) {
-            qDebug() << "[ApiManager] Aborting request to:" << reply->url().toString();
+            LOG_DEBUG(lcNet) << "[ApiManager] Aborting request to:" << reply->url().toString();
+            // 流式会话随回复对象一起销毁，标记结束后不再发送任何信号
+            if (StreamSession* session = StreamSession::fromReply(reply)) {
+                session->setFinished();
+            }
             reply->abort();
         }
     }
-    
-    // 清理所有流式聊天的chatId映射和缓冲区
-    m_streamChatIds.clear();
-    m_streamDataBuffers.clear();
 }
 
 /**
  * @brief 终止指定类型的网络请求
- * @param requestType 要终止的请求类型（如 "login", "tnm-ai-score"）
+ * @param requestType 要终止的请求类型（如 Login, TnmAiScore）
  * 
  * 只终止匹配指定类型的活跃请求，允许对特定操作进行精确控制。
- * 例如：abortRequestsByType("login") 只会终止登录请求，其他请求继续执行。
+ * 例如：abortRequestsByType(Login) 只会终止登录请求，其他请求继续执行。
  */
-void ApiManager::abortRequestsByType(const QString& requestType)
+void ApiManager::abortRequestsByType(RequestType requestType)
 {
-    qDebug() << "[ApiManager] Aborting requests of type:" << requestType;
+    LOG_DEBUG(lcNet) << "[ApiManager] Aborting requests of type:" << s_requestTable[requestType].name;
     
     // 复制集合避免遍历时修改
     QSet<QNetworkReply*> repliesToCheck = m_activeReplies;
     
     for (QNetworkReply* reply : repliesToCheck) {
         if (reply && reply->isRunning()) {
-            QString replyType = QString::fromUtf8(reply->request().rawHeader("X-Request-Type"));
-            if (replyType == requestType) {
-                qDebug() << "[ApiManager] Aborting request:" << reply->url().toString() 
-                         << "Type:" << replyType;
-                reply->abort();
-                
-                // 如果是流式聊天请求，清理对应的chatId映射和缓冲区
-                if (replyType == "stream-chat") {
-                    m_streamChatIds.remove(reply);
-                    m_streamDataBuffers.remove(reply);
-                } else if (replyType == "stream-knowledge-chat") {
-                    m_streamKnowledgeChatIds.remove(reply);
-                    m_streamKnowledgeDataBuffers.remove(reply);
+            if (requestTypeOf(reply) == requestType) {
+                LOG_DEBUG(lcNet) << "[ApiManager] Aborting request:" << reply->url().toString() 
+                                 << "Type:" << s_requestTable[requestType].name;
+                if (StreamSession* session = StreamSession::fromReply(reply)) {
+                    session->setFinished();
                 }
+                reply->abort();
             }
         }
     }
@@ -1295,43 +1459,43 @@ void ApiManager::abortRequestsByType(const QString& requestType)
  */
 void ApiManager::abortStreamChatByChatId(const QString& chatId)
 {
-    qDebug() << "[ApiManager] Aborting stream chat requests for chatId:" << chatId;
+    LOG_DEBUG(lcStream) << "[ApiManager] Aborting stream chat requests for chatId:" << chatId;
 
     // 复制集合避免遍历时修改
     QSet<QNetworkReply*> repliesToCheck = m_activeReplies;
 
     for (QNetworkReply* reply : repliesToCheck) {
         if (reply && reply->isRunning()) {
-            QString replyType = QString::fromUtf8(reply->request().rawHeader("X-Request-Type"));
-            QString replyChatId = m_streamChatIds.value(reply, "");
-
-            // 只中断匹配chatId的流式聊天请求
-            if (replyType == "stream-chat" && replyChatId == chatId) {
-                qDebug() << "[ApiManager] Aborting stream chat request:" << reply->url().toString()
-                         << "ChatId:" << replyChatId;
+            // 只中断匹配chatId的流式聊天请求（普通流式聊天和知识库流式聊天）
+            StreamSession* session = StreamSession::fromReply(reply);
+            if (session && session->chatId() == chatId) {
+                LOG_DEBUG(lcStream) << "[ApiManager] Aborting stream request:" << reply->url().toString()
+                                    << "ChatId:" << chatId;
+                
+                // 丢弃尚未发送的内容，终止后不再发出任何信号
+                session->setFinished();
                 reply->abort();
+            }
+        }
+    }
+}
 
-                // 清理对应的chatId映射和缓冲区
-                m_streamChatIds.remove(reply);
-                m_streamDataBuffers.remove(reply);
-            } else if (replyType == "stream-knowledge-chat" && m_streamKnowledgeChatIds.value(reply, "") == chatId) {
-                qDebug() << "[ApiManager] Aborting stream knowledge chat request:" << reply->url().toString()
-                         << "ChatId:" << chatId;
-                reply->abort();
+/**
+ * @brief 终止指定上传ID的文件上传
+ * @param uploadId 上传ID
+ *
+ * 被终止的上传会通过 uploadFileFinished 信号返回失败（不可重试）。
+ */
+void ApiManager::abortUpload(const QString& uploadId)
+{
+    // 复制集合避免遍历时修改
+    QSet<QNetworkReply*> repliesToCheck = m_activeReplies;
 
-                // 清理对应的chatId映射和缓冲区
-                m_streamKnowledgeChatIds.remove(reply);
-                m_streamKnowledgeDataBuffers.remove(reply);
-                m_streamKnowledgePendingBuffers.remove(reply);
-                
-                // 清理定时器
-                if (m_streamKnowledgeTimers.contains(reply)) {
-                    QTimer* timer = m_streamKnowledgeTimers[reply];
-                    timer->stop();
-                    timer->deleteLater();
-                    m_streamKnowledgeTimers.remove(reply);
-                }
-            }
+    for (QNetworkReply* reply : repliesToCheck) {
+        if (reply && reply->isRunning()
+            && reply->request().attribute(kUploadIdAttribute).toString() == uploadId) {
+            LOG_DEBUG(lcFile) << "[ApiManager] Aborting upload:" << uploadId;
+            reply->abort();
         }
     }
 }
@@ -1363,9 +1527,23 @@ void ApiManager::loadConfig()
         networkObj["usePublicNetwork"] = true;
         networkObj["internalBaseUrl"] = m_internalBaseUrl;
         networkObj["publicBaseUrl"] = m_publicBaseUrl;
+        networkObj["keepAliveSeconds"] = m_keepAliveSeconds;
+        
+        QJsonObject loggingObj;
+        loggingObj["logBodies"] = m_logBodies;
+        loggingObj["bodyLogLimit"] = m_bodyLogLimit;
+        // 各日志分类的最低级别（由 LogCategories 读取）
+        QJsonObject categoriesObj;
+        categoriesObj["net"] = "debug";
+        categoriesObj["stream"] = "debug";
+        categoriesObj["file"] = "debug";
+        categoriesObj["scorer"] = "debug";
+        categoriesObj["ui"] = "debug";
+        loggingObj["categories"] = categoriesObj;
         
         QJsonObject rootObj;
         rootObj["network"] = networkObj;
+        rootObj["logging"] = loggingObj;
         
         // 写入配置文件
         if (configFile.open(QIODevice::WriteOnly)) {
@@ -1394,6 +1572,16 @@ void ApiManager::loadConfig()
     }
     
     QJsonObject rootObj = doc.object();
+    
+    // 读取body日志配置：logBodies=false 时完全关闭，bodyLogLimit 为单条日志的最大字节数（0表示不截断）
+    QJsonObject loggingObj = rootObj["logging"].toObject();
+    if (loggingObj.contains("logBodies")) {
+        m_logBodies = loggingObj["logBodies"].toBool();
+    }
+    if (loggingObj.contains("bodyLogLimit")) {
+        m_bodyLogLimit = qMax(0, loggingObj["bodyLogLimit"].toInt());
+    }
+    
     if (!rootObj.contains("network")) {
         setusePublicNetwork(true);  // 默认使用公网
         return;
@@ -1418,4 +1606,9 @@ void ApiManager::loadConfig()
     if (networkObj.contains("publicBaseUrl")) {
         m_publicBaseUrl = networkObj["publicBaseUrl"].toString();
     }
+    
+    // 读取连接保活间隔，0表示关闭
+    if (networkObj.contains("keepAliveSeconds")) {
+        m_keepAliveSeconds = qMax(0, networkObj["keepAliveSeconds"].toInt());
+    }
 }
@@ -23,7 +23,11 @@
 #include <QUrlQuery>
 #include <QCoreApplication>
 #include <QTimer>
+#include <QElapsedTimer>
 #include "CommonFunc.h"
+#include "StreamSession.h"
+#include "DownloadSession.h"
+#include "RequestMetrics.h"
 
 /**
  * @brief API管理器类 - 负责处理所有网络API请求
@@ -44,9 +48,54 @@ class ApiManager : public QObject
     /// @brief 是否使用公网，true=公网，false=内网
     QUICK_PROPERTY(bool, usePublicNetwork)
     
+    /**
+     * @brief 按网络和请求类型统计的耗时、流量和错误快照
+     *
+     * 结构与 AppData/metrics/request_metrics.json 相同：
+     * networks.<public|internal>.<请求类型>.{count, firstByteMs, firstTokenMs, totalMs, bytesIn, bytesOut, errors}，
+     * 每个直方图含 count / mean / p50 / p95 / max / buckets。每5秒有新数据时更新一次。
+     */
+    QUICK_PROPERTY(QVariantMap, requestMetrics)
+    
     SINGLETON_CLASS(ApiManager)
 
 public:
+    /**
+     * @brief 请求类型
+     * 
+     * 每个请求在发出时打上类型标记，响应时按类型查表分发到对应的信号。
+     * 新增接口时在此枚举末尾（RequestTypeCount之前）添加一项，并在 s_requestTable 中补充对应描述。
+     */
+    enum RequestType {
+        UnknownRequest = 0,
+        Login,
+        Register,
+        TestConnection,
+        TnmAiScore,
+        RenalAiScore,
+        StreamChat,
+        StreamKnowledgeChat,
+        DeleteChat,
+        AddQualityRecord,
+        GetQualityList,
+        CancerDiagnoseType,
+        SaveReportTemplate,
+        DeleteReportTemplate,
+        GenerateQualityReport,
+        GetReportTemplateList,
+        UploadFile,
+        CreateKnowledgeBase,
+        DeleteKnowledgeBase,
+        UpdateKnowledgeBase,
+        GetKnowledgeBase,
+        GetKnowledgeBaseList,
+        DeleteKnowledgeBaseFiles,
+        GetSystemUpdateList,
+        DownloadAppFile,
+        KeepAlive,
+        RequestTypeCount
+    };
+
     /**
      * @brief 用户登录请求
      * @param username 用户账号
@@ -192,10 +241,19 @@ public:
      * @param filePath 要上传的文件路径
      * @param knowledgeBaseId 知识库ID
      * @param userId 用户ID
+     * @param uploadId 上传ID（可选）
      * 
-     * 发送文件上传请求到服务器，结果通过 uploadFileResponse 信号返回
+     * 发送文件上传请求到服务器。未指定uploadId时结果通过 uploadFileResponse 信号返回；
+     * 指定uploadId时进度和结果分别通过 uploadFileProgress / uploadFileFinished 信号按该ID返回
      */
-    void uploadFileToKnowledgeBase(const QString& filePath, const QString& knowledgeBaseId, const QString& userId);
+    void uploadFileToKnowledgeBase(const QString& filePath, const QString& knowledgeBaseId, const QString& userId,
+                                   const QString& uploadId = QString());
+    
+    /**
+     * @brief 终止指定上传ID的文件上传
+     * @param uploadId 上传ID
+     */
+    void abortUpload(const QString& uploadId);
     
     /**
      * @brief 创建知识库
@@ -268,7 +326,8 @@ public:
      * @brief 下载App文件
      * @param fileName 要下载的文件名
      * 
-     * 发送下载App文件请求到服务器，结果通过 downloadAppFileResponse 信号返回
+     * 发送下载App文件请求到服务器，数据边下载边写入临时目录，上次中断的下载会从断点继续，
+     * 进度通过 downloadAppFileProgress 信号通知，结果通过 downloadAppFileResponse 信号返回
      */
     void downloadAppFile(const QString& fileName);
     
@@ -282,11 +341,18 @@ public:
     
     /**
      * @brief 终止指定类型的网络请求
-     * @param requestType 要终止的请求类型（如 "login", "tnm-ai-score"）
+     * @param requestType 要终止的请求类型（如 Login, TnmAiScore）
      *
      * 只终止匹配指定类型的活跃请求，其他请求继续执行。
      */
-    void abortRequestsByType(const QString& requestType);
+    void abortRequestsByType(RequestType requestType);
+    
+    /**
+     * @brief 获取指定类型已完成的请求数
+     * @param requestType 请求类型
+     * @return 自程序启动以来该类型请求完成（含失败）的次数
+     */
+    int requestCount(RequestType requestType) const;
 
     /**
      * @brief 终止指定chatId的流式聊天请求
@@ -295,6 +361,15 @@ public:
      * 只终止匹配指定chatId的流式聊天请求，其他聊天会话继续执行。
      */
     void abortStreamChatByChatId(const QString& chatId);
+    
+    /**
+     * @brief 设置是否有已登录的会话
+     * @param active 登录成功后为true，退出登录后为false
+     *
+     * 连接保活只在已登录且程序处于前台时进行。登录成功由 loginResponse 自动设置，
+     * 退出登录由 LoginManager 调用。
+     */
+    void setSessionActive(bool active);
 
 signals:
     /**
@@ -448,6 +523,24 @@ signals:
      */
     void uploadFileResponse(bool success, const QString& message, const QJsonObject& data);
     
+    /**
+     * @brief 指定上传ID的文件上传进度信号
+     * @param uploadId 上传ID
+     * @param bytesSent 已发送字节数
+     * @param bytesTotal 请求体总字节数，未知时为-1
+     */
+    void uploadFileProgress(const QString& uploadId, qint64 bytesSent, qint64 bytesTotal);
+    
+    /**
+     * @brief 指定上传ID的文件上传完成信号
+     * @param uploadId 上传ID
+     * @param success 是否上传成功
+     * @param retryable 失败是否由网络原因导致、可以重试（服务器拒绝或手动终止时为false）
+     * @param message 服务器返回的消息或错误描述
+     * @param data 上传结果数据
+     */
+    void uploadFileFinished(const QString& uploadId, bool success, bool retryable, const QString& message, const QJsonObject& data);
+    
     /**
      * @brief 创建知识库响应信号
      * @param success 是否创建成功
@@ -512,6 +605,13 @@ signals:
      */
     void downloadAppFileResponse(bool success, const QString& message, const QJsonObject& data);
     
+    /**
+     * @brief 下载App文件进度信号
+     * @param bytesReceived 已接收字节数
+     * @param bytesTotal 文件总字节数，未知时为-1
+     */
+    void downloadAppFileProgress(qint64 bytesReceived, qint64 bytesTotal);
+    
     /**
      * @brief 网络错误信号
      * @param error 错误描述
@@ -534,21 +634,66 @@ private slots:
      */
     void onNetworkReply(QNetworkReply* reply);
     
-    /**
-     * @brief 流式数据就绪槽函数
-     * 
-     * 当流式聊天接口有新数据可读时调用，处理分块接收的数据
-     */
-    void onStreamDataReady();
+    /// @brief 定时更新 requestMetrics 属性，并定期保存快照
+    void publishMetrics();
     
     /**
-     * @brief 知识库流式数据就绪槽函数
+     * @brief 预先建立到当前API地址的连接
      * 
-     * 当知识库流式聊天接口有新数据可读时调用，处理分块接收的数据
+     * 启动时、登录成功后、切换内网/公网后以及程序回到前台时调用，
+     * 让之后的第一个请求不再等待TCP连接（和TLS握手）。
      */
-    void onStreamKnowledgeDataReady();
+    void warmUpConnection();
+    
+    /// @brief 前台空闲时发送轻量请求，避免连接因空闲被服务器关闭
+    void onKeepAliveTimeout();
+    
+    /// @brief 按登录状态、前台状态和保活配置启动或停止保活定时器
+    void updateKeepAliveTimer();
 
 private:
+    /// @brief 响应信号的统一签名
+    typedef void (ApiManager::*ResponseSignal)(bool, const QString&, const QJsonObject&);
+    
+    /// @brief 请求类型描述
+    struct RequestDescriptor {
+        const char* name;               ///< 请求名称，同时作为X-Request-Type请求头
+        ResponseSignal responseSignal;  ///< 完成时发出的信号，nullptr表示由专门流程处理
+        bool arrayData;                 ///< 响应的data字段是否为数组（需包装为{"data": [...]}）
+    };
+    
+    /// @brief 按 RequestType 顺序排列的请求描述表
+    static const RequestDescriptor s_requestTable[RequestTypeCount];
+    
+    /// @brief 请求类型保存在QNetworkRequest上的属性编号
+    static const QNetworkRequest::Attribute kRequestTypeAttribute = QNetworkRequest::User;
+    
+    /// @brief 上传ID保存在QNetworkRequest上的属性编号
+    static const QNetworkRequest::Attribute kUploadIdAttribute = static_cast<QNetworkRequest::Attribute>(QNetworkRequest::User + 1);
+    
+    /**
+     * @brief 为请求打上类型标记
+     * @param request 待发送的请求
+     * @param requestType 请求类型
+     */
+    void tagRequest(QNetworkRequest& request, RequestType requestType) const;
+    
+    /**
+     * @brief 读取回复对应的请求类型
+     * @param reply 网络回复对象
+     * @return 请求类型，未标记时返回 UnknownRequest
+     */
+    static RequestType requestTypeOf(QNetworkReply* reply);
+    
+    /**
+     * @brief 带上传ID的回复发出 uploadFileFinished 信号
+     * @return 回复没有上传ID时返回false，由调用方按请求类型分发
+     */
+    bool emitUploadFinished(QNetworkReply* reply, bool success, bool retryable, const QString& message, const QJsonObject& data);
+    
+    /// @brief connectionTestResult 信号的响应表适配函数
+    void emitConnectionTestResult(bool success, const QString& message, const QJsonObject& data);
+    
     /**
      * @brief 获取当前使用的基础URL
      * @return 根据usePublicNetwork属性返回对应的API基础地址
@@ -563,20 +708,69 @@ private:
      */
     QNetworkRequest createRequest(const QString& endpoint, bool setJsonContentType = true) const;
     
+    /**
+     * @brief 按配置记录请求/响应体（可关闭，超长内容截断）
+     * @param label 日志前缀
+     * @param body 请求或响应的原始字节
+     */
+    void logBody(const char* label, const QByteArray& body) const;
+    
     /**
      * @brief 发送POST请求
      * @param endpoint API端点路径
      * @param data 请求数据（JSON格式）
-     * @param requestType 请求类型标识，用于响应时区分不同请求
+     * @param requestType 请求类型，用于响应时区分不同请求
      */
-    void makePostRequest(const QString& endpoint, const QJsonObject& data, const QString& requestType = "");
+    void makePostRequest(const QString& endpoint, const QJsonObject& data, RequestType requestType = UnknownRequest);
     
     /**
      * @brief 发送GET请求
      * @param endpoint API端点路径
-     * @param requestType 请求类型标识，用于响应时区分不同请求
+     * @param requestType 请求类型，用于响应时区分不同请求
      */
-    void makeGetRequest(const QString& endpoint, const QString& requestType = "");
+    void makeGetRequest(const QString& endpoint, RequestType requestType = UnknownRequest);
+    
+    /**
+     * @brief 跟踪已发出的请求：加入活跃请求集合，并开始统计耗时和流量
+     * @param reply 网络回复对象，请求类型已通过 tagRequest() 标记
+     * @param bytesOut 请求体字节数，未知时为0（由上传进度更新）
+     */
+    void trackReply(QNetworkReply* reply, qint64 bytesOut = 0);
+    
+    /// @brief 当前网络的统计分组名，public 或 internal
+    QString networkName() const;
+    
+    /**
+     * @brief 发起流式请求
+     * @param kind 流式请求种类
+     * @param endpoint API端点路径
+     * @param requestData 请求数据
+     * @param chatId 会话ID
+     */
+    void startStream(StreamSession::Kind kind, const QString& endpoint, const QJsonObject& requestData, const QString& chatId);
+    
+    /**
+     * @brief 流式数据就绪处理函数
+     * @param session 对应的流式会话
+     * 
+     * 当流式接口有新数据可读时调用，增量解析SSE事件并分发
+     */
+    void onStreamDataReady(StreamSession* session);
+    
+    /// @brief 结束流式会话并发出完成信号（每个会话只发出一次）
+    void finishStreamSession(StreamSession* session, bool success, const QString& message);
+    
+    /// @brief 按会话种类发出流式文本信号
+    void emitStreamResponse(StreamSession* session, const QString& text);
+    
+    /// @brief 下载数据就绪时写入临时文件
+    void onDownloadDataReady(DownloadSession* session);
+    
+    /// @brief 结束下载会话并发出 downloadAppFileResponse 信号（每个会话只发出一次），resumable为true时保留部分文件
+    void finishDownloadSession(DownloadSession* session, bool success, const QString& message, bool resumable = false);
+    
+    /// @brief 解析知识库聊天完成事件中的检索元数据
+    QVariantList parseRetrievedMetadata(const QJsonArray& metadataArray) const;
     
     /**
      * @brief 加载配置文件
@@ -593,27 +787,28 @@ private:
     /// @brief 跟踪所有活跃的网络请求，用于终止操作
     QSet<QNetworkReply*> m_activeReplies;
     
-    /// @brief 跟踪流式聊天请求的chatId映射，用于在接收数据时识别会话
-    QMap<QNetworkReply*, QString> m_streamChatIds;
-    
-    /// @brief 跟踪知识库流式聊天请求的chatId映射，用于在接收数据时识别会话
-    QMap<QNetworkReply*, QString> m_streamKnowledgeChatIds;
-    
-    /// @brief 跟踪每个流式聊天请求的不完整SSE数据缓冲区
-    QMap<QNetworkReply*, QString> m_streamDataBuffers;
+    /// @brief 各类型请求的完成次数
+    int m_requestCounts[RequestTypeCount];
     
-    /// @brief 跟踪每个知识库流式聊天请求的不完整SSE数据缓冲区
-    QMap<QNetworkReply*, QString> m_streamKnowledgeDataBuffers;
-    
-    /// @brief 跟踪每个知识库流式聊天请求的待发送内容缓冲区（用于批量发射信号）
-    QMap<QNetworkReply*, QString> m_streamKnowledgePendingBuffers;
-    
-    /// @brief 跟踪每个知识库流式聊天请求的批量发送定时器
-    QMap<QNetworkReply*, QTimer*> m_streamKnowledgeTimers;
-
     // API地址配置（从config.json读取）
     QString m_internalBaseUrl;  ///< 内网API基础地址
     QString m_publicBaseUrl;    ///< 公网API基础地址
+    
+    // body日志配置（从config.json的logging节读取）
+    bool m_logBodies;           ///< 是否记录请求/响应体
+    int m_bodyLogLimit;         ///< 单条body日志的最大字节数，0表示不截断
+    
+    /// @brief 各类型请求的耗时和流量统计
+    RequestMetrics m_metrics;
+    QTimer m_metricsTimer;          ///< 定时发布统计
+    int m_metricsTicks;             ///< 发布次数，每隔若干次保存一次快照
+    bool m_metricsUnsaved;          ///< 有尚未保存的统计
+    
+    // 连接保活配置（从config.json的network节读取）
+    QTimer m_keepAliveTimer;        ///< 前台时定期检查连接是否空闲
+    QElapsedTimer m_lastActivity;   ///< 距上次发出请求或预连接的时间
+    int m_keepAliveSeconds;         ///< 空闲多久后发送保活请求（秒），0表示关闭
+    bool m_sessionActive;           ///< 是否已登录，未登录时不保活
 };
 
 #endif // APIMANAGER_H
\ No newline at end of file
@@ -0,0 +1,335 @@
+﻿#include "AsyncLogger.h"
+#include "LogArchiver.h"
+#include <QDateTime>
+#include <QDir>
+#include <QElapsedTimer>
+#include <QDebug>
+#include <chrono>
+#include <cstdio>
+
+namespace {
+/// @brief 日志文件首尾的分隔行
+QByteArray bannerLine(const char* state)
+{
+    return QStringLiteral("========== ScoreReport Log %1 at %2 ==========\n")
+        .arg(QString::fromLatin1(state), QDateTime::currentDateTime().toString("yyyy-MM-dd hh:mm:ss"))
+        .toUtf8();
+}
+}
+
+AsyncLogger* AsyncLogger::getInstance()
+{
+    static AsyncLogger instance;
+    return &instance;
+}
+
+AsyncLogger::AsyncLogger()
+    : m_slots(kCapacity)
+    , m_enqueuePos(0)
+    , m_dequeuePos(0)
+    , m_dropped(0)
+    , m_reportedDropped(0)
+    , m_fileBytes(0)
+    , m_fileOpenedAt(0)
+    , m_maxFileSize(10 * 1024 * 1024)
+    , m_maxFileAgeMs(24 * 3600 * 1000LL)
+    , m_wakeRequested(false)
+    , m_running(false)
+{
+    for (quint64 i = 0; i < kCapacity; ++i) {
+        m_slots[i].sequence.store(i, std::memory_order_relaxed);
+    }
+}
+
+AsyncLogger::~AsyncLogger()
+{
+    stop();
+}
+
+void AsyncLogger::setRotation(qint64 maxFileSize, qint64 maxFileAgeSecs)
+{
+    m_maxFileSize = qMax<qint64>(64 * 1024, maxFileSize);
+    m_maxFileAgeMs = qMax<qint64>(60, maxFileAgeSecs) * 1000;
+}
+
+bool AsyncLogger::start(const QString& logDir)
+{
+    if (m_running.load(std::memory_order_acquire)) {
+        return m_file.isOpen();
+    }
+
+    bool opened = false;
+    {
+        std::lock_guard<std::mutex> locker(m_drainMutex);
+        m_logDir = logDir;
+        opened = openSegmentLocked("Started");
+    }
+
+    m_running.store(true, std::memory_order_release);
+    m_writer = std::thread(&AsyncLogger::writerLoop, this);
+    return opened;
+}
+
+void AsyncLogger::stop()
+{
+    if (!m_running.exchange(false, std::memory_order_acq_rel)) {
+        return;
+    }
+    wake();
+    if (m_writer.joinable()) {
+        m_writer.join();
+    }
+
+    std::lock_guard<std::mutex> locker(m_drainMutex);
+    drainLocked();
+    if (m_file.isOpen()) {
+        m_file.write(bannerLine("Ended"));
+        m_file.close();
+    }
+}
+
+bool AsyncLogger::log(QtMsgType type, const QString& message, const char* category)
+{
+    // Fatal 之后进程即终止，写线程停止后也没有人消费队列，都由调用线程当场写完
+    if (type == QtFatalMsg || !m_running.load(std::memory_order_acquire)) {
+        std::lock_guard<std::mutex> locker(m_drainMutex);
+        drainLocked();
+        const bool queued = enqueue(type, message, category);
+        drainLocked();
+        return queued;
+    }
+
+    if (!enqueue(type, message, category)) {
+        return false;
+    }
+    if (type == QtWarningMsg || type == QtCriticalMsg) {
+        wake();
+    }
+    return true;
+}
+
+void AsyncLogger::flush()
+{
+    std::lock_guard<std::mutex> locker(m_drainMutex);
+    drainLocked();
+}
+
+QString AsyncLogger::filePath() const
+{
+    return m_file.fileName();
+}
+
+bool AsyncLogger::enqueue(QtMsgType type, const QString& message, const char* category)
+{
+    quint64 pos = m_enqueuePos.load(std::memory_order_relaxed);
+    for (;;) {
+        Slot& slot = m_slots[pos & (kCapacity - 1)];
+        const quint64 sequence = slot.sequence.load(std::memory_order_acquire);
+        const qint64 diff = static_cast<qint64>(sequence) - static_cast<qint64>(pos);
+        if (diff == 0) {
+            // 槽位空闲，抢占该位置后填写内容再发布
+            if (m_enqueuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                slot.type = type;
+                if (category && qstrcmp(category, "default") != 0) {
+                    qstrncpy(slot.category, category, sizeof(slot.category));
+                } else {
+                    slot.category[0] = '\0';
+                }
+                slot.timestamp = QDateTime::currentMSecsSinceEpoch();
+                slot.message = message;
+                slot.sequence.store(pos + 1, std::memory_order_release);
+                return true;
+            }
+        }
+        else if (diff < 0) {
+            // 写线程还没取走上一轮的内容，队列已满
+            m_dropped.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+        else {
+            pos = m_enqueuePos.load(std::memory_order_relaxed);
+        }
+    }
+}
+
+void AsyncLogger::wake()
+{
+    // 不持有 m_wakeMutex 通知，极少数情况下通知丢失也最多延迟一个写入间隔
+    if (!m_wakeRequested.exchange(true, std::memory_order_acq_rel)) {
+        m_wakeCondition.notify_one();
+    }
+}
+
+void AsyncLogger::writerLoop()
+{
+    while (m_running.load(std::memory_order_acquire)) {
+        {
+            std::unique_lock<std::mutex> locker(m_wakeMutex);
+            m_wakeCondition.wait_for(locker, std::chrono::milliseconds(kFlushIntervalMs), [this]() {
+                return m_wakeRequested.load(std::memory_order_acquire) || !m_running.load(std::memory_order_acquire);
+            });
+            m_wakeRequested.store(false, std::memory_order_release);
+        }
+
+        std::lock_guard<std::mutex> locker(m_drainMutex);
+        drainLocked();
+    }
+}
+
+int AsyncLogger::drainLocked()
+{
+    QByteArray fileBatch;
+    QByteArray consoleBatch;
+    int count = 0;
+
+    for (;;) {
+        Slot& slot = m_slots[m_dequeuePos & (kCapacity - 1)];
+        if (slot.sequence.load(std::memory_order_acquire) != m_dequeuePos + 1) {
+            break;
+        }
+
+        const QByteArray line = formatLine(slot.type, slot.category, slot.timestamp, slot.message);
+        fileBatch += line;
+        consoleBatch += QString::fromUtf8(line).toLocal8Bit();
+        slot.message = QString();
+        // 释放槽位给下一轮的生产者
+        slot.sequence.store(m_dequeuePos + kCapacity, std::memory_order_release);
+        ++m_dequeuePos;
+        ++count;
+    }
+
+    const quint64 dropped = m_dropped.load(std::memory_order_relaxed);
+    if (dropped != m_reportedDropped) {
+        const QByteArray line = formatLine(QtWarningMsg, nullptr, QDateTime::currentMSecsSinceEpoch(),
+            QStringLiteral("[AsyncLogger] Log queue full, dropped %1 messages (%2 in total)")
+                .arg(dropped - m_reportedDropped).arg(dropped));
+        fileBatch += line;
+        consoleBatch += line;
+        m_reportedDropped = dropped;
+    }
+
+    if (fileBatch.isEmpty()) {
+        return 0;
+    }
+
+    if (m_file.isOpen() && needsRotationLocked(fileBatch.size())) {
+        const QString finishedPath = m_file.fileName();
+        m_file.write(bannerLine("Rotated"));
+        m_file.close();
+        LogArchiver::getInstance()->archive(finishedPath);
+        openSegmentLocked("Continued");
+    }
+
+    fwrite(consoleBatch.constData(), 1, static_cast<size_t>(consoleBatch.size()), stderr);
+    fflush(stderr);
+    if (m_file.isOpen()) {
+        m_file.write(fileBatch);
+        m_file.flush();
+        m_fileBytes += fileBatch.size();
+    }
+    return count;
+}
+
+bool AsyncLogger::openSegmentLocked(const char* banner)
+{
+    // 同一秒内多次滚动时追加序号，避免覆盖
+    const QString timestamp = QDateTime::currentDateTime().toString("yyyy-MM-dd_hh-mm-ss");
+    QString filePath = QDir(m_logDir).filePath(QStringLiteral("ScoreReport_%1.log").arg(timestamp));
+    for (int i = 1; QFile::exists(filePath) || QFile::exists(filePath + ".gz"); ++i) {
+        filePath = QDir(m_logDir).filePath(QStringLiteral("ScoreReport_%1_%2.log").arg(timestamp).arg(i));
+    }
+
+    m_file.setFileName(filePath);
+    if (!m_file.open(QIODevice::WriteOnly | QIODevice::Append)) {
+        return false;
+    }
+    const QByteArray line = bannerLine(banner);
+    m_file.write(line);
+    m_file.flush();
+    m_fileBytes = line.size();
+    m_fileOpenedAt = QDateTime::currentMSecsSinceEpoch();
+    return true;
+}
+
+bool AsyncLogger::needsRotationLocked(qint64 pendingBytes) const
+{
+    if (m_fileBytes + pendingBytes > m_maxFileSize) {
+        return true;
+    }
+    return QDateTime::currentMSecsSinceEpoch() - m_fileOpenedAt >= m_maxFileAgeMs;
+}
+
+QByteArray AsyncLogger::formatLine(QtMsgType type, const char* category, qint64 timestamp, const QString& message)
+{
+    const char* typeStr = "DEBUG";
+    switch (type) {
+    case QtDebugMsg:    typeStr = "DEBUG"; break;
+    case QtWarningMsg:  typeStr = "WARN "; break;
+    case QtCriticalMsg: typeStr = "CRIT "; break;
+    case QtFatalMsg:    typeStr = "FATAL"; break;
+    case QtInfoMsg:     typeStr = "INFO "; break;
+    }
+
+    const QString time = QDateTime::fromMSecsSinceEpoch(timestamp).toString("yyyy-MM-dd hh:mm:ss.zzz");
+    QByteArray line;
+    line.reserve(message.size() + 40);
+    line += '[';
+    line += time.toLatin1();
+    line += "] [";
+    line += typeStr;
+    line += "] ";
+    if (category && category[0] != '\0') {
+        line += '[';
+        line += category;
+        line += "] ";
+    }
+    line += message.toUtf8();
+    line += '\n';
+    return line;
+}
+
+void AsyncLogger::messageHandler(QtMsgType type, const QMessageLogContext& context, const QString& message)
+{
+    getInstance()->log(type, message, context.category);
+}
+
+#ifdef QT_DEBUG
+double AsyncLogger::runBenchmark(int threadCount, int messagesPerThread)
+{
+    AsyncLogger* logger = getInstance();
+    const quint64 droppedBefore = logger->droppedCount();
+    std::atomic<bool> go(false);
+
+    std::vector<std::thread> threads;
+    threads.reserve(static_cast<size_t>(threadCount));
+    for (int t = 0; t < threadCount; ++t) {
+        threads.emplace_back([&go, t, messagesPerThread]() {
+            while (!go.load(std::memory_order_acquire)) {
+                std::this_thread::yield();
+            }
+            // 走完整的 qDebug 路径，包括 QDebug 拼接和消息处理器
+            for (int i = 0; i < messagesPerThread; ++i) {
+                qDebug() << "[Benchmark] thread" << t << "message" << i;
+            }
+        });
+    }
+
+    QElapsedTimer timer;
+    timer.start();
+    go.store(true, std::memory_order_release);
+    for (std::thread& thread : threads) {
+        thread.join();
+    }
+    const qint64 elapsedNs = qMax<qint64>(1, timer.nsecsElapsed());
+
+    const double total = static_cast<double>(threadCount) * messagesPerThread;
+    const double callsPerSecond = total * 1e9 / static_cast<double>(elapsedNs);
+    logger->flush();
+    qInfo().noquote() << QStringLiteral("[AsyncLogger] Benchmark: %1 threads x %2 messages in %3 ms, %4 calls/s, %5 dropped")
+                             .arg(threadCount).arg(messagesPerThread)
+                             .arg(elapsedNs / 1000000.0, 0, 'f', 1)
+                             .arg(callsPerSecond, 0, 'f', 0)
+                             .arg(logger->droppedCount() - droppedBefore);
+    return callsPerSecond;
+}
+#endif
@@ -0,0 +1,132 @@
+﻿#ifndef ASYNCLOGGER_H
+#define ASYNCLOGGER_H
+
+#include <QString>
+#include <QFile>
+#include <QtGlobal>
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/**
+ * @brief 异步日志后端 - 取代原先加锁、逐条 flush 的 customMessageOutput
+ *
+ * 调用线程只把消息类型、分类、时间戳和消息文本放入一个固定容量的无锁环形队列（多生产者单消费者），
+ * 不格式化、不写文件，也不等待任何锁：
+ * - 独立的写线程每隔 kFlushIntervalMs 或被唤醒时取出队列中的全部消息，
+ *   格式化为 "[时间] [级别] [分类] 消息" 后一次性写入文件和控制台
+ * - Warning 及以上级别立即唤醒写线程；Fatal 由调用线程当场写完再返回，保证崩溃前落盘
+ * - 队列满时直接丢弃并计数，写线程在下一批日志中记录丢弃条数，调用方永不阻塞
+ *
+ * 日志按分段写入 ScoreReport_<时间>.log：当前分段超过 setRotation() 设置的大小或时长后，
+ * 写线程关闭该分段、打开新分段，并交给 LogArchiver 在后台压缩和清理。
+ *
+ * main.cpp 中 initializeLogging() 调用 start() 打开第一个分段，退出时 stop() 写完剩余日志。
+ */
+class AsyncLogger
+{
+public:
+    static AsyncLogger* getInstance();
+
+    /**
+     * @brief 设置分段滚动条件，须在 start() 之前调用
+     * @param maxFileSize 单个分段的最大字节数
+     * @param maxFileAgeSecs 单个分段最长写入时间（秒）
+     */
+    void setRotation(qint64 maxFileSize, qint64 maxFileAgeSecs);
+
+    /**
+     * @brief 打开第一个日志分段并启动写线程
+     * @param logDir 日志目录
+     * @return 文件是否打开成功；失败时仍启动写线程，只输出到控制台
+     */
+    bool start(const QString& logDir);
+
+    /// @brief 写完队列中的所有日志并停止写线程
+    void stop();
+
+    /**
+     * @brief 提交一条日志，可在任意线程调用
+     * @param category 日志分类名，为空或 "default" 时不输出分类
+     * @return 队列已满被丢弃时返回 false
+     */
+    bool log(QtMsgType type, const QString& message, const char* category = nullptr);
+
+    /// @brief 阻塞直到当前队列中的日志全部写入文件
+    void flush();
+
+    /// @brief 因队列满累计丢弃的日志条数
+    quint64 droppedCount() const { return m_dropped.load(std::memory_order_relaxed); }
+
+    /// @brief 当前分段的文件路径
+    QString filePath() const;
+
+#ifdef QT_DEBUG
+    /**
+     * @brief 多线程写日志基准测试，仅调试版本提供
+     * @param threadCount 并发写日志的线程数
+     * @param messagesPerThread 每个线程写入的条数
+     * @return 调用方视角的每秒日志调用次数
+     */
+    static double runBenchmark(int threadCount, int messagesPerThread);
+#endif
+
+    /// @brief 安装给 qInstallMessageHandler 的处理函数
+    static void messageHandler(QtMsgType type, const QMessageLogContext& context, const QString& message);
+
+private:
+    AsyncLogger();
+    ~AsyncLogger();
+    AsyncLogger(const AsyncLogger&) = delete;
+    AsyncLogger& operator=(const AsyncLogger&) = delete;
+
+    /// @brief 队列中的一个槽位，sequence 表示该槽位当前可写（== 位置）还是可读（== 位置 + 1）
+    struct Slot {
+        std::atomic<quint64> sequence;
+        QtMsgType type;
+        char category[16];      ///< 分类名副本，QML等动态分类的名字不保证长期有效
+        qint64 timestamp;       ///< 毫秒时间戳
+        QString message;
+    };
+
+    /// @brief 队列容量（2的幂）
+    static const quint64 kCapacity = 8192;
+    /// @brief 写线程的批量写入间隔
+    static const int kFlushIntervalMs = 20;
+
+    bool enqueue(QtMsgType type, const QString& message, const char* category);
+    void wake();
+    void writerLoop();
+    /// @brief 取出队列中的全部日志并写入，调用方须持有 m_drainMutex
+    int drainLocked();
+    /// @brief 打开一个新分段，调用方须持有 m_drainMutex
+    bool openSegmentLocked(const char* banner);
+    /// @brief 当前分段写入 pendingBytes 后是否超出大小或时长
+    bool needsRotationLocked(qint64 pendingBytes) const;
+
+    static QByteArray formatLine(QtMsgType type, const char* category, qint64 timestamp, const QString& message);
+
+    std::vector<Slot> m_slots;
+    alignas(64) std::atomic<quint64> m_enqueuePos;
+    alignas(64) quint64 m_dequeuePos;           ///< 只由持有 m_drainMutex 的线程修改
+    std::atomic<quint64> m_dropped;
+    quint64 m_reportedDropped;                  ///< 已写入日志的丢弃条数
+
+    std::mutex m_drainMutex;                    ///< 同一时间只有一个消费者取队列并写文件
+    QFile m_file;
+    QString m_logDir;
+    qint64 m_fileBytes;                         ///< 当前分段已写入的字节数
+    qint64 m_fileOpenedAt;                      ///< 当前分段打开时间（毫秒时间戳）
+    qint64 m_maxFileSize;
+    qint64 m_maxFileAgeMs;
+
+    std::mutex m_wakeMutex;
+    std::condition_variable m_wakeCondition;
+    std::atomic<bool> m_wakeRequested;
+    std::atomic<bool> m_running;
+    std::thread m_writer;
+};
+
+#endif // ASYNCLOGGER_H
@@ -2,15 +2,35 @@
 #include <QGuiApplication>
 #include <QClipboard>
 #include <QDebug>
+#include <QFile>
+#include <QSaveFile>
+#include <QDir>
+#include <QDataStream>
+#include <QCryptographicHash>
+#include <algorithm>
+#include <cmath>
+
+namespace {
+const char* const kModelPath = "Scripts/model/model_fold_1.json";
+const char* const kTableDir = "AppData/cache/";
+const char* const kTableFile = "ccls_ai_table.bin";
+const quint32 kTableMagic = 0x43434C53;  // "CCLS"
+const quint32 kTableVersion = 1;
+const double kBaseScore = 0.5612296;     // 训练数据的正类比重
+}
 
 CCLSAIScorer::CCLSAIScorer(QObject* parent)
     : QObject(parent)
     , resultText("")
+    , m_tableReady(false)
 {
     setsourceText(QStringLiteral("评分依据：Mayo Clinic CCLS系统（整合cn-ccLS囊变特征）\n版本时间：第2版（2023年修订）"));
     setcclsResult(0.0);
     setccrccResult(0.0);
     setcalculating(false);
+
+    // 启动时准备好全部144种输入组合的结果，评分时只做一次查表
+    m_tableReady = prepareTable();
 }
 
 void CCLSAIScorer::calculateKidney(int t2, int enhancement, int micro, int sei, int ader, int disp)
@@ -23,96 +43,283 @@ void CCLSAIScorer::calculateKidney(int t2, int enhancement, int micro, int sei,
         return;
     }
 
+    if (t2 < 0 || t2 > 2 || enhancement < 0 || enhancement > 2 || micro < 0 || micro > 1 ||
+        sei < 0 || sei > 1 || ader < 0 || ader > 1 || disp < 0 || disp > 1) {
+        qWarning() << QStringLiteral("参数超出范围，无法计算");
+        emit calculationFinished(false, QStringLiteral("参数超出范围"));
+        return;
+    }
+
+    if (!m_tableReady) {
+        qWarning() << QStringLiteral("CCLS-AI查找表不可用:") << m_tableError;
+        emit calculationFinished(false, QStringLiteral("模型加载失败：") + m_tableError);
+        return;
+    }
+
     setcalculating(true);
 
-    // 构建Python程序路径
-    QString pythonPath = "Scripts/kidney_processor.exe";
-    
-    // 准备参数
-    QStringList arguments;
-    arguments << QString::number(t2)
-              << QString::number(enhancement)
-              << QString::number(micro)
-              << QString::number(sei)
-              << QString::number(ader)
-              << QString::number(disp);
-
-    // 创建进程
-    QProcess* process = new QProcess(this);
-    
-    // 连接信号
-    connect(process, QOverload<int, QProcess::ExitStatus>::of(&QProcess::finished),
-        [=](int exitCode, QProcess::ExitStatus exitStatus) {
-            setcalculating(false);
-            
-            if (exitStatus == QProcess::NormalExit && exitCode == 0) {
-                QString output = QString::fromUtf8(process->readAllStandardOutput());
-                QString error = QString::fromUtf8(process->readAllStandardError());
-                
-                // 解析输出结果
-                QStringList lines = output.split('\n', Qt::SkipEmptyParts);
-                bool foundCCLS = false;
-                bool foundCCRCC = false;
-                
-                for (const QString& line : lines) {
-                    if (line.contains("result ccls:", Qt::CaseInsensitive)) {
-                        QStringList parts = line.split(':');
-                        if (parts.size() >= 2) {
-                            bool ok;
-                            double value = parts[1].trimmed().toDouble(&ok);
-                            if (ok) {
-                                setcclsResult(value);
-                                foundCCLS = true;
-                                qDebug() << QStringLiteral("CCLS结果:") << value;
-                            }
-                        }
-                    } else if (line.contains("result ccrcc:", Qt::CaseInsensitive)) {
-                        QStringList parts = line.split(':');
-                        if (parts.size() >= 2) {
-                            bool ok;
-                            double value = parts[1].trimmed().toDouble(&ok);
-                            if (ok) {
-                                setccrccResult(value);
-                                foundCCRCC = true;
-                                qDebug() << QStringLiteral("CCRCC结果:") << value;
-                            }
-                        }
-                    }
-                }
-                
-                if (!error.isEmpty()) {
-                    qDebug() << QStringLiteral("错误:") << error;
-                }
-                
-                if (foundCCLS && foundCCRCC) {
-                    finishScore(getcclsResult(), getccrccResult());
-                    emit calculationFinished(true, "");
-                } else {
-                    emit calculationFinished(false, QStringLiteral("未能解析计算结果"));
-                }
-            } else {
-                qWarning() << QStringLiteral("计算失败！退出代码:") << exitCode;
-                QString errorMsg = QString::fromUtf8(process->readAllStandardError());
-                qWarning() << QStringLiteral("错误信息:") << errorMsg;
-                emit calculationFinished(false, QStringLiteral("计算失败：") + errorMsg);
+    const Prediction& prediction = m_table[tableIndex(t2, enhancement, micro, sei, ader, disp)];
+    double ccls = cclsProbability(prediction.cclsLevel);
+    double ccrcc = prediction.ccrcc;
+
+    qDebug() << QStringLiteral("CCLS结果:") << ccls;
+    qDebug() << QStringLiteral("CCRCC结果:") << ccrcc;
+
+    setcclsResult(ccls);
+    setccrccResult(ccrcc);
+    setcalculating(false);
+
+    finishScore(ccls, ccrcc);
+    emit calculationFinished(true, "");
+}
+
+/**
+ * @brief CCLS核心决策树，与 kidney_processor.py 中的 CCLS() 一致
+ * @return CCLS等级 1-5，输入组合不在树中时返回0
+ */
+int CCLSAIScorer::classifyCCLS(int t2, int enhancement, int micro, int sei, int ader, int disp)
+{
+    if (t2 == LowSignal) {
+        if (enhancement == Mild) {
+            return micro == Yes ? 3 : 1;
+        } else if (enhancement == Moderate) {
+            return 3;
+        } else if (enhancement == Obvious) {
+            if (ader == No) {
+                return disp == Yes ? 3 : 4;
             }
-            process->deleteLater();
-        });
-    
-    connect(process, &QProcess::errorOccurred, [=](QProcess::ProcessError error) {
-        setcalculating(false);
-        qWarning() << QStringLiteral("进程错误:") << error;
-        QString errorMsg = process->errorString();
-        qWarning() << QStringLiteral("错误信息:") << errorMsg;
-        emit calculationFinished(false, QStringLiteral("进程错误：") + errorMsg);
-        process->deleteLater();
-    });
-
-    // 启动进程
-    qDebug() << QStringLiteral("启动计算程序:") << pythonPath;
-    qDebug() << QStringLiteral("参数:") << arguments;
-    process->start(pythonPath, arguments);
+            return disp == Yes ? 2 : 3;
+        }
+    } else if (t2 == MidSignal) {
+        if (enhancement == Mild) {
+            if (micro == No) {
+                return disp == Yes ? 1 : 2;
+            }
+            return 3;
+        } else if (enhancement == Moderate) {
+            if (micro == No) {
+                return sei == Yes ? 2 : 3;
+            }
+            return 3;
+        } else if (enhancement == Obvious) {
+            if (micro == No) {
+                return sei == Yes ? 3 : 4;
+            }
+            return 5;
+        }
+    } else if (t2 == HighSignal) {
+        if (enhancement == Mild) {
+            return 3;
+        } else if (enhancement == Moderate) {
+            if (micro == No) {
+                return sei == Yes ? 2 : 3;
+            }
+            return 3;
+        } else if (enhancement == Obvious) {
+            if (micro == No) {
+                return sei == Yes ? 3 : 4;
+            }
+            return 5;
+        }
+    }
+    return 0;
+}
+
+/**
+ * @brief CCLS等级对应的ccRCC概率
+ */
+double CCLSAIScorer::cclsProbability(int level)
+{
+    switch (level) {
+    case 1: return 0.05;
+    case 2: return 0.06;
+    case 3: return 0.35;
+    case 4: return 0.78;
+    case 5: return 0.93;
+    default: return 0.0;
+    }
+}
+
+int CCLSAIScorer::tableIndex(int t2, int enhancement, int micro, int sei, int ader, int disp)
+{
+    return ((((t2 * 3 + enhancement) * 2 + micro) * 2 + sei) * 2 + ader) * 2 + disp;
+}
+
+bool CCLSAIScorer::prepareTable()
+{
+    QFile modelFile(kModelPath);
+    if (!modelFile.open(QIODevice::ReadOnly)) {
+        m_tableError = QStringLiteral("无法打开模型文件: %1").arg(kModelPath);
+        qWarning() << "[CCLSAIScorer]" << m_tableError;
+        return false;
+    }
+    QCryptographicHash hash(QCryptographicHash::Sha256);
+    hash.addData(&modelFile);
+    modelFile.close();
+    QByteArray modelHash = hash.result();
+
+    QString tablePath = QString(kTableDir) + kTableFile;
+    if (loadTable(tablePath, modelHash)) {
+        qDebug() << "[CCLSAIScorer] Loaded prediction table from" << tablePath;
+        return true;
+    }
+
+    qDebug() << "[CCLSAIScorer] Prediction table missing or stale, rebuilding from" << kModelPath;
+    if (!buildTable(kModelPath)) {
+        return false;
+    }
+    saveTable(tablePath, modelHash);
+    return true;
+}
+
+bool CCLSAIScorer::loadTable(const QString& tablePath, const QByteArray& modelHash)
+{
+    QFile file(tablePath);
+    if (!file.open(QIODevice::ReadOnly)) {
+        return false;
+    }
+
+    QDataStream in(&file);
+    in.setVersion(QDataStream::Qt_5_15);
+    in.setFloatingPointPrecision(QDataStream::SinglePrecision);
+
+    quint32 magic = 0, version = 0, count = 0;
+    QByteArray storedHash;
+    in >> magic >> version >> storedHash >> count;
+    if (magic != kTableMagic || version != kTableVersion || storedHash != modelHash
+        || count != static_cast<quint32>(kTableSize)) {
+        return false;
+    }
+
+    Prediction table[kTableSize];
+    for (int i = 0; i < kTableSize; ++i) {
+        in >> table[i].cclsLevel >> table[i].ccrcc;
+    }
+    if (in.status() != QDataStream::Ok || !in.atEnd()) {
+        return false;
+    }
+
+    std::copy(table, table + kTableSize, m_table);
+    return true;
+}
+
+bool CCLSAIScorer::buildTable(const QString& modelPath)
+{
+    XGBoostModel model;
+    if (!model.load(modelPath, kBaseScore)) {
+        m_tableError = model.errorString();
+        return false;
+    }
+
+    for (int t2 = 0; t2 < 3; ++t2)
+    for (int enhancement = 0; enhancement < 3; ++enhancement)
+    for (int micro = 0; micro < 2; ++micro)
+    for (int sei = 0; sei < 2; ++sei)
+    for (int ader = 0; ader < 2; ++ader)
+    for (int disp = 0; disp < 2; ++disp) {
+        int level = classifyCCLS(t2, enhancement, micro, sei, ader, disp);
+
+        // CCLS决策树得出的概率同时作为XGBoost模型的第7个特征（label）
+        const float features[] = {
+            static_cast<float>(t2),
+            static_cast<float>(enhancement),
+            static_cast<float>(micro),
+            static_cast<float>(sei),
+            static_cast<float>(ader),
+            static_cast<float>(disp),
+            static_cast<float>(cclsProbability(level))
+        };
+
+        Prediction& prediction = m_table[tableIndex(t2, enhancement, micro, sei, ader, disp)];
+        prediction.cclsLevel = static_cast<quint8>(level);
+        prediction.ccrcc = model.predictProbability(features);
+    }
+    return true;
+}
+
+void CCLSAIScorer::saveTable(const QString& tablePath, const QByteArray& modelHash) const
+{
+    QDir().mkpath(kTableDir);
+
+    QSaveFile file(tablePath);
+    if (!file.open(QIODevice::WriteOnly)) {
+        qWarning() << "[CCLSAIScorer] Failed to write prediction table:" << tablePath;
+        return;
+    }
+
+    QDataStream out(&file);
+    out.setVersion(QDataStream::Qt_5_15);
+    out.setFloatingPointPrecision(QDataStream::SinglePrecision);
+    out << kTableMagic << kTableVersion << modelHash << static_cast<quint32>(kTableSize);
+    for (int i = 0; i < kTableSize; ++i) {
+        out << m_table[i].cclsLevel << m_table[i].ccrcc;
+    }
+
+    if (!file.commit()) {
+        qWarning() << "[CCLSAIScorer] Failed to commit prediction table:" << file.errorString();
+    }
+}
+
+#ifdef QT_DEBUG
+int CCLSAIScorer::verifyGoldenTable(const QString& csvPath)
+{
+    QFile file(csvPath);
+    if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) {
+        qWarning() << "[CCLSAIScorer] Cannot open golden table:" << csvPath;
+        return -1;
+    }
+    m_tableReady = buildTable(kModelPath);
+    if (!m_tableReady) {
+        return -1;
+    }
+
+    // 每行：t2,enhancement,micro,sei,ader,disp,cclsLevel,ccls,ccrcc；'#' 开头为注释，首行为表头
+    const float kTolerance = 1e-6f;
+    int rows = 0;
+    int mismatches = 0;
+    bool header = true;
+    while (!file.atEnd()) {
+        const QString line = QString::fromUtf8(file.readLine()).trimmed();
+        if (line.isEmpty() || line.startsWith('#')) {
+            continue;
+        }
+        if (header) {
+            header = false;
+            continue;
+        }
+
+        const QStringList fields = line.split(',');
+        if (fields.size() != 9) {
+            qWarning() << "[CCLSAIScorer] Malformed golden row:" << line;
+            return -1;
+        }
+        int inputs[6];
+        for (int i = 0; i < 6; ++i) {
+            inputs[i] = fields.at(i).toInt();
+        }
+        const int expectedLevel = fields.at(6).toInt();
+        const double expectedCcls = fields.at(7).toDouble();
+        const float expectedCcrcc = fields.at(8).toFloat();
+
+        const Prediction& prediction = m_table[tableIndex(inputs[0], inputs[1], inputs[2], inputs[3], inputs[4], inputs[5])];
+        ++rows;
+        if (prediction.cclsLevel != expectedLevel
+            || !qFuzzyCompare(cclsProbability(prediction.cclsLevel) + 1.0, expectedCcls + 1.0)
+            || std::abs(prediction.ccrcc - expectedCcrcc) > kTolerance) {
+            ++mismatches;
+            qWarning() << "[CCLSAIScorer] Golden mismatch for" << line << "got level:" << prediction.cclsLevel
+                       << "ccrcc:" << QString::number(prediction.ccrcc, 'g', 9);
+        }
+    }
+
+    if (rows != kTableSize) {
+        qWarning() << "[CCLSAIScorer] Golden table has" << rows << "rows, expected" << kTableSize;
+        return -1;
+    }
+    qInfo() << "[CCLSAIScorer] Golden check:" << rows << "rows," << mismatches << "mismatches";
+    return mismatches;
 }
+#endif
 
 void CCLSAIScorer::finishScore(double cclsValue, double ccrccValue)
 {
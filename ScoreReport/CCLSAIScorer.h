@@ -3,9 +3,10 @@
 
 #include <QObject>
 #include <QString>
-#include <QProcess>
+#include <QByteArray>
 #include "CommonFunc.h"
 #include "ApiManager.h"
+#include "XGBoostModel.h"
 
 class CCLSAIScorer : public QObject
 {
@@ -41,11 +42,49 @@ public:
     Q_INVOKABLE void finishScore(double cclsValue, double ccrccValue);
     Q_INVOKABLE void copyToClipboard();
 
+#ifdef QT_DEBUG
+    /**
+     * @brief 用 kidney_processor.py 生成的基准表校验全部144种组合（仅调试版本）
+     * @param csvPath Scripts/python/make_golden_table.py 生成的CSV
+     * @return 不一致的组合数；模型或基准表无法读取时返回 -1
+     *
+     * 直接从模型文件重新计算，不使用 AppData/cache 中的查找表。
+     */
+    int verifyGoldenTable(const QString& csvPath);
+#endif
+
 signals:
     void calculationFinished(bool success, QString errorMessage);
 
 private:
+    /// @brief 输入空间大小：T2(3) × 强化(3) × 微观脂肪/SEI/ADER/弥散受限(各2)
+    static const int kTableSize = 3 * 3 * 2 * 2 * 2 * 2;
+
+    /// @brief 查找表中的一项预测结果
+    struct Prediction {
+        quint8 cclsLevel;   ///< CCLS决策树等级 0-5
+        float ccrcc;        ///< CCRCC模型输出概率
+    };
+
+    static int classifyCCLS(int t2, int enhancement, int micro, int sei, int ader, int disp);
+    static double cclsProbability(int level);
+    static int tableIndex(int t2, int enhancement, int micro, int sei, int ader, int disp);
+
+    /**
+     * @brief 准备全输入空间的预测查找表
+     *
+     * 优先读取 AppData/cache 下的二进制缓存；缓存不存在、损坏或与当前模型文件的
+     * SHA-256 不一致时，加载XGBoost模型重新计算全部组合并写回缓存。
+     */
+    bool prepareTable();
+    bool loadTable(const QString& tablePath, const QByteArray& modelHash);
+    bool buildTable(const QString& modelPath);
+    void saveTable(const QString& tablePath, const QByteArray& modelHash) const;
+
     QString resultText;
+    Prediction m_table[kTableSize];
+    bool m_tableReady;
+    QString m_tableError;
 };
 
 #endif // CCLSAISCORER_H
@@ -1,8 +1,12 @@
 ﻿#include "ChatManager.h"
 #include "ApiManager.h"
 #include "LoginManager.h"
+#include "DocxReader.h"
+#include "ExtractedTextCache.h"
+#include "LogCategories.h"
 #include <QDateTime>
 #include <QDebug>
+#include <QElapsedTimer>
 #include <QDir>
 #include <QFileInfo>
 #include <QJsonDocument>
@@ -42,6 +46,8 @@ ChatManager::ChatManager(QObject* parent)
     , m_lastUserMessage("")
     , m_maxFileCount(DEFAULT_MAX_FILE_COUNT)
     , m_maxFileSize(DEFAULT_MAX_FILE_SIZE)
+    , m_messageModel(new ChatMessageModel(this))
+    , m_currentAiLength(0)
 {
     // 连接API管理器的信号
     auto* apiManager = GET_SINGLETON(ApiManager);
@@ -86,7 +92,7 @@ void ChatManager::sendMessage(const QString& message)
     // 设置发送状态
     setisSending(true);
     setisThinking(true);
-    m_currentAiMessage.clear();
+    m_currentAiLength = 0;
     
     // 显示思考状态
     addThinkingMessage();
@@ -102,14 +108,14 @@ void ChatManager::sendMessage(const QString& message)
 void ChatManager::resetWithWelcomeMessage()
 {
     // 清空消息列表
-    setmessages(QVariantList());
+    m_messageModel->clear();
     
     // 重新生成会话ID
     m_currentChatId = CommonFunc::generateNumericUUID();
     setcurrentChatId(m_currentChatId);
     
     // 重置所有状态
-    m_currentAiMessage.clear();
+    m_currentAiLength = 0;
     setisSending(false);
     setisThinking(false);
     setlastUserMessage("");
@@ -128,14 +134,7 @@ void ChatManager::regenerateLastResponse()
     }
     
     // 移除最后一条AI消息
-    QVariantList currentMessages = getmessages();
-    if (!currentMessages.isEmpty()) {
-        QVariantMap lastMessage = currentMessages.last().toMap();
-        if (lastMessage["type"].toString() == "ai") {
-            currentMessages.removeLast();
-            setmessages(currentMessages);
-        }
-    }
+    m_messageModel->removeLast("ai");
     
     // 重新发送最后一条消息
     QString lastMessage = getlastUserMessage();
@@ -143,7 +142,7 @@ void ChatManager::regenerateLastResponse()
     // 设置状态
     setisSending(true);
     setisThinking(true);
-    m_currentAiMessage.clear();
+    m_currentAiLength = 0;
     
     addThinkingMessage();
     
@@ -160,100 +159,50 @@ void ChatManager::endAnalysis(bool clearfile)
     // 中断当前聊天
     GET_SINGLETON(ApiManager)->abortStreamChatByChatId(m_currentChatId);
     
+    // 立即刷新待更新内容
+    m_messageModel->flushPending();
+    
     // 取消所有文件上传（读取）任务（确保不在持锁状态下等待线程）
     if (clearfile) {
         clearFiles();
     }
     
     // 重置状态
-    m_currentAiMessage.clear();
+    m_currentAiLength = 0;
     setisSending(false);
     setisThinking(false);
     
     // 替换思考消息为中断消息
-    QVariantList currentMessages = getmessages();
-    if (!currentMessages.isEmpty() && currentMessages.last().toMap()["type"] == "thinking") {
-        currentMessages.removeLast();
-        
-        QVariantMap interruptMessage;
-        interruptMessage["type"] = "interrupt";
-        interruptMessage["content"] = QStringLiteral("消息已中断！");
-        interruptMessage["timestamp"] = QDateTime::currentDateTime().toString("hh:mm");
-        currentMessages.append(interruptMessage);
-        
-        setmessages(currentMessages);
+    if (m_messageModel->removeLast("thinking")) {
+        m_messageModel->append("interrupt", QStringLiteral("消息已中断！"));
     }
 }
 
 void ChatManager::addUserMessage(const QString& message)
 {
-    QVariantMap userMessage;
-    userMessage["type"] = "user";
-    userMessage["content"] = message;
-    userMessage["timestamp"] = QDateTime::currentDateTime().toString("hh:mm");
-    
-    QVariantList currentMessages = getmessages();
-    currentMessages.append(userMessage);
-    setmessages(currentMessages);
+    m_messageModel->append("user", message);
 }
 
 void ChatManager::addAiMessage(const QString& message)
 {
-    QVariantMap aiMessage;
-    aiMessage["type"] = "ai";
-    aiMessage["content"] = message;
-    aiMessage["timestamp"] = QDateTime::currentDateTime().toString("hh:mm");
-    
-    QVariantList currentMessages = getmessages();
-    currentMessages.append(aiMessage);
-    setmessages(currentMessages);
+    m_messageModel->append("ai", message);
 }
 
 void ChatManager::addThinkingMessage()
 {
-    QVariantMap thinkingMessage;
-    thinkingMessage["type"] = "thinking";
-    thinkingMessage["content"] = QStringLiteral("思考中");
-    thinkingMessage["timestamp"] = QDateTime::currentDateTime().toString("hh:mm");
-    
-    QVariantList currentMessages = getmessages();
-    currentMessages.append(thinkingMessage);
-    setmessages(currentMessages);
+    m_messageModel->append("thinking", QStringLiteral("思考中"));
 }
 
 void ChatManager::removeThinkingMessage()
 {
-    QVariantList currentMessages = getmessages();
-    
     // 从后往前查找并移除思考中消息
-    for (int i = currentMessages.size() - 1; i >= 0; i--) {
-        QVariantMap message = currentMessages[i].toMap();
-        if (message["type"].toString() == "thinking") {
-            currentMessages.removeAt(i);
-            setmessages(currentMessages);
-            break;
-        }
-    }
+    m_messageModel->removeLastOfType("thinking");
 }
 
 void ChatManager::updateLastAiMessage(const QString& additionalText)
 {
-    QVariantList currentMessages = getmessages();
-    if (currentMessages.isEmpty()) {
-        return;
-    }
-    
-    QVariantMap lastMessage = currentMessages.last().toMap();
-    if (lastMessage["type"].toString() == "ai") {
-        // 追加内容
-        QString currentContent = lastMessage["content"].toString();
-        lastMessage["content"] = currentContent + additionalText;
-        
-        // 更新消息列表
-        currentMessages.removeLast();
-        currentMessages.append(lastMessage);
-        setmessages(currentMessages);
-    }
+    // 原地追加到最后一条AI消息，按渲染帧合并后只刷新这一行
+    m_messageModel->appendToLastDeferred("ai", additionalText);
 }
 
 QString ChatManager::buildMessageWithFiles(const QString& userMessage, const QVariantList& files)
@@ -322,15 +271,15 @@ void ChatManager::onStreamChatResponse(const QString& data, const QString& chatI
         return;
     }
     
-    if (m_currentAiMessage.isEmpty()) {
+    if (m_currentAiLength == 0) {
         // 第一次接收响应：移除思考状态
     setisThinking(false);
         removeThinkingMessage();
         addAiMessage(data);
-        m_currentAiMessage = data;
+        m_currentAiLength += data.size();
     } else {
-        // 追加响应内容
-        m_currentAiMessage += data;
+        // 追加响应内容，按渲染帧合并刷新
+        m_currentAiLength += data.size();
         updateLastAiMessage(data);
     }
 }
@@ -342,7 +291,10 @@ void ChatManager::onStreamChatFinished(bool success, const QString& message, con
         return;
     }
     
-    qDebug() << "[ChatManager] Chat finished, success:" << success;
+    LOG_DEBUG(lcStream) << "[ChatManager] Chat finished, success:" << success;
+    
+    // 立即刷新所有待更新的内容
+    m_messageModel->flushPending();
     
     // 重置状态
     setisSending(false);
@@ -355,12 +307,12 @@ void ChatManager::onStreamChatFinished(bool success, const QString& message, con
     }
     
     // 处理空响应
-    if (m_currentAiMessage.isEmpty()) {
+    if (m_currentAiLength == 0) {
         removeThinkingMessage();
         addAiMessage(QStringLiteral("抱歉，我无法回复您的消息。"));
     }
     
-    m_currentAiMessage.clear();
+    m_currentAiLength = 0;
 }
 
 bool ChatManager::addFile(const QString& filePath)
@@ -424,7 +376,7 @@ int ChatManager::addFiles(const QStringList& filePaths)
         }
     }
     
-    qDebug() << "[ChatManager] Batch add files: added" << addedCount << "skipped" << skipCount;
+    LOG_DEBUG(lcFile) << "[ChatManager] Batch add files: added" << addedCount << "skipped" << skipCount;
     return addedCount;
 }
 
@@ -453,7 +405,7 @@ bool ChatManager::removeFile(int index)
     
     emit fileOperationResult(QStringLiteral("文件已移除！"), "warning");
     
-    qDebug() << "[ChatManager] File removed at index:" << index;
+    LOG_DEBUG(lcFile) << "[ChatManager] File removed at index:" << index;
     return true;
 }
 
@@ -556,7 +508,7 @@ QString ChatManager::readFileContent(const QString& filePath)
     QFileInfo fileInfo(filePath);
     
     if (!fileInfo.exists() || !fileInfo.isFile()) {
-        qDebug() << "[ChatManager] File does not exist:" << filePath;
+        LOG_DEBUG(lcFile) << "[ChatManager] File does not exist:" << filePath;
         return QString();
     }
     
@@ -573,7 +525,7 @@ QString ChatManager::readFileContent(const QString& filePath)
             file.close();
             return content;
         } else {
-            qDebug() << "[ChatManager] Failed to open txt file:" << filePath;
+            LOG_DEBUG(lcFile) << "[ChatManager] Failed to open txt file:" << filePath;
             return QString();
         }
     }
@@ -594,7 +546,14 @@ QString ChatManager::readFileContent(const QString& filePath)
 
 QString ChatManager::readDocxContent(const QString& filePath)
 {
-    return readWordDocumentWithPowerShell(filePath, QStringLiteral("DOCX文档: %1 - 内容读取需要Microsoft Word"));
+    // DOCX直接解析压缩包中的 word/document.xml，不需要启动Word
+    DocxReader reader;
+    if (reader.read(filePath) && !reader.text().isEmpty()) {
+        return reader.text();
+    }
+
+    LOG_DEBUG(lcFile) << "[ChatManager] DOCX read failed:" << reader.errorString();
+    return QStringLiteral("[DOCX文档: %1 - 内容读取失败]").arg(QFileInfo(filePath).fileName());
 }
 
 QString ChatManager::readDocContent(const QString& filePath)
@@ -627,29 +586,13 @@ QString ChatManager::readWordDocumentWithPowerShell(const QString& filePath, con
         }
     }
     
-    qDebug() << "[ChatManager] PowerShell method failed for" << fileInfo.suffix();
+    LOG_DEBUG(lcFile) << "[ChatManager] PowerShell method failed for" << fileInfo.suffix();
     return QStringLiteral("[%1]").arg(fallbackMessage.arg(fileInfo.fileName()));
 }
 
-QString ChatManager::extractTextFromXml(const QString& xmlContent)
-{
-    QXmlStreamReader xml(xmlContent);
-    QString text;
-    
-    while (!xml.atEnd()) {
-        xml.readNext();
-        if (xml.isCharacters()) {
-            text += xml.text().toString();
-        }
-    }
-    
-    return text.simplified();
-}
-
-
 // FileReaderThread
 FileReaderThread::FileReaderThread(const QString& filePath, const QString& fileName, QObject* parent)
-    : QThread(parent), m_filePath(filePath), m_fileName(fileName)
+    : QThread(parent), m_filePath(filePath), m_fileName(fileName), m_extracted(false)
 {
 }
 
@@ -675,7 +618,16 @@ void FileReaderThread::run()
         emitProgress(10);
         
         QString extension = fileInfo.suffix().toLower();
-        
+        const bool cacheable = (extension == "docx" || extension == "doc");
+        ExtractedTextCache* cache = GET_SINGLETON(ExtractedTextCache);
+
+        // 同一份文档之前提取过时直接使用缓存的文本
+        if (cacheable && cache->lookup(m_filePath, content)) {
+            emitProgress(100);
+            emit readCompleted(m_filePath, content, true, QString());
+            return;
+        }
+
         // 根据文件类型读取
         if (extension == "txt") {
             content = readTextFile(m_filePath);
@@ -703,6 +655,11 @@ void FileReaderThread::run()
             return;
         }
 
+        // 只缓存真正提取出的文本，读取失败时的占位提示不缓存
+        if (cacheable && m_extracted) {
+            cache->store(m_filePath, content);
+        }
+        
         emitProgress(100);
         
         if (!success && errorMessage.isEmpty()) {
@@ -741,7 +698,27 @@ QString FileReaderThread::readTextFile(const QString& filePath)
 
 QString FileReaderThread::readDocxFile(const QString& filePath)
 {
-    return readWordFileWithProgress(filePath, QStringLiteral("DOCX文档: %1 - 内容读取需要Microsoft Word"));
+    emitProgress(30);
+    if (isInterruptionRequested()) return QString();
+
+    QElapsedTimer timer;
+    timer.start();
+
+    DocxReader reader;
+    reader.setCancelCheck([this]() { return isInterruptionRequested(); });
+    bool ok = reader.read(filePath);
+    if (isInterruptionRequested()) return QString();
+
+    emitProgress(90);
+
+    if (!ok || reader.text().isEmpty()) {
+        LOG_DEBUG(lcFile) << "[FileReaderThread] DOCX read failed:" << reader.errorString();
+        return QStringLiteral("[DOCX文档: %1 - 内容读取失败]").arg(QFileInfo(filePath).fileName());
+    }
+
+    LOG_DEBUG(lcFile) << "[FileReaderThread] DOCX read in" << timer.elapsed() << "ms, chars:" << reader.text().size();
+    m_extracted = true;
+    return reader.text();
 }
 
 QString FileReaderThread::readDocFile(const QString& filePath)
@@ -789,6 +766,7 @@ QString FileReaderThread::readWordFileWithProgress(const QString& filePath, cons
     if (process.exitCode() == 0) {
         QString content = QString::fromUtf8(process.readAllStandardOutput()).trimmed();
         if (!content.isEmpty()) {
+            m_extracted = true;
             return content;
         }
     }
@@ -856,7 +834,7 @@ void ChatManager::startFileReadTask(const QString& filePath, const QString& file
     // 启动线程
     thread->start();
     
-    qDebug() << "[ChatManager] Started file read task for:" << fileName;
+    LOG_DEBUG(lcFile) << "[ChatManager] Started file read task for:" << fileName;
 }
 
 void ChatManager::cleanupFileReadTask(const QString& filePath)
@@ -910,7 +888,8 @@ void ChatManager::cleanupAllFileReadTasks()
     for (const QString& filePath : filePaths) {
             QFileInfo fileInfo(filePath);
             QString extension = fileInfo.suffix().toLower();
-            if (extension == "doc" || extension == "docx") {
+            // 只有 .doc 经由Word自动化读取，.docx 由 DocxReader 直接解析，不会留下WINWORD进程
+            if (extension == "doc") {
                 hasWordDocs = true;
                 break;
             }
@@ -926,7 +905,7 @@ void ChatManager::cleanupAllFileReadTasks()
     
     // 如果有Word文档任务被清理，启动延迟Word进程清理
     if (hasWordDocs) {
-        qDebug() << "[ChatManager] Word document tasks were cleaned up, starting delayed Word process cleanup";
+        LOG_DEBUG(lcFile) << "[ChatManager] Word document tasks were cleaned up, starting delayed Word process cleanup";
         startDelayedWordProcessCleanup();
     }
 }
@@ -976,9 +955,9 @@ void ChatManager::onFileReadCompleted(const QString& filePath, const QString& co
         // 存储文件内容（如果未被取消）
         if (success && !content.isEmpty()) {
             m_fileContents[filePath] = content;
-            qDebug() << "[ChatManager] File content stored for:" << filePath;
+            LOG_DEBUG(lcFile) << "[ChatManager] File content stored for:" << filePath;
         } else {
-            qDebug() << "[ChatManager] File read finished with status:" << (success ? "success" : "failed") << filePath << errorMessage;
+            LOG_DEBUG(lcFile) << "[ChatManager] File read finished with status:" << (success ? "success" : "failed") << filePath << errorMessage;
         }
         
         // 清理任务
@@ -1031,12 +1010,12 @@ void ChatManager::startDelayedWordProcessCleanup()
         
         // 执行多次清理确保所有进程都被清除
         for (int attempt = 1; attempt <= 3; ++attempt) {
-            qDebug() << "[ChatManager] Word cleanup attempt" << attempt << "of 3";
+            LOG_DEBUG(lcFile) << "[ChatManager] Word cleanup attempt" << attempt << "of 3";
             
             int processCount = cleanupHangingWordProcesses();
             
             if (processCount == 0) {
-                qDebug() << "[ChatManager] No more Word processes to clean, stopping";
+                LOG_DEBUG(lcFile) << "[ChatManager] No more Word processes to clean, stopping";
                 break;
             }
             
@@ -1046,7 +1025,7 @@ void ChatManager::startDelayedWordProcessCleanup()
             }
         }
         
-        qDebug() << "[ChatManager] Delayed Word process cleanup completed";
+        LOG_DEBUG(lcFile) << "[ChatManager] Delayed Word process cleanup completed";
     });
 }
 
@@ -1090,7 +1069,7 @@ int ChatManager::cleanupHangingWordProcesses()
         QString errorOutput = QString::fromUtf8(process.readAllStandardError());
         
         if (!output.trimmed().isEmpty()) {
-            qDebug() << "[ChatManager] Word cleanup output:" << output;
+            LOG_DEBUG(lcFile) << "[ChatManager] Word cleanup output:" << output;
             
             // 提取清理的进程数量
             QRegularExpression re("PROCESS_COUNT:(\\d+)");
@@ -1101,16 +1080,16 @@ int ChatManager::cleanupHangingWordProcesses()
         }
         
         if (!errorOutput.trimmed().isEmpty()) {
-            qDebug() << "[ChatManager] Word cleanup errors:" << errorOutput;
+            LOG_DEBUG(lcFile) << "[ChatManager] Word cleanup errors:" << errorOutput;
         }
         
         if (process.exitCode() == 0) {
-            qDebug() << "[ChatManager] Word process cleanup completed successfully, cleaned" << cleanedProcessCount << "processes";
+            LOG_DEBUG(lcFile) << "[ChatManager] Word process cleanup completed successfully, cleaned" << cleanedProcessCount << "processes";
         } else {
-            qDebug() << "[ChatManager] Word process cleanup completed with exit code:" << process.exitCode();
+            LOG_DEBUG(lcFile) << "[ChatManager] Word process cleanup completed with exit code:" << process.exitCode();
         }
     } else {
-        qDebug() << "[ChatManager] Word process cleanup timed out";
+        LOG_DEBUG(lcFile) << "[ChatManager] Word process cleanup timed out";
         process.kill(); // 强制终止PowerShell进程
     }
     
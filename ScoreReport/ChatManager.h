@@ -7,6 +7,7 @@
 #include <QThread>
 #include <QMutex>
 #include "CommonFunc.h"
+#include "ChatMessageModel.h"
 
 /**
  * @brief 文件读取线程类 - 在后台线程中读取文件内容
@@ -28,6 +29,7 @@ signals:
 private:
     QString m_filePath;
     QString m_fileName;
+    bool m_extracted;   ///< 文本是否确实从文档中提取成功（可写入缓存）
     
     QString readTextFile(const QString& filePath);
     QString readDocxFile(const QString& filePath);
@@ -46,8 +48,8 @@ class ChatManager : public QObject
 {
     Q_OBJECT
 
-    /// @brief 消息列表，供QML绑定
-    QUICK_PROPERTY(QVariantList, messages)
+    /// @brief 消息列表模型，供QML绑定
+    Q_PROPERTY(ChatMessageModel* messages READ messages CONSTANT)
 
     /// @brief 是否正在发送消息
     QUICK_PROPERTY(bool, isSending)
@@ -79,6 +81,9 @@ class ChatManager : public QObject
 public:
     explicit ChatManager(QObject* parent = nullptr);
 
+    /// @brief 消息列表模型
+    ChatMessageModel* messages() const { return m_messageModel; }
+
     // QML调用的方法
     Q_INVOKABLE void sendMessage(const QString& message);
     Q_INVOKABLE void resetWithWelcomeMessage();
@@ -175,14 +180,14 @@ private:
     QString readDocxContent(const QString& filePath);
     QString readDocContent(const QString& filePath);
     QString readWordDocumentWithPowerShell(const QString& filePath, const QString& fallbackMessage);
-    QString extractTextFromXml(const QString& xmlContent);
     
     // Word进程管理私有方法
     int cleanupHangingWordProcesses();
     void startDelayedWordProcessCleanup();
-
+    
     // 私有成员变量
-    QString m_currentAiMessage;                                 ///< 当前正在接收的AI消息内容
+    ChatMessageModel* m_messageModel;                           ///< 消息列表模型
+    int m_currentAiLength;                                      ///< 当前AI回答已接收的字符数，0表示尚未收到内容（正文只保存在消息模型中）
     QStringList m_supportedFormats;                             ///< 支持的文件格式列表
     QMap<QString, QString> m_fileContents;                      ///< 文件内容存储映射
     QMap<QString, FileReaderThread*> m_activeReadTasks;         ///< 当前进行的文件读取线程映射
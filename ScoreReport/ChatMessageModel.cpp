@@ -0,0 +1,211 @@
+﻿#include "ChatMessageModel.h"
+#include "UiFlushScheduler.h"
+#include <QDateTime>
+#ifdef QT_DEBUG
+#include <QElapsedTimer>
+#include <QDebug>
+#endif
+
+ChatMessageModel::ChatMessageModel(QObject* parent)
+    : QAbstractListModel(parent)
+{
+}
+
+int ChatMessageModel::rowCount(const QModelIndex& parent) const
+{
+    return parent.isValid() ? 0 : m_messages.size();
+}
+
+QVariant ChatMessageModel::data(const QModelIndex& index, int role) const
+{
+    if (!index.isValid() || index.row() < 0 || index.row() >= m_messages.size()) {
+        return QVariant();
+    }
+
+    const Message& message = m_messages.at(index.row());
+    switch (role) {
+    case TypeRole:
+        return message.type;
+    case Qt::DisplayRole:
+    case ContentRole:
+        return message.content.toString();
+    case TimestampRole:
+        return message.timestamp;
+    default:
+        return QVariant();
+    }
+}
+
+QHash<int, QByteArray> ChatMessageModel::roleNames() const
+{
+    QHash<int, QByteArray> roles;
+    roles[TypeRole] = "type";
+    roles[ContentRole] = "content";
+    roles[TimestampRole] = "timestamp";
+    return roles;
+}
+
+QVariantMap ChatMessageModel::get(int row) const
+{
+    QVariantMap map;
+    if (row >= 0 && row < m_messages.size()) {
+        const Message& message = m_messages.at(row);
+        map["type"] = message.type;
+        map["content"] = message.content.toString();
+        map["timestamp"] = message.timestamp;
+    }
+    return map;
+}
+
+void ChatMessageModel::append(const QString& type, const QString& content)
+{
+    Message message;
+    message.type = type;
+    message.content.append(content);
+    message.timestamp = QDateTime::currentDateTime().toString("hh:mm");
+
+    const int row = m_messages.size();
+    beginInsertRows(QModelIndex(), row, row);
+    m_messages.append(message);
+    endInsertRows();
+    emit countChanged();
+}
+
+QString ChatMessageModel::lastType() const
+{
+    return m_messages.isEmpty() ? QString() : m_messages.last().type;
+}
+
+QString ChatMessageModel::lastContent() const
+{
+    return m_messages.isEmpty() ? QString() : m_messages.last().content.toString();
+}
+
+bool ChatMessageModel::appendToLast(const QString& type, const QString& text)
+{
+    if (m_messages.isEmpty() || m_messages.last().type != type) {
+        return false;
+    }
+    if (text.isEmpty()) {
+        return true;
+    }
+
+    m_messages.last().content.append(text);
+
+    // 只通知最后一行的content角色发生变化
+    const QModelIndex changed = index(m_messages.size() - 1);
+    emit dataChanged(changed, changed, QVector<int>() << ContentRole);
+    return true;
+}
+
+void ChatMessageModel::appendToLastDeferred(const QString& type, const QString& text)
+{
+    // 类型改变时先追加之前累积的文本，保证顺序
+    if (!m_pendingText.isEmpty() && type != m_pendingType) {
+        applyPending();
+    }
+    m_pendingType = type;
+    m_pendingText.append(text);
+    GET_SINGLETON(UiFlushScheduler)->requestFlush(this, [this]() {
+        applyPending();
+    });
+}
+
+void ChatMessageModel::flushPending()
+{
+    GET_SINGLETON(UiFlushScheduler)->flushNow(this);
+}
+
+void ChatMessageModel::discardPending()
+{
+    GET_SINGLETON(UiFlushScheduler)->cancel(this);
+    m_pendingText.clear();
+}
+
+void ChatMessageModel::applyPending()
+{
+    if (!m_pendingText.isEmpty()) {
+        appendToLast(m_pendingType, m_pendingText.take());
+    }
+}
+
+bool ChatMessageModel::removeLast(const QString& type)
+{
+    if (m_messages.isEmpty() || m_messages.last().type != type) {
+        return false;
+    }
+    removeRowAt(m_messages.size() - 1);
+    return true;
+}
+
+bool ChatMessageModel::removeLastOfType(const QString& type)
+{
+    for (int i = m_messages.size() - 1; i >= 0; --i) {
+        if (m_messages.at(i).type == type) {
+            removeRowAt(i);
+            return true;
+        }
+    }
+    return false;
+}
+
+void ChatMessageModel::clear()
+{
+    discardPending();
+    if (m_messages.isEmpty()) {
+        return;
+    }
+    beginResetModel();
+    m_messages.clear();
+    endResetModel();
+    emit countChanged();
+}
+
+void ChatMessageModel::removeRowAt(int row)
+{
+    beginRemoveRows(QModelIndex(), row, row);
+    m_messages.removeAt(row);
+    endRemoveRows();
+    emit countChanged();
+}
+
+#ifdef QT_DEBUG
+double ChatMessageModel::runBenchmark(int messageCount, int tokenCount)
+{
+    ChatMessageModel model;
+    const QString history = QString("历史消息内容").repeated(80);
+    for (int i = 0; i < messageCount - 1; ++i) {
+        model.append(i % 2 == 0 ? "user" : "ai", history);
+    }
+    model.append("ai", QString());
+
+    // 模拟QML委托：每次dataChanged读取一次完整的content
+    qint64 handlerNs = 0;
+    qint64 contentChars = 0;
+    QObject::connect(&model, &ChatMessageModel::dataChanged, &model,
+                     [&model, &handlerNs, &contentChars](const QModelIndex& topLeft) {
+        QElapsedTimer handlerTimer;
+        handlerTimer.start();
+        contentChars += model.data(topLeft, ContentRole).toString().size();
+        handlerNs += handlerTimer.nsecsElapsed();
+    });
+
+    const QString token = QStringLiteral("词元");
+    QElapsedTimer timer;
+    timer.start();
+    for (int i = 0; i < tokenCount; ++i) {
+        model.appendToLast("ai", token);
+    }
+    const qint64 totalNs = qMax<qint64>(1, timer.nsecsElapsed());
+
+    const double usPerToken = totalNs / 1000.0 / tokenCount;
+    qInfo().noquote() << QStringLiteral("[ChatMessageModel] Benchmark: %1 messages, %2 tokens in %3 ms, "
+                                        "appendToLast %4 us/token, dataChanged %5 us/token, %6 chars read")
+                             .arg(messageCount).arg(tokenCount)
+                             .arg(totalNs / 1000000.0, 0, 'f', 1)
+                             .arg((totalNs - handlerNs) / 1000.0 / tokenCount, 0, 'f', 2)
+                             .arg(handlerNs / 1000.0 / tokenCount, 0, 'f', 2)
+                             .arg(contentChars);
+    return usPerToken;
+}
+#endif
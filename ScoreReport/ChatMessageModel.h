@@ -0,0 +1,118 @@
+﻿#ifndef CHATMESSAGEMODEL_H
+#define CHATMESSAGEMODEL_H
+
+#include <QAbstractListModel>
+#include <QString>
+#include <QVector>
+#include <QVariantMap>
+#include "ChunkedTextBuffer.h"
+
+/**
+ * @brief 聊天消息列表模型 - 供QML的Repeater/ListView直接绑定
+ *
+ * 取代原先 QVariantList 类型的 messages 属性：
+ * - 流式回答追加文本时原地修改最后一条消息，只对这一行的 content 角色发出 dataChanged，
+ *   QML只刷新这一个委托，不再整体重建消息列表
+ * - 消息内容保存在 ChunkedTextBuffer 中，追加时不拷贝已有内容，
+ *   只在QML读取 content 角色时拼接一次
+ * - 增删消息使用 beginInsertRows / beginRemoveRows，其余行的委托保持不变
+ * - 流式回答通过 appendToLastDeferred() 先累积在模型中，由 UiFlushScheduler 按渲染帧合并刷新
+ *
+ * QML中通过 model.type / model.content / model.timestamp 访问角色，
+ * 通过 count 属性获取消息数量。
+ */
+class ChatMessageModel : public QAbstractListModel
+{
+    Q_OBJECT
+
+    /// @brief 消息数量
+    Q_PROPERTY(int count READ count NOTIFY countChanged)
+
+public:
+    enum Roles {
+        TypeRole = Qt::UserRole + 1,    ///< 消息类型：user / ai / thinking / interrupt
+        ContentRole,                    ///< 消息内容
+        TimestampRole                   ///< 消息时间（hh:mm）
+    };
+
+    explicit ChatMessageModel(QObject* parent = nullptr);
+
+    int rowCount(const QModelIndex& parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex& index, int role = Qt::DisplayRole) const override;
+    QHash<int, QByteArray> roleNames() const override;
+
+    int count() const { return m_messages.size(); }
+
+    /// @brief 获取指定行的消息（type / content / timestamp）
+    Q_INVOKABLE QVariantMap get(int row) const;
+
+    /// @brief 在末尾追加一条消息，时间取当前时间
+    void append(const QString& type, const QString& content);
+
+    /// @brief 最后一条消息的类型，列表为空时返回空字符串
+    QString lastType() const;
+
+    /// @brief 最后一条消息的内容
+    QString lastContent() const;
+
+    /**
+     * @brief 向最后一条消息追加文本
+     * @param type 最后一条消息必须是该类型才追加
+     * @param text 追加的文本
+     * @return 是否追加成功
+     */
+    bool appendToLast(const QString& type, const QString& text);
+
+    /**
+     * @brief 向最后一条消息追加文本，累积到下一个渲染帧再统一追加（流式回答使用）
+     * @param type 最后一条消息必须是该类型才追加
+     * @param text 追加的文本
+     */
+    void appendToLastDeferred(const QString& type, const QString& text);
+
+    /// @brief 立即追加所有累积的文本（流结束或被中断时调用）
+    void flushPending();
+
+    /// @brief 丢弃累积的文本和已登记的刷新
+    void discardPending();
+
+    /// @brief 最后一条消息是指定类型时将其移除
+    bool removeLast(const QString& type);
+
+    /// @brief 从后往前移除第一条指定类型的消息
+    bool removeLastOfType(const QString& type);
+
+    /// @brief 清空所有消息
+    void clear();
+
+#ifdef QT_DEBUG
+    /**
+     * @brief 流式追加基准测试，仅调试版本提供
+     * @param messageCount 会话中的消息条数（含正在流式输出的最后一条）
+     * @param tokenCount 向最后一条消息追加的token数
+     * @return 每个token的平均耗时（微秒），包括 appendToLast 和 dataChanged 处理
+     *
+     * dataChanged 的处理函数按QML委托的方式读取一次 content 角色，分别统计两部分耗时。
+     */
+    static double runBenchmark(int messageCount, int tokenCount);
+#endif
+
+signals:
+    void countChanged();
+
+private:
+    struct Message {
+        QString type;
+        ChunkedTextBuffer content;
+        QString timestamp;
+    };
+
+    void removeRowAt(int row);
+    void applyPending();
+
+    QVector<Message> m_messages;
+    QString m_pendingType;              ///< 累积文本要追加到的消息类型
+    ChunkedTextBuffer m_pendingText;    ///< 等待下一个渲染帧追加的文本
+};
+
+#endif // CHATMESSAGEMODEL_H
@@ -0,0 +1,52 @@
+﻿#include "ChunkedTextBuffer.h"
+
+ChunkedTextBuffer::ChunkedTextBuffer()
+    : m_size(0)
+{
+}
+
+void ChunkedTextBuffer::append(const QString& text)
+{
+    if (text.isEmpty()) {
+        return;
+    }
+
+    if (!m_chunks.isEmpty() && m_chunks.last().size() < kChunkSize) {
+        m_chunks.last().append(text);
+    } else {
+        // 与调用方共享同一份数据，不拷贝
+        m_chunks.append(text);
+    }
+    m_size += text.size();
+}
+
+QString ChunkedTextBuffer::toString() const
+{
+    if (m_chunks.isEmpty()) {
+        return QString();
+    }
+
+    if (m_chunks.size() > 1) {
+        QString flat;
+        flat.reserve(m_size);
+        for (const QString& chunk : m_chunks) {
+            flat.append(chunk);
+        }
+        m_chunks.clear();
+        m_chunks.append(flat);
+    }
+    return m_chunks.first();
+}
+
+QString ChunkedTextBuffer::take()
+{
+    QString text = toString();
+    clear();
+    return text;
+}
+
+void ChunkedTextBuffer::clear()
+{
+    m_chunks.clear();
+    m_size = 0;
+}
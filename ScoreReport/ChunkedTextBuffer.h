@@ -0,0 +1,45 @@
+﻿#ifndef CHUNKEDTEXTBUFFER_H
+#define CHUNKEDTEXTBUFFER_H
+
+#include <QString>
+#include <QVector>
+
+/**
+ * @brief 分段文本缓冲区 - 用于流式接收中的AI回答
+ *
+ * 流式回答每次只追加几个字符，直接对 QString 做 += 会反复扩容并拷贝整段回答。
+ * 本类只在末尾追加分段，不移动已有内容：
+ * - 追加的文本先并入最后一个未满 kChunkSize 的分段，满了之后另起新分段，
+ *   每个字符在追加阶段最多被拷贝常数次
+ * - 只有调用 toString() 时才拼接成完整字符串，拼接结果缓存为单个分段，
+ *   不再追加时重复读取不会产生新的拷贝
+ */
+class ChunkedTextBuffer
+{
+public:
+    ChunkedTextBuffer();
+
+    /// @brief 在末尾追加文本
+    void append(const QString& text);
+
+    /// @brief 拼接并返回完整文本
+    QString toString() const;
+
+    /// @brief 拼接并返回完整文本，同时清空缓冲区
+    QString take();
+
+    /// @brief 清空缓冲区
+    void clear();
+
+    bool isEmpty() const { return m_size == 0; }
+    int size() const { return m_size; }
+    int chunkCount() const { return m_chunks.size(); }
+
+private:
+    static const int kChunkSize = 4096;    ///< 小于此长度的末尾分段继续接收追加文本
+
+    mutable QVector<QString> m_chunks;      ///< 文本分段，toString() 后合并为一段
+    int m_size;                             ///< 总字符数
+};
+
+#endif // CHUNKEDTEXTBUFFER_H
@@ -0,0 +1,325 @@
+﻿#include "DocxReader.h"
+#include <QtEndian>
+#include <QDebug>
+#include <cstring>
+#include <QtZlib/zlib.h>   // Qt自带的zlib，由QtCore导出
+
+namespace {
+const quint32 kEndOfCentralDirSignature = 0x06054b50;
+const quint32 kCentralDirSignature = 0x02014b50;
+const quint32 kLocalHeaderSignature = 0x04034b50;
+const int kEndOfCentralDirSize = 22;
+const int kCentralDirHeaderSize = 46;
+const int kLocalHeaderSize = 30;
+const int kMaxZipCommentSize = 0xFFFF;
+
+const quint16 kMethodStored = 0;
+const quint16 kMethodDeflated = 8;
+
+/// @brief 每次从文件读取/解压的块大小
+const int kChunkSize = 64 * 1024;
+
+/// @brief document.xml 解压后的大小上限，防止异常压缩包耗尽内存
+const qint64 kMaxXmlSize = 512 * 1024 * 1024;
+
+const QLatin1String kWordNamespace("http://schemas.openxmlformats.org/wordprocessingml/2006/main");
+const QLatin1String kStrictWordNamespace("http://purl.oclc.org/ooxml/wordprocessingml/main");
+
+inline quint16 readU16(const char* p) { return qFromLittleEndian<quint16>(reinterpret_cast<const uchar*>(p)); }
+inline quint32 readU32(const char* p) { return qFromLittleEndian<quint32>(reinterpret_cast<const uchar*>(p)); }
+}
+
+DocxReader::DocxReader()
+    : m_xmlBytes(0)
+    , m_tableDepth(0)
+    , m_cellParagraphs(0)
+    , m_inRun(false)
+    , m_inText(false)
+{
+}
+
+bool DocxReader::fail(const QString& message)
+{
+    m_errorString = message;
+    m_text.clear();
+    return false;
+}
+
+bool DocxReader::read(const QString& filePath)
+{
+    m_xml.clear();
+    m_text.clear();
+    m_errorString.clear();
+    m_xmlBytes = 0;
+    m_tableDepth = 0;
+    m_cellParagraphs = 0;
+    m_inRun = false;
+    m_inText = false;
+
+    QFile file(filePath);
+    if (!file.open(QIODevice::ReadOnly)) {
+        return fail(QStringLiteral("无法打开文件: %1").arg(file.errorString()));
+    }
+
+    ZipEntry entry;
+    if (!findEntry(file, QByteArrayLiteral("word/document.xml"), entry)) {
+        return false;
+    }
+    if (!streamEntry(file, entry)) {
+        return false;
+    }
+
+    if (m_xml.hasError()) {
+        return fail(QStringLiteral("document.xml 解析失败: %1").arg(m_xml.errorString()));
+    }
+
+    // 去掉末尾段落/表格产生的空白
+    int end = m_text.size();
+    while (end > 0 && m_text.at(end - 1).isSpace()) {
+        --end;
+    }
+    m_text.truncate(end);
+    return true;
+}
+
+bool DocxReader::findEntry(QFile& file, const QByteArray& entryName, ZipEntry& entry)
+{
+    const qint64 fileSize = file.size();
+    if (fileSize < kEndOfCentralDirSize) {
+        return fail(QStringLiteral("不是有效的DOCX文件"));
+    }
+
+    // 中央目录结束记录位于文件尾部，其后最多跟一段注释
+    const qint64 tailSize = qMin<qint64>(fileSize, kEndOfCentralDirSize + kMaxZipCommentSize);
+    file.seek(fileSize - tailSize);
+    const QByteArray tail = file.read(tailSize);
+    int eocd = -1;
+    for (int i = tail.size() - kEndOfCentralDirSize; i >= 0; --i) {
+        if (readU32(tail.constData() + i) == kEndOfCentralDirSignature) {
+            eocd = i;
+            break;
+        }
+    }
+    if (eocd < 0) {
+        return fail(QStringLiteral("不是有效的DOCX文件（缺少ZIP目录）"));
+    }
+
+    const char* record = tail.constData() + eocd;
+    const quint32 dirSize = readU32(record + 12);
+    const quint32 dirOffset = readU32(record + 16);
+    if (dirOffset == 0xFFFFFFFFu || qint64(dirOffset) + dirSize > fileSize) {
+        return fail(QStringLiteral("不支持的ZIP格式"));
+    }
+
+    file.seek(dirOffset);
+    const QByteArray directory = file.read(dirSize);
+    if (directory.size() != int(dirSize)) {
+        return fail(QStringLiteral("ZIP目录读取失败"));
+    }
+
+    int pos = 0;
+    while (pos + kCentralDirHeaderSize <= directory.size()) {
+        const char* header = directory.constData() + pos;
+        if (readU32(header) != kCentralDirSignature) {
+            break;
+        }
+        const quint16 flags = readU16(header + 8);
+        const quint16 nameLength = readU16(header + 28);
+        const quint16 extraLength = readU16(header + 30);
+        const quint16 commentLength = readU16(header + 32);
+        if (pos + kCentralDirHeaderSize + nameLength > directory.size()) {
+            break;
+        }
+
+        if (nameLength == entryName.size()
+            && std::memcmp(header + kCentralDirHeaderSize, entryName.constData(), nameLength) == 0) {
+            if (flags & 0x0001) {
+                return fail(QStringLiteral("不支持加密的文档"));
+            }
+            entry.method = readU16(header + 10);
+            entry.compressedSize = readU32(header + 20);
+            entry.uncompressedSize = readU32(header + 24);
+            entry.localHeaderOffset = readU32(header + 42);
+            if (entry.method != kMethodStored && entry.method != kMethodDeflated) {
+                return fail(QStringLiteral("不支持的压缩方式: %1").arg(entry.method));
+            }
+            return true;
+        }
+
+        pos += kCentralDirHeaderSize + nameLength + extraLength + commentLength;
+    }
+
+    return fail(QStringLiteral("文档中没有 %1").arg(QString::fromLatin1(entryName)));
+}
+
+bool DocxReader::streamEntry(QFile& file, const ZipEntry& entry)
+{
+    // 本地文件头中的文件名和扩展字段长度可能与中央目录不同，以本地文件头为准
+    if (!file.seek(entry.localHeaderOffset)) {
+        return fail(QStringLiteral("ZIP条目定位失败"));
+    }
+    const QByteArray localHeader = file.read(kLocalHeaderSize);
+    if (localHeader.size() != kLocalHeaderSize || readU32(localHeader.constData()) != kLocalHeaderSignature) {
+        return fail(QStringLiteral("ZIP条目头损坏"));
+    }
+    const qint64 dataOffset = qint64(entry.localHeaderOffset) + kLocalHeaderSize
+                            + readU16(localHeader.constData() + 26) + readU16(localHeader.constData() + 28);
+    if (!file.seek(dataOffset)) {
+        return fail(QStringLiteral("ZIP条目定位失败"));
+    }
+
+    qint64 remaining = entry.compressedSize;
+
+    if (entry.method == kMethodStored) {
+        while (remaining > 0) {
+            const QByteArray chunk = file.read(qMin<qint64>(kChunkSize, remaining));
+            if (chunk.isEmpty()) {
+                return fail(QStringLiteral("ZIP数据不完整"));
+            }
+            remaining -= chunk.size();
+            if (!feedXml(chunk.constData(), chunk.size())) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    z_stream stream;
+    std::memset(&stream, 0, sizeof(stream));
+    if (inflateInit2(&stream, -MAX_WBITS) != Z_OK) {
+        return fail(QStringLiteral("解压初始化失败"));
+    }
+
+    // 只在输入块被 inflate 完全消费后才读取下一块，输入缓冲可以复用
+    QByteArray input;
+    QByteArray output(kChunkSize, Qt::Uninitialized);
+    int result = Z_OK;
+    bool outputFull = false;
+    while (result != Z_STREAM_END) {
+        // 上一次输出缓冲被填满时 inflate 内部可能还有数据，先不读新的输入
+        if (stream.avail_in == 0 && !outputFull) {
+            if (remaining <= 0) {
+                break;
+            }
+            input = file.read(qMin<qint64>(kChunkSize, remaining));
+            if (input.isEmpty()) {
+                break;
+            }
+            remaining -= input.size();
+            stream.next_in = reinterpret_cast<Bytef*>(input.data());
+            stream.avail_in = static_cast<uInt>(input.size());
+        }
+
+        stream.next_out = reinterpret_cast<Bytef*>(output.data());
+        stream.avail_out = static_cast<uInt>(output.size());
+        result = inflate(&stream, Z_NO_FLUSH);
+        if (result == Z_BUF_ERROR && stream.avail_in == 0) {
+            // 内部没有剩余输出，需要更多输入
+            outputFull = false;
+            continue;
+        }
+        if (result != Z_OK && result != Z_STREAM_END) {
+            inflateEnd(&stream);
+            return fail(QStringLiteral("解压失败: %1").arg(QString::fromLatin1(stream.msg ? stream.msg : "")));
+        }
+
+        outputFull = (stream.avail_out == 0);
+        const int produced = output.size() - static_cast<int>(stream.avail_out);
+        if (produced > 0 && !feedXml(output.constData(), produced)) {
+            inflateEnd(&stream);
+            return false;
+        }
+    }
+    inflateEnd(&stream);
+
+    if (result != Z_STREAM_END) {
+        return fail(QStringLiteral("ZIP数据不完整"));
+    }
+    return true;
+}
+
+bool DocxReader::feedXml(const char* data, int size)
+{
+    if (m_cancelCheck && m_cancelCheck()) {
+        return fail(QStringLiteral("读取已取消"));
+    }
+
+    m_xmlBytes += size;
+    if (m_xmlBytes > kMaxXmlSize) {
+        return fail(QStringLiteral("文档内容过大"));
+    }
+
+    m_xml.addData(QByteArray(data, size));
+    parseAvailable();
+
+    if (m_xml.hasError() && m_xml.error() != QXmlStreamReader::PrematureEndOfDocumentError) {
+        return fail(QStringLiteral("document.xml 解析失败: %1").arg(m_xml.errorString()));
+    }
+    return true;
+}
+
+bool DocxReader::isWordElement() const
+{
+    const QStringRef ns = m_xml.namespaceUri();
+    return ns == kWordNamespace || ns == kStrictWordNamespace;
+}
+
+void DocxReader::parseAvailable()
+{
+    // 数据用完时 readNext 返回 Invalid 并报告 PrematureEndOfDocumentError，追加数据后从断点继续
+    while (!m_xml.atEnd()) {
+        const QXmlStreamReader::TokenType token = m_xml.readNext();
+
+        if (token == QXmlStreamReader::Characters) {
+            if (m_inText) {
+                m_text += m_xml.text();
+            }
+        } else if (token == QXmlStreamReader::StartElement) {
+            if (!isWordElement()) {
+                continue;
+            }
+            const QStringRef name = m_xml.name();
+            if (name == QLatin1String("t")) {
+                m_inText = true;
+            } else if (name == QLatin1String("r")) {
+                m_inRun = true;
+            } else if (m_inRun && name == QLatin1String("tab")) {
+                m_text += QLatin1Char('\t');
+            } else if (m_inRun && (name == QLatin1String("br") || name == QLatin1String("cr"))) {
+                m_text += QLatin1Char('\n');
+            } else if (name == QLatin1String("p")) {
+                // 同一单元格中的多个段落以空格分隔
+                if (m_tableDepth > 0 && m_cellParagraphs++ > 0) {
+                    m_text += QLatin1Char(' ');
+                }
+            } else if (name == QLatin1String("tbl")) {
+                ++m_tableDepth;
+            } else if (name == QLatin1String("tc")) {
+                m_cellParagraphs = 0;
+            }
+        } else if (token == QXmlStreamReader::EndElement) {
+            if (!isWordElement()) {
+                continue;
+            }
+            const QStringRef name = m_xml.name();
+            if (name == QLatin1String("t")) {
+                m_inText = false;
+            } else if (name == QLatin1String("r")) {
+                m_inRun = false;
+            } else if (name == QLatin1String("p")) {
+                if (m_tableDepth == 0) {
+                    m_text += QLatin1Char('\n');
+                }
+            } else if (name == QLatin1String("tc")) {
+                m_text += QLatin1Char('\t');
+            } else if (name == QLatin1String("tr")) {
+                if (m_text.endsWith(QLatin1Char('\t'))) {
+                    m_text.chop(1);
+                }
+                m_text += QLatin1Char('\n');
+            } else if (name == QLatin1String("tbl")) {
+                --m_tableDepth;
+            }
+        }
+    }
+}
@@ -0,0 +1,73 @@
+﻿#ifndef DOCXREADER_H
+#define DOCXREADER_H
+
+#include <QString>
+#include <QByteArray>
+#include <QFile>
+#include <QXmlStreamReader>
+#include <functional>
+
+/**
+ * @brief DOCX正文读取类 - 不依赖Microsoft Word直接提取文本
+ *
+ * DOCX是ZIP压缩包，正文位于 word/document.xml：
+ * - 从ZIP尾部的中央目录定位 word/document.xml，只读取这一个条目
+ * - 压缩数据按块解压（raw deflate），解压结果直接送入 QXmlStreamReader 增量解析，
+ *   内存占用只与输出文本大小有关，与压缩包大小无关
+ * - 段落之间以换行分隔，表格单元格以制表符分隔、行以换行分隔，
+ *   w:tab / w:br 分别输出制表符和换行
+ *
+ * 不支持加密文档、ZIP64以及旧版二进制 .doc 格式。
+ */
+class DocxReader
+{
+public:
+    /// @brief 提取结果的格式版本，输出文本的规则（段落、表格、制表符等）变化时加1，使已缓存的提取结果失效
+    static const int kOutputVersion = 1;
+
+    DocxReader();
+
+    /**
+     * @brief 读取DOCX正文
+     * @param filePath DOCX文件路径
+     * @return 是否读取成功，失败原因可通过 errorString() 获取
+     */
+    bool read(const QString& filePath);
+
+    /**
+     * @brief 设置取消检查函数，读取过程中每处理一个数据块调用一次，返回true时中止读取
+     */
+    void setCancelCheck(const std::function<bool()>& cancelCheck) { m_cancelCheck = cancelCheck; }
+
+    /// @brief 读取到的正文文本
+    QString text() const { return m_text; }
+    QString errorString() const { return m_errorString; }
+
+private:
+    /// @brief 中央目录中的条目信息
+    struct ZipEntry {
+        quint16 method;
+        quint32 compressedSize;
+        quint32 uncompressedSize;
+        quint32 localHeaderOffset;
+    };
+
+    bool fail(const QString& message);
+    bool findEntry(QFile& file, const QByteArray& entryName, ZipEntry& entry);
+    bool streamEntry(QFile& file, const ZipEntry& entry);
+    bool feedXml(const char* data, int size);
+    void parseAvailable();
+    bool isWordElement() const;
+
+    QXmlStreamReader m_xml;
+    QString m_text;
+    QString m_errorString;
+    std::function<bool()> m_cancelCheck;
+    qint64 m_xmlBytes;              ///< 已解压的XML字节数
+    int m_tableDepth;               ///< 当前表格嵌套层数
+    int m_cellParagraphs;           ///< 当前单元格中已输出的段落数
+    bool m_inRun;                   ///< 是否位于 w:r 内
+    bool m_inText;                  ///< 是否位于 w:t 内
+};
+
+#endif // DOCXREADER_H
@@ -0,0 +1,292 @@
+﻿#include "DownloadSession.h"
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QSaveFile>
+#include <QDebug>
+
+namespace {
+/// @brief 回复对象上保存会话指针的动态属性名
+const char* const kSessionProperty = "_downloadSession";
+
+/// @brief 每写入这么多字节更新一次续传信息
+const qint64 kMetadataInterval = 1024 * 1024;
+
+/// @brief 对已有部分文件重新计算哈希时的读取块大小
+const qint64 kHashChunkSize = 256 * 1024;
+}
+
+DownloadSession::DownloadSession(const QString& filePath)
+    : QObject(nullptr)
+    , m_reply(nullptr)
+    , m_filePath(filePath)
+    , m_partPath(filePath + ".part")
+    , m_file(filePath + ".part")
+    , m_hash(QCryptographicHash::Sha256)
+    , m_resumeOffset(0)
+    , m_bytesWritten(0)
+    , m_totalSize(-1)
+    , m_savedOffset(0)
+    , m_started(false)
+    , m_rejected(false)
+    , m_finished(false)
+{
+}
+
+DownloadSession* DownloadSession::fromReply(QNetworkReply* reply)
+{
+    return reply ? reply->property(kSessionProperty).value<DownloadSession*>() : nullptr;
+}
+
+bool DownloadSession::open()
+{
+    if (!m_file.open(QIODevice::ReadWrite)) {
+        m_errorString = m_file.errorString();
+        qWarning() << "[DownloadSession] Failed to open" << m_partPath << m_errorString;
+        return false;
+    }
+
+    if (!loadMetadata()) {
+        return restart();
+    }
+
+    // 只信任续传信息中记录的偏移，之后可能未完整写入的数据截掉
+    qint64 offset = qMin(m_savedOffset, m_file.size());
+    if (!m_file.resize(offset)) {
+        return restart();
+    }
+
+    // 已有数据需要先计入哈希，只在续传开始时读一次
+    m_file.seek(0);
+    while (m_bytesWritten < offset) {
+        QByteArray chunk = m_file.read(qMin(kHashChunkSize, offset - m_bytesWritten));
+        if (chunk.isEmpty()) {
+            return restart();
+        }
+        m_hash.addData(chunk);
+        m_bytesWritten += chunk.size();
+    }
+
+    m_resumeOffset = offset;
+    qDebug() << "[DownloadSession] Resuming" << m_filePath << "from" << offset << "of" << m_totalSize;
+    return true;
+}
+
+void DownloadSession::prepareRequest(QNetworkRequest& request) const
+{
+    if (m_resumeOffset <= 0) {
+        return;
+    }
+
+    request.setRawHeader("Range", "bytes=" + QByteArray::number(m_resumeOffset) + "-");
+    if (!m_validator.isEmpty()) {
+        // 文件在服务器上已变化时，服务器会忽略Range并返回完整内容
+        request.setRawHeader("If-Range", m_validator);
+    }
+}
+
+void DownloadSession::attach(QNetworkReply* reply)
+{
+    m_reply = reply;
+    setParent(reply);
+    reply->setProperty(kSessionProperty, QVariant::fromValue(this));
+}
+
+bool DownloadSession::startResponse()
+{
+    m_started = true;
+
+    const int status = m_reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt();
+    const bool resuming = status == 206 && m_resumeOffset > 0;
+    if (status != 200 && !resuming) {
+        // 错误页等响应体不能写进部分文件，已有数据和续传信息原样保留，错误由 finished 报告
+        m_rejected = true;
+        m_errorString = QStringLiteral("下载失败，HTTP状态: %1").arg(status);
+        qWarning() << "[DownloadSession]" << m_errorString << m_filePath;
+        return false;
+    }
+
+    QByteArray validator = m_reply->rawHeader("ETag");
+    if (validator.isEmpty()) {
+        validator = m_reply->rawHeader("Last-Modified");
+    }
+
+    if (resuming) {
+        // Content-Range: bytes <start>-<end>/<total>
+        QByteArray range = m_reply->rawHeader("Content-Range");
+        int space = range.indexOf(' ');
+        int dash = range.indexOf('-', space);
+        int slash = range.indexOf('/', dash);
+        qint64 start = (space >= 0 && dash > space) ? range.mid(space + 1, dash - space - 1).toLongLong() : -1;
+        qint64 total = slash > 0 ? range.mid(slash + 1).toLongLong() : -1;
+
+        if (start != m_resumeOffset || (m_totalSize > 0 && total > 0 && total != m_totalSize)
+            || (!m_validator.isEmpty() && !validator.isEmpty() && validator != m_validator)) {
+            m_errorString = QStringLiteral("续传范围不匹配: %1").arg(QString::fromLatin1(range));
+            qWarning() << "[DownloadSession]" << m_errorString;
+            return false;
+        }
+        if (total > 0) {
+            m_totalSize = total;
+        }
+    } else {
+        // 服务器返回完整内容（不支持Range或文件已变化），丢弃已有数据从头写入
+        if (m_resumeOffset > 0) {
+            qDebug() << "[DownloadSession] Server sent full content, restarting" << m_filePath;
+            if (!restart()) {
+                return false;
+            }
+        }
+        bool lengthKnown = false;
+        qint64 length = m_reply->header(QNetworkRequest::ContentLengthHeader).toLongLong(&lengthKnown);
+        m_totalSize = lengthKnown ? length : -1;
+    }
+
+    m_validator = validator;
+    saveMetadata();
+    return true;
+}
+
+bool DownloadSession::restart()
+{
+    m_hash.reset();
+    m_resumeOffset = 0;
+    m_bytesWritten = 0;
+    m_savedOffset = 0;
+    m_validator.clear();
+    m_totalSize = -1;
+    QFile::remove(metadataPath());
+
+    if (!m_file.resize(0) || !m_file.seek(0)) {
+        m_errorString = m_file.errorString();
+        qWarning() << "[DownloadSession] Failed to truncate" << m_partPath << m_errorString;
+        return false;
+    }
+    return true;
+}
+
+bool DownloadSession::write(const QByteArray& data)
+{
+    if (m_finished || !m_file.isOpen() || m_rejected) {
+        return false;
+    }
+    if (!m_started && !startResponse()) {
+        return false;
+    }
+
+    if (m_file.write(data) != data.size()) {
+        m_errorString = m_file.errorString();
+        qWarning() << "[DownloadSession] Write failed:" << m_errorString;
+        return false;
+    }
+
+    m_hash.addData(data);
+    m_bytesWritten += data.size();
+
+    if (m_bytesWritten - m_savedOffset >= kMetadataInterval) {
+        saveMetadata();
+    }
+    return true;
+}
+
+bool DownloadSession::commit()
+{
+    if (m_finished) {
+        return false;
+    }
+    m_finished = true;
+
+    m_file.close();
+    if (m_file.error() != QFileDevice::NoError) {
+        m_errorString = m_file.errorString();
+        removePartial();
+        return false;
+    }
+
+    QFile::remove(metadataPath());
+    QFile::remove(m_filePath);
+    if (!QFile::rename(m_partPath, m_filePath)) {
+        m_errorString = QStringLiteral("无法重命名下载文件: %1").arg(m_filePath);
+        qWarning() << "[DownloadSession]" << m_errorString;
+        removePartial();
+        return false;
+    }
+
+    m_sha256 = QString::fromLatin1(m_hash.result().toHex());
+    return true;
+}
+
+bool DownloadSession::isResumable() const
+{
+    // 没有校验值时无法确认服务器上的文件是否变化，不做续传
+    return m_bytesWritten > 0 && !m_validator.isEmpty();
+}
+
+void DownloadSession::suspend()
+{
+    if (m_finished) {
+        return;
+    }
+    m_finished = true;
+
+    if (!isResumable()) {
+        removePartial();
+        return;
+    }
+
+    saveMetadata();
+    m_file.close();
+    qDebug() << "[DownloadSession] Suspended" << m_filePath << "at" << m_bytesWritten << "of" << m_totalSize;
+}
+
+void DownloadSession::cancel()
+{
+    if (m_finished) {
+        return;
+    }
+    m_finished = true;
+    removePartial();
+}
+
+bool DownloadSession::loadMetadata()
+{
+    QFile file(metadataPath());
+    if (!file.open(QIODevice::ReadOnly)) {
+        return false;
+    }
+
+    QJsonObject meta = QJsonDocument::fromJson(file.readAll()).object();
+    m_validator = meta.value("validator").toString().toLatin1();
+    m_totalSize = static_cast<qint64>(meta.value("totalSize").toDouble(-1));
+    m_savedOffset = static_cast<qint64>(meta.value("offset").toDouble(0));
+
+    return !m_validator.isEmpty() && m_savedOffset > 0
+        && (m_totalSize < 0 || m_savedOffset <= m_totalSize);
+}
+
+void DownloadSession::saveMetadata()
+{
+    // 先把数据落盘，保证记录的偏移之前的内容都已写入
+    if (!m_file.flush() || m_validator.isEmpty()) {
+        return;
+    }
+
+    QJsonObject meta;
+    meta["validator"] = QString::fromLatin1(m_validator);
+    meta["totalSize"] = m_totalSize;
+    meta["offset"] = m_bytesWritten;
+
+    QSaveFile file(metadataPath());
+    if (file.open(QIODevice::WriteOnly)) {
+        file.write(QJsonDocument(meta).toJson(QJsonDocument::Compact));
+        if (file.commit()) {
+            m_savedOffset = m_bytesWritten;
+        }
+    }
+}
+
+void DownloadSession::removePartial()
+{
+    m_file.close();
+    QFile::remove(m_partPath);
+    QFile::remove(metadataPath());
+}
@@ -0,0 +1,116 @@
+﻿#ifndef DOWNLOADSESSION_H
+#define DOWNLOADSESSION_H
+
+#include <QObject>
+#include <QString>
+#include <QByteArray>
+#include <QFile>
+#include <QCryptographicHash>
+#include <QNetworkRequest>
+#include <QNetworkReply>
+
+/**
+ * @brief 单个文件下载的会话状态（支持断点续传）
+ *
+ * 下载数据在 readyRead 时逐块追加到 "<目标文件>.part"，同时计算 SHA-256，
+ * 内存中最多只保留一次 readyRead 的数据块，与文件大小无关。
+ * 续传信息（ETag / Last-Modified、文件总大小、已写入偏移）保存在 "<目标文件>.part.json"：
+ * - 连接中断或被终止时 suspend() 保留部分文件，下次下载同一文件时
+ *   通过 Range + If-Range 请求剩余部分；服务器返回200（资源已变化或不支持Range）时从头开始
+ * - 其他状态码（404、5xx等）的响应体不写入文件，部分文件和续传信息保持不变，
+ *   错误由请求结束时统一报告
+ * - 全部数据到达后 commit() 将部分文件重命名为目标文件，目标路径上不会出现写了一半的文件
+ * - 数据无法续传（写入失败、Content-Range不匹配等）时 cancel() 删除部分文件
+ *
+ * 与 StreamSession 相同，DownloadSession 挂载后以 QNetworkReply 为父对象，
+ * 通过 fromReply() 从回复对象上直接取回。
+ */
+class DownloadSession : public QObject
+{
+    Q_OBJECT
+
+public:
+    /**
+     * @brief 创建会话
+     * @param filePath 下载完成后文件的保存路径
+     */
+    explicit DownloadSession(const QString& filePath);
+
+    /// @brief 取回挂载在回复对象上的下载会话，非下载请求返回nullptr
+    static DownloadSession* fromReply(QNetworkReply* reply);
+
+    /**
+     * @brief 打开部分文件，读取续传信息
+     * @return 是否成功；存在可用的部分文件时会先对已有数据计算哈希
+     */
+    bool open();
+
+    /// @brief 有可续传数据时为请求添加 Range / If-Range 头
+    void prepareRequest(QNetworkRequest& request) const;
+
+    /// @brief 挂载到回复对象上，回复对象同时作为父对象
+    void attach(QNetworkReply* reply);
+
+    /// @brief 写入一个数据块并更新哈希，首个数据块到达时检查响应头决定续传还是重新开始
+    bool write(const QByteArray& data);
+
+    /// @brief 写入完成，将部分文件重命名为目标文件并结束会话
+    bool commit();
+
+    /// @brief 保留已写入的数据和续传信息并结束会话，下次可以继续下载
+    void suspend();
+
+    /// @brief 丢弃已写入的数据和续传信息并结束会话
+    void cancel();
+
+    QNetworkReply* reply() const { return m_reply; }
+    QString filePath() const { return m_filePath; }
+    QString errorString() const { return m_errorString; }
+
+    /// @brief 本次请求开始时文件中已有的字节数
+    qint64 resumeOffset() const { return m_resumeOffset; }
+
+    /// @brief 文件中已写入的总字节数（含续传前已有的数据）
+    qint64 bytesWritten() const { return m_bytesWritten; }
+
+    /// @brief 文件总大小，未知时为-1
+    qint64 totalSize() const { return m_totalSize; }
+
+    /// @brief 已写入的数据能否在下次请求时续传
+    bool isResumable() const;
+
+    /// @brief 已写入数据的SHA-256（十六进制），commit() 成功后有效
+    QString sha256() const { return m_sha256; }
+
+    /// @brief 会话是否已经结束（已提交、已挂起或已取消）
+    bool isFinished() const { return m_finished; }
+
+    /// @brief 响应状态码是否不可用于写入（非200，或非续传时的206）
+    bool isRejected() const { return m_rejected; }
+
+private:
+    bool startResponse();
+    bool restart();
+    bool loadMetadata();
+    void saveMetadata();
+    void removePartial();
+    QString metadataPath() const { return m_partPath + ".json"; }
+
+    QNetworkReply* m_reply;
+    QString m_filePath;
+    QString m_partPath;
+    QFile m_file;
+    QCryptographicHash m_hash;
+    QByteArray m_validator;         ///< 续传校验值（ETag优先，否则为Last-Modified）
+    qint64 m_resumeOffset;
+    qint64 m_bytesWritten;
+    qint64 m_totalSize;
+    qint64 m_savedOffset;           ///< 上次写入续传信息时的偏移
+    QString m_sha256;
+    QString m_errorString;
+    bool m_started;                 ///< 是否已经检查过响应头
+    bool m_rejected;                ///< 响应状态码不可接受，丢弃响应体
+    bool m_finished;
+};
+
+#endif // DOWNLOADSESSION_H
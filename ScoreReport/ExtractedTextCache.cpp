@@ -0,0 +1,317 @@
+﻿#include "ExtractedTextCache.h"
+#include "DocxReader.h"
+#include <QCoreApplication>
+#include <QFile>
+#include <QFileInfo>
+#include <QDir>
+#include <QSaveFile>
+#include <QDateTime>
+#include <QCryptographicHash>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QMutexLocker>
+#include <QVector>
+#include <QPair>
+#include <QDebug>
+#include <algorithm>
+
+namespace {
+const char* const kCacheDir = "AppData/cache/text";
+const char* const kIndexFile = "index.json";
+const int kIndexVersion = 1;
+const qint64 kDefaultMaxBytes = 64 * 1024 * 1024;   ///< 缓存总大小上限
+const int kSaveDelayMs = 5000;                      ///< 命中后延迟写入索引的时间
+}
+
+ExtractedTextCache::ExtractedTextCache(QObject* parent)
+    : QObject(parent)
+    , m_cacheDir(QDir(kCacheDir).absolutePath())
+    , m_totalBytes(0)
+    , m_maxBytes(kDefaultMaxBytes)
+    , m_indexDirty(false)
+    , m_saveTimer(this)
+{
+    QDir().mkpath(m_cacheDir);
+    loadIndex();
+
+    m_saveTimer.setSingleShot(true);
+    m_saveTimer.setInterval(kSaveDelayMs);
+    connect(&m_saveTimer, &QTimer::timeout, this, &ExtractedTextCache::flush);
+    if (QCoreApplication::instance()) {
+        // 第一次使用通常发生在文件读取线程中，延迟保存和退出时的保存都放到GUI线程
+        moveToThread(QCoreApplication::instance()->thread());
+        connect(QCoreApplication::instance(), &QCoreApplication::aboutToQuit, this, &ExtractedTextCache::flush);
+    }
+}
+
+bool ExtractedTextCache::lookup(const QString& filePath, QString& text)
+{
+    const QString key = contentKey(filePath);
+    if (key.isEmpty()) {
+        return false;
+    }
+
+    {
+        QMutexLocker locker(&m_mutex);
+        if (!m_entries.contains(key)) {
+            return false;
+        }
+    }
+
+    QFile file(entryPath(key));
+    if (!file.open(QIODevice::ReadOnly)) {
+        // 文本文件已被外部删除，同步移除索引
+        QMutexLocker locker(&m_mutex);
+        auto it = m_entries.find(key);
+        if (it != m_entries.end()) {
+            m_totalBytes -= it->bytes;
+            m_entries.erase(it);
+            saveIndex();
+        }
+        return false;
+    }
+    text = QString::fromUtf8(file.readAll());
+
+    {
+        // 只更新内存中的使用时间，索引稍后合并写入
+        QMutexLocker locker(&m_mutex);
+        auto it = m_entries.find(key);
+        if (it != m_entries.end()) {
+            it->lastUsed = QDateTime::currentMSecsSinceEpoch();
+            m_indexDirty = true;
+        }
+    }
+    scheduleSave();
+    qDebug() << "[ExtractedTextCache] Hit:" << filePath << "key:" << key.left(12);
+    return true;
+}
+
+void ExtractedTextCache::store(const QString& filePath, const QString& text)
+{
+    const QString key = contentKey(filePath);
+    if (key.isEmpty() || text.isEmpty()) {
+        return;
+    }
+
+    const QByteArray data = text.toUtf8();
+    if (data.size() > m_maxBytes) {
+        return;
+    }
+
+    QSaveFile file(entryPath(key));
+    if (!file.open(QIODevice::WriteOnly) || file.write(data) != data.size() || !file.commit()) {
+        qWarning() << "[ExtractedTextCache] Failed to write" << file.fileName() << file.errorString();
+        return;
+    }
+
+    QMutexLocker locker(&m_mutex);
+    auto it = m_entries.find(key);
+    if (it != m_entries.end()) {
+        m_totalBytes -= it->bytes;
+    }
+    Entry entry;
+    entry.bytes = data.size();
+    entry.lastUsed = QDateTime::currentMSecsSinceEpoch();
+    m_entries.insert(key, entry);
+    m_totalBytes += entry.bytes;
+
+    evict();
+    saveIndex();
+    qDebug() << "[ExtractedTextCache] Stored:" << filePath << "bytes:" << data.size()
+             << "total:" << m_totalBytes;
+}
+
+void ExtractedTextCache::clear()
+{
+    QMutexLocker locker(&m_mutex);
+    for (auto it = m_entries.constBegin(); it != m_entries.constEnd(); ++it) {
+        QFile::remove(entryPath(it.key()));
+    }
+    m_entries.clear();
+    m_pathKeys.clear();
+    m_totalBytes = 0;
+    saveIndex();
+}
+
+qint64 ExtractedTextCache::totalBytes() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_totalBytes;
+}
+
+void ExtractedTextCache::flush()
+{
+    QMutexLocker locker(&m_mutex);
+    if (m_indexDirty) {
+        saveIndex();
+    }
+}
+
+void ExtractedTextCache::scheduleSave()
+{
+    // lookup() 在文件读取线程中调用，定时器只能在所属的GUI线程中启动
+    QMetaObject::invokeMethod(this, [this]() {
+        if (!m_saveTimer.isActive()) {
+            m_saveTimer.start();
+        }
+    }, Qt::QueuedConnection);
+}
+
+QString ExtractedTextCache::contentKey(const QString& filePath)
+{
+    QFileInfo info(filePath);
+    if (!info.isFile()) {
+        return QString();
+    }
+    const QString absolutePath = info.absoluteFilePath();
+    const qint64 size = info.size();
+    const qint64 modified = info.lastModified().toMSecsSinceEpoch();
+
+    // 快速路径：文件大小和修改时间都没变时认为内容未变
+    {
+        QMutexLocker locker(&m_mutex);
+        auto it = m_pathKeys.constFind(absolutePath);
+        if (it != m_pathKeys.constEnd() && it->size == size && it->modified == modified) {
+            return it->key;
+        }
+    }
+
+    QFile file(absolutePath);
+    if (!file.open(QIODevice::ReadOnly)) {
+        return QString();
+    }
+    QCryptographicHash hash(QCryptographicHash::Sha256);
+    if (!hash.addData(&file)) {
+        return QString();
+    }
+
+    PathKey pathKey;
+    pathKey.size = size;
+    pathKey.modified = modified;
+    pathKey.key = QString::fromLatin1(hash.result().toHex());
+
+    QMutexLocker locker(&m_mutex);
+    m_pathKeys.insert(absolutePath, pathKey);
+    return pathKey.key;
+}
+
+QString ExtractedTextCache::entryPath(const QString& key) const
+{
+    return m_cacheDir + "/" + key + ".txt";
+}
+
+void ExtractedTextCache::loadIndex()
+{
+    QFile file(m_cacheDir + "/" + kIndexFile);
+    if (!file.open(QIODevice::ReadOnly)) {
+        return;
+    }
+
+    QJsonObject root = QJsonDocument::fromJson(file.readAll()).object();
+    if (root.value("version").toInt() != kIndexVersion) {
+        return;
+    }
+
+    // 提取器输出格式变化后，旧的提取结果不再可用
+    QJsonObject entries = root.value("entries").toObject();
+    if (root.value("extractorVersion").toInt() != DocxReader::kOutputVersion) {
+        for (auto it = entries.constBegin(); it != entries.constEnd(); ++it) {
+            QFile::remove(entryPath(it.key()));
+        }
+        qDebug() << "[ExtractedTextCache] Extractor version changed, discarded" << entries.size() << "entries";
+        saveIndex();
+        return;
+    }
+
+    // 只保留文本文件仍然存在的条目，大小以磁盘上的实际大小为准
+    for (auto it = entries.constBegin(); it != entries.constEnd(); ++it) {
+        QFileInfo info(entryPath(it.key()));
+        if (!info.isFile()) {
+            continue;
+        }
+        Entry entry;
+        entry.bytes = info.size();
+        entry.lastUsed = static_cast<qint64>(it.value().toObject().value("lastUsed").toDouble());
+        m_entries.insert(it.key(), entry);
+        m_totalBytes += entry.bytes;
+    }
+
+    QJsonObject paths = root.value("paths").toObject();
+    for (auto it = paths.constBegin(); it != paths.constEnd(); ++it) {
+        QJsonObject obj = it.value().toObject();
+        PathKey pathKey;
+        pathKey.key = obj.value("key").toString();
+        if (!m_entries.contains(pathKey.key)) {
+            continue;
+        }
+        pathKey.size = static_cast<qint64>(obj.value("size").toDouble());
+        pathKey.modified = static_cast<qint64>(obj.value("modified").toDouble());
+        m_pathKeys.insert(it.key(), pathKey);
+    }
+
+    evict();
+    qDebug() << "[ExtractedTextCache] Loaded" << m_entries.size() << "entries," << m_totalBytes << "bytes";
+}
+
+void ExtractedTextCache::saveIndex()
+{
+    QJsonObject entries;
+    for (auto it = m_entries.constBegin(); it != m_entries.constEnd(); ++it) {
+        QJsonObject obj;
+        obj["bytes"] = it->bytes;
+        obj["lastUsed"] = it->lastUsed;
+        entries.insert(it.key(), obj);
+    }
+
+    // 只记录仍有缓存条目的路径，避免索引无限增长
+    QJsonObject paths;
+    for (auto it = m_pathKeys.constBegin(); it != m_pathKeys.constEnd(); ++it) {
+        if (!m_entries.contains(it->key)) {
+            continue;
+        }
+        QJsonObject obj;
+        obj["key"] = it->key;
+        obj["size"] = it->size;
+        obj["modified"] = it->modified;
+        paths.insert(it.key(), obj);
+    }
+
+    QJsonObject root;
+    root["version"] = kIndexVersion;
+    root["extractorVersion"] = DocxReader::kOutputVersion;
+    root["entries"] = entries;
+    root["paths"] = paths;
+
+    QSaveFile file(m_cacheDir + "/" + kIndexFile);
+    if (file.open(QIODevice::WriteOnly)) {
+        file.write(QJsonDocument(root).toJson(QJsonDocument::Compact));
+        if (file.commit()) {
+            m_indexDirty = false;
+        }
+    }
+}
+
+void ExtractedTextCache::evict()
+{
+    if (m_totalBytes <= m_maxBytes) {
+        return;
+    }
+
+    // 按最近使用时间从旧到新淘汰，直到总大小回到上限以内
+    QVector<QPair<qint64, QString>> byAge;
+    byAge.reserve(m_entries.size());
+    for (auto it = m_entries.constBegin(); it != m_entries.constEnd(); ++it) {
+        byAge.append(qMakePair(it->lastUsed, it.key()));
+    }
+    std::sort(byAge.begin(), byAge.end());
+
+    for (const auto& item : byAge) {
+        if (m_totalBytes <= m_maxBytes) {
+            break;
+        }
+        m_totalBytes -= m_entries.value(item.second).bytes;
+        m_entries.remove(item.second);
+        QFile::remove(entryPath(item.second));
+        qDebug() << "[ExtractedTextCache] Evicted:" << item.second.left(12);
+    }
+}
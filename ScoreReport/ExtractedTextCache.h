@@ -0,0 +1,88 @@
+﻿#ifndef EXTRACTEDTEXTCACHE_H
+#define EXTRACTEDTEXTCACHE_H
+
+#include <QObject>
+#include <QString>
+#include <QHash>
+#include <QMutex>
+#include <QTimer>
+#include "CommonFunc.h"
+
+/**
+ * @brief 附件提取文本的持久化缓存（按文件内容寻址）
+ *
+ * Word文档的文本提取代价较高，同一份报告被重复添加、或在多个聊天窗口
+ * （ChatManager / KnowledgeChatManager）中添加时，直接复用上次提取的结果。
+ *
+ * - 缓存键为文件内容的SHA-256；路径 + 大小 + 修改时间未变时直接复用上次计算的键，不再读文件
+ * - 文本以UTF-8保存在 AppData/cache/text/<sha256>.txt，索引保存在同目录的 index.json
+ * - 缓存总字节数超过上限时按最近使用时间淘汰（LRU）
+ * - 命中只更新内存中的最近使用时间，索引在几秒后合并写入，程序退出时写入剩余的修改
+ * - 索引记录提取器版本（DocxReader::kOutputVersion），版本变化后旧的提取结果全部作废
+ *
+ * 所有接口线程安全，文件读取线程中直接调用；计算哈希和读写文本时不持有锁。
+ */
+class ExtractedTextCache : public QObject
+{
+    Q_OBJECT
+
+    SINGLETON_CLASS(ExtractedTextCache)
+
+public:
+    /**
+     * @brief 查找文件对应的已提取文本
+     * @param filePath 附件路径
+     * @param text 命中时输出缓存的文本
+     * @return 是否命中
+     */
+    bool lookup(const QString& filePath, QString& text);
+
+    /**
+     * @brief 保存文件提取出的文本
+     * @param filePath 附件路径
+     * @param text 提取出的文本
+     */
+    void store(const QString& filePath, const QString& text);
+
+    /// @brief 清空全部缓存
+    void clear();
+
+    /// @brief 当前缓存的总字节数
+    qint64 totalBytes() const;
+
+public slots:
+    /// @brief 把尚未写入的最近使用时间保存到索引
+    void flush();
+
+private:
+    /// @brief 缓存的一段文本
+    struct Entry {
+        qint64 bytes;       ///< 文本文件大小
+        qint64 lastUsed;    ///< 最近使用时间（毫秒时间戳）
+    };
+
+    /// @brief 路径到内容键的快速映射
+    struct PathKey {
+        qint64 size;
+        qint64 modified;
+        QString key;
+    };
+
+    QString contentKey(const QString& filePath);
+    QString entryPath(const QString& key) const;
+    void loadIndex();
+    void saveIndex();
+    void scheduleSave();
+    void evict();
+
+    mutable QMutex m_mutex;
+    QString m_cacheDir;
+    QHash<QString, Entry> m_entries;      ///< 内容键 -> 缓存条目
+    QHash<QString, PathKey> m_pathKeys;   ///< 绝对路径 -> 内容键
+    qint64 m_totalBytes;
+    qint64 m_maxBytes;
+    bool m_indexDirty;                    ///< 内存中的最近使用时间尚未写入索引
+    QTimer m_saveTimer;                   ///< 合并命中后的索引写入
+};
+
+#endif // EXTRACTEDTEXTCACHE_H
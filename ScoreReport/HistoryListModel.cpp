@@ -0,0 +1,180 @@
+﻿#include "HistoryListModel.h"
+#include <QDateTime>
+#include <algorithm>
+
+namespace {
+/// @brief 服务器时间格式（东八区）
+const char* const kServerTimeFormat = "yyyy-MM-dd HH:mm:ss";
+}
+
+HistoryListModel::HistoryListModel(QObject* parent)
+    : QAbstractListModel(parent)
+    , m_hasMore(false)
+{
+}
+
+int HistoryListModel::rowCount(const QModelIndex& parent) const
+{
+    return parent.isValid() ? 0 : m_rows.size();
+}
+
+QVariant HistoryListModel::data(const QModelIndex& index, int role) const
+{
+    if (!index.isValid() || index.row() < 0 || index.row() >= m_rows.size()) {
+        return QVariant();
+    }
+
+    const Row& row = m_rows.at(index.row());
+    switch (role) {
+    case IdRole:
+        return row.id;
+    case TypeRole:
+        return m_types.at(row.typeIndex);
+    case Qt::DisplayRole:
+    case TitleRole:
+        return row.title;
+    case ResultRole:
+        return row.result;
+    case UpdateTimeRole:
+        return QDateTime::fromString(row.updateTime, kServerTimeFormat).toString(Qt::ISODate);
+    case DateTextRole:
+        return formatDateText(row.updateTime);
+    default:
+        return QVariant();
+    }
+}
+
+QHash<int, QByteArray> HistoryListModel::roleNames() const
+{
+    QHash<int, QByteArray> roles;
+    roles[IdRole] = "id";
+    roles[TypeRole] = "type";
+    roles[TitleRole] = "title";
+    roles[ResultRole] = "result";
+    roles[UpdateTimeRole] = "updateTime";
+    roles[DateTextRole] = "dateText";
+    return roles;
+}
+
+bool HistoryListModel::canFetchMore(const QModelIndex& parent) const
+{
+    return !parent.isValid() && m_hasMore;
+}
+
+void HistoryListModel::fetchMore(const QModelIndex& parent)
+{
+    if (!parent.isValid() && m_hasMore) {
+        emit fetchMoreRequested();
+    }
+}
+
+void HistoryListModel::setEntries(const QVector<HistoryEntry>& entries)
+{
+    const int oldCount = m_rows.size();
+    const int newCount = entries.size();
+    auto sameRow = [this, &entries](int oldRow, int newRow) {
+        const Row& row = m_rows.at(oldRow);
+        const HistoryEntry& entry = entries.at(newRow);
+        return row.id == entry.id && row.updateTime == entry.updateTime;
+    };
+
+    // 头尾相同的行保留，只替换中间不同的部分
+    int prefix = 0;
+    while (prefix < oldCount && prefix < newCount && sameRow(prefix, prefix)) {
+        ++prefix;
+    }
+    int suffix = 0;
+    while (suffix < oldCount - prefix && suffix < newCount - prefix
+        && sameRow(oldCount - 1 - suffix, newCount - 1 - suffix)) {
+        ++suffix;
+    }
+
+    const int removeCount = oldCount - prefix - suffix;
+    if (removeCount > 0) {
+        beginRemoveRows(QModelIndex(), prefix, prefix + removeCount - 1);
+        m_rows.remove(prefix, removeCount);
+        endRemoveRows();
+    }
+
+    const int insertCount = newCount - prefix - suffix;
+    if (insertCount > 0) {
+        QVector<Row> rows;
+        rows.reserve(insertCount);
+        for (int i = prefix; i < prefix + insertCount; ++i) {
+            rows.append(makeRow(entries.at(i)));
+        }
+        beginInsertRows(QModelIndex(), prefix, prefix + insertCount - 1);
+        if (prefix == m_rows.size()) {
+            m_rows += rows;
+        } else {
+            m_rows.insert(prefix, insertCount, Row());
+            std::copy(rows.constBegin(), rows.constEnd(), m_rows.begin() + prefix);
+        }
+        endInsertRows();
+    }
+
+    if (m_rows.size() != oldCount) {
+        emit countChanged();
+    }
+}
+
+void HistoryListModel::clear()
+{
+    if (m_rows.isEmpty()) {
+        return;
+    }
+    beginResetModel();
+    m_rows.clear();
+    endResetModel();
+    emit countChanged();
+}
+
+HistoryListModel::Row HistoryListModel::makeRow(const HistoryEntry& entry)
+{
+    Row row;
+    row.id = entry.id;
+    row.title = entry.title;
+    row.result = entry.result;
+    row.updateTime = entry.updateTime;
+    row.typeIndex = internType(entry.type);
+    return row;
+}
+
+int HistoryListModel::internType(const QString& type)
+{
+    auto it = m_typeIndexes.constFind(type);
+    if (it != m_typeIndexes.constEnd()) {
+        return it.value();
+    }
+    m_types.append(type);
+    m_typeIndexes.insert(type, m_types.size() - 1);
+    return m_types.size() - 1;
+}
+
+QString HistoryListModel::formatDateText(const QString& updateTime)
+{
+    QDateTime dateTime = QDateTime::fromString(updateTime, kServerTimeFormat);
+    if (!dateTime.isValid()) {
+        dateTime = QDateTime::currentDateTime();
+    }
+
+    // 按日期计算相差天数，不考虑具体时间
+    const qint64 daysDiff = dateTime.date().daysTo(QDate::currentDate());
+    const QString time = dateTime.toString("hh:mm");
+    if (daysDiff <= 0) {
+        return QStringLiteral("今天 ") + time;
+    }
+    if (daysDiff == 1) {
+        return QStringLiteral("昨天 ") + time;
+    }
+    if (daysDiff == 2) {
+        return QStringLiteral("前天 ") + time;
+    }
+    if (daysDiff < 7) {
+        return QStringLiteral("%1天前").arg(daysDiff);
+    }
+    if (daysDiff < 30) {
+        return QStringLiteral("%1周前").arg(daysDiff / 7);
+    }
+    return QStringLiteral("%1个月前").arg(daysDiff / 30);
+}
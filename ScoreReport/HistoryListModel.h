@@ -0,0 +1,94 @@
+﻿#ifndef HISTORYLISTMODEL_H
+#define HISTORYLISTMODEL_H
+
+#include <QAbstractListModel>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+#include <QHash>
+#include "HistoryStore.h"
+
+/**
+ * @brief 评测历史记录列表模型 - 供QML的ListView直接绑定
+ *
+ * 取代原先每条记录转成一个 QVariantMap 的 historyList 属性：
+ * - 每行是一个只含显示所需字段的结构体，连续保存在 QVector 中；
+ *   字符串与 HistoryStore 中的记录隐式共享，不再复制内容
+ * - 记录类型只有少数几种，每行只保存类型序号，类型字符串全模型共用一份
+ * - 时间保留服务器原始字符串，只有QML读取 updateTime / dateText 角色时才格式化，
+ *   ListView 只为可见的行读取
+ *
+ * - setEntries() 只对与当前列表不同的部分增删行，新记录插入顶部或下一页追加到底部时
+ *   其余委托和滚动位置保持不变
+ * - 还有更多记录可加载时 canFetchMore() 返回 true，ListView 滚动到接近末尾时调用 fetchMore()，
+ *   模型发出 fetchMoreRequested 由 HistoryManager 请求下一页
+ *
+ * QML中通过 model.type / model.title / model.result / model.dateText 等访问角色，
+ * dateText 可直接作为 ListView 的 section.property 按时间分组。
+ */
+class HistoryListModel : public QAbstractListModel
+{
+    Q_OBJECT
+
+    /// @brief 记录数量
+    Q_PROPERTY(int count READ count NOTIFY countChanged)
+
+public:
+    enum Roles {
+        IdRole = Qt::UserRole + 1,      ///< 记录ID
+        TypeRole,                       ///< 评分类型，如 CCLS / RENAL
+        TitleRole,                      ///< 标题
+        ResultRole,                     ///< 结果
+        UpdateTimeRole,                 ///< 更新时间（ISO格式）
+        DateTextRole                    ///< 分组标题，如 "今天 19:19" / "3天前"
+    };
+
+    explicit HistoryListModel(QObject* parent = nullptr);
+
+    int rowCount(const QModelIndex& parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex& index, int role = Qt::DisplayRole) const override;
+    QHash<int, QByteArray> roleNames() const override;
+    bool canFetchMore(const QModelIndex& parent) const override;
+    void fetchMore(const QModelIndex& parent) override;
+
+    int count() const { return m_rows.size(); }
+
+    /**
+     * @brief 替换全部记录
+     * @param entries 按显示顺序排列的记录
+     */
+    void setEntries(const QVector<HistoryEntry>& entries);
+
+    /// @brief 清空所有记录
+    void clear();
+
+    /// @brief 设置是否还有更多记录可以加载
+    void setHasMore(bool hasMore) { m_hasMore = hasMore; }
+
+signals:
+    void countChanged();
+
+    /// @brief 视图需要更多记录
+    void fetchMoreRequested();
+
+private:
+    struct Row {
+        QString id;
+        QString title;
+        QString result;
+        QString updateTime;     ///< 服务器原始时间 "yyyy-MM-dd HH:mm:ss"
+        int typeIndex;          ///< m_types 中的序号
+    };
+
+    Row makeRow(const HistoryEntry& entry);
+    int internType(const QString& type);
+
+    static QString formatDateText(const QString& updateTime);
+
+    QVector<Row> m_rows;
+    QStringList m_types;                    ///< 出现过的记录类型
+    QHash<QString, int> m_typeIndexes;      ///< 记录类型 -> 序号
+    bool m_hasMore;                         ///< 是否还有更多记录可以加载
+};
+
+#endif // HISTORYLISTMODEL_H
@@ -1,74 +1,97 @@
 ﻿#include "HistoryManager.h"
 #include "ApiManager.h"
+#include "LoginManager.h"
 #include <QJsonDocument>
-#include <QVariantMap>
 #include <QClipboard>
 #include <QGuiApplication>
-// HistoryRecord实现
-HistoryRecord::HistoryRecord(QObject* parent)
-    : QObject(parent)
-    , m_isDelete(0)
-{
-}
-
-HistoryRecord::HistoryRecord(const QJsonObject& json, QObject* parent)
-    : QObject(parent)
-{
-    m_id = json.value("id").toString();
-    m_userId = json.value("userId").toString();
-    m_type = json.value("type").toString();
-    m_title = json.value("title").toString();
-    m_chatId = json.value("chatId").toString();
-    m_content = json.value("content").toString();
-    m_result = json.value("result").toString();
-    m_isDelete = json.value("isDelete").toInt();
-
-    // 解析时间字符串 - 服务器返回的是东八区时间格式 "yyyy-MM-DD hh:mm:ss"
-    QString createTimeStr = json.value("createTime").toString();
-    QString updateTimeStr = json.value("updateTime").toString();
+#include <QElapsedTimer>
+#include <QFutureWatcher>
+#include <QtConcurrent/QtConcurrent>
+#include <algorithm>
 
-    m_createTime = QDateTime::fromString(createTimeStr, "yyyy-MM-dd HH:mm:ss");
-    m_updateTime = QDateTime::fromString(updateTimeStr, "yyyy-MM-dd HH:mm:ss");
-}
+namespace {
+// 首屏、增量同步和筛选查询每页记录数，一次小请求即可显示
+const int kPageSize = 20;
+// 列表滚动到末尾时加载的旧记录数
+const int kTailPageSize = 50;
+// 后台补齐每页记录数
+const int kBackfillPageSize = 200;
+// 全量同步每页记录数
+const int kFullPageSize = 500;
 
-QVariantMap HistoryRecord::toVariantMap() const
+// 后台线程读取的本地记录和据此建立的索引
+struct LoadedHistory
 {
-    QVariantMap map;
-    map["id"] = m_id;
-    map["userId"] = m_userId;
-    map["type"] = m_type;
-    map["title"] = m_title;
-    map["chatId"] = m_chatId;
-    map["content"] = m_content;
-    map["result"] = m_result;
-    map["createTime"] = m_createTime.toString(Qt::ISODate);
-    map["updateTime"] = m_updateTime.toString(Qt::ISODate);
-    map["isDelete"] = m_isDelete;
-    return map;
-}
+    HistoryStore store;
+    HistorySearchIndex index;
+};
 
-HistoryRecord* HistoryRecord::fromJson(const QJsonObject& json, QObject* parent)
+// 合并本地和服务器的筛选结果，去重后按 updateTime 从新到旧排列
+QVector<HistoryEntry> mergeNewestFirst(const QVector<HistoryEntry>& local, const QVector<HistoryEntry>& remote)
 {
-    return new HistoryRecord(json, parent);
+    QVector<HistoryEntry> merged = local;
+    QSet<QString> ids;
+    for (const HistoryEntry& entry : local) {
+        ids.insert(entry.id);
+    }
+    for (const HistoryEntry& entry : remote) {
+        if (!ids.contains(entry.id)) {
+            ids.insert(entry.id);
+            merged.append(entry);
+        }
+    }
+    std::sort(merged.begin(), merged.end(), [](const HistoryEntry& a, const HistoryEntry& b) {
+        if (a.updateTime != b.updateTime) {
+            return a.updateTime > b.updateTime;
+        }
+        return a.id > b.id;
+    });
+    return merged;
+}
 }
 
 // HistoryManager实现
 HistoryManager::HistoryManager(QObject* parent)
     : QObject(parent)
     , m_apiManager(nullptr)
+    , m_historyModel(new HistoryListModel(this))
+    , m_fetchKind(NoFetch)
+    , m_fetchPage(1)
+    , m_fetchPageSize(kPageSize)
+    , m_serverTotal(-1)
+    , m_headPending(false)
+    , m_tailRequested(false)
+    , m_tailExhausted(false)
+    , m_fullPending(false)
+    , m_resynced(false)
+    , m_remoteMode(false)
+    , m_remoteRequested(false)
+    , m_remoteHasMore(false)
+    , m_remotePage(0)
 {
     // 初始化属性
     setisLoading(false);
+    setisSyncing(false);
     setsearchText("");
     setsearchType("");
     setsearchDate("");
-    sethistoryList(QVariantList());
+
+    // 筛选条件变化时先在本地重新查询，本地记录不完整时再分页查询服务器
+    connect(this, &HistoryManager::searchTextChanged, this, &HistoryManager::onFiltersChanged);
+    connect(this, &HistoryManager::searchTypeChanged, this, &HistoryManager::onFiltersChanged);
+    connect(this, &HistoryManager::searchDateChanged, this, &HistoryManager::onFiltersChanged);
+
+    // 列表滚动到接近末尾时加载下一页
+    connect(m_historyModel, &HistoryListModel::fetchMoreRequested,
+        this, &HistoryManager::onFetchMoreRequested);
 
     // 获取ApiManager单例并连接信号
     m_apiManager = GET_SINGLETON(ApiManager);
     if (m_apiManager) {
         connect(m_apiManager, &ApiManager::getQualityListResponse,
             this, &HistoryManager::onHistoryResponse);
+        connect(m_apiManager, &ApiManager::addQualityRecordResponse,
+            this, &HistoryManager::onQualityRecordAdded);
     }
     else {
         qWarning() << "[HistoryManager] Failed to get ApiManager instance!";
@@ -82,15 +105,50 @@ void HistoryManager::updateList()
         return;
     }
 
-    if (getisLoading()) {
-        qDebug() << "[HistoryManager] Already loading, skip request";
+    QString userId = GET_SINGLETON(LoginManager)->getcurrentUserId();
+    if (userId.isEmpty() || userId == "-1") {
+        m_historyModel->clear();
         return;
     }
 
-    setisLoading(true);
+    // 切换用户后先读取该用户的本地记录，读取完成后再同步
+    if (m_store.userId() != userId) {
+        loadStore(userId);
+        return;
+    }
 
-    // 调用API获取历史记录，使用固定的分页参数
-    m_apiManager->getQualityList(getsearchType(), "", "", getsearchText(), getsearchDate(), 1, 500);
+    // 先显示本地记录，再向服务器拉取新记录
+    updateHistoryList();
+    m_headPending = true;
+    scheduleFetch();
+}
+
+void HistoryManager::clearLocalCache()
+{
+    cancelFetch();
+    // 正在后台读取的结果到达时因用户ID不匹配被丢弃
+    m_loadingUserId.clear();
+
+    m_store = HistoryStore();
+    m_searchIndex = HistorySearchIndex();
+    m_historyModel->clear();
+    HistoryStore::removeAll();
+
+    m_serverTotal = -1;
+    m_headPending = false;
+    m_tailRequested = false;
+    m_tailExhausted = false;
+    m_fullPending = false;
+    m_resynced = false;
+    m_syncWatermark.clear();
+    m_syncSeenIds.clear();
+    m_remoteMode = false;
+    m_remoteRequested = false;
+    m_remoteHasMore = false;
+    m_remotePage = 0;
+    m_remoteResults.clear();
+    setisLoading(false);
+    qDebug() << "[HistoryManager] Local history cache cleared";
 }
 
 void HistoryManager::copyToClipboard(const QString& content)
@@ -99,49 +157,361 @@ void HistoryManager::copyToClipboard(const QString& content)
     clipboard->setText(content);
 }
 
+void HistoryManager::loadStore(const QString& userId)
+{
+    if (m_loadingUserId == userId) {
+        return;
+    }
+    m_loadingUserId = userId;
+    setisLoading(true);
+
+    // 上一个用户的请求结果已无用
+    if (m_fetchKind != NoFetch) {
+        m_apiManager->abortRequestsByType(ApiManager::GetQualityList);
+        m_fetchKind = NoFetch;
+        setisSyncing(false);
+    }
+
+    // 记录较多时解析和建立索引需要一定时间，放到后台线程
+    auto* watcher = new QFutureWatcher<LoadedHistory>(this);
+    connect(watcher, &QFutureWatcher<LoadedHistory>::finished, this, [this, watcher, userId]() {
+        watcher->deleteLater();
+        // 读取期间又切换了用户
+        if (m_loadingUserId != userId) {
+            return;
+        }
+        m_loadingUserId.clear();
+
+        LoadedHistory loaded = watcher->result();
+        m_store = loaded.store;
+        m_searchIndex = loaded.index;
+
+        // 重置同步状态，服务器记录总数在第一次响应后得知
+        m_serverTotal = -1;
+        m_headPending = true;
+        m_tailRequested = false;
+        m_tailExhausted = false;
+        m_fullPending = false;
+        m_resynced = false;
+        m_syncSeenIds.clear();
+
+        m_remoteMode = hasFilters();
+        m_remoteRequested = m_remoteMode;
+        m_remoteHasMore = m_remoteMode;
+        m_remotePage = 0;
+        m_remoteResults.clear();
+
+        updateHistoryList();
+        setisLoading(m_store.count() == 0);
+        scheduleFetch();
+    });
+    watcher->setFuture(QtConcurrent::run([userId]() {
+        LoadedHistory loaded;
+        loaded.store = HistoryStore::load(userId);
+        loaded.index.rebuild(loaded.store.entries());
+        return loaded;
+    }));
+}
+
+bool HistoryManager::isStoreComplete() const
+{
+    return m_tailExhausted || (m_serverTotal >= 0 && m_store.count() >= m_serverTotal);
+}
+
+bool HistoryManager::hasFilters() const
+{
+    return !getsearchText().trimmed().isEmpty() || !getsearchType().isEmpty() || !getsearchDate().isEmpty();
+}
+
+void HistoryManager::scheduleFetch()
+{
+    if (m_fetchKind != NoFetch || m_store.userId().isEmpty() || !m_loadingUserId.isEmpty()) {
+        return;
+    }
+
+    if (m_remoteMode && m_remoteRequested) {
+        m_remoteRequested = false;
+        requestPage(FilterFetch, m_remotePage + 1, kPageSize);
+    }
+    else if (m_headPending) {
+        m_headPending = false;
+        m_syncWatermark = m_store.latestUpdateTime();
+        requestPage(HeadFetch, 1, kPageSize);
+    }
+    else if ((m_tailRequested || m_serverTotal >= 0) && !isStoreComplete()) {
+        // 滚动到末尾时立即加载一小页，空闲时在后台以较大的页补齐。
+        // 服务器按时间从新到旧分页，本地记录是最新的连续一段，下一页从本地记录数所在的页开始
+        const int pageSize = m_tailRequested ? kTailPageSize : kBackfillPageSize;
+        m_tailRequested = false;
+        requestPage(TailFetch, m_store.count() / pageSize + 1, pageSize);
+    }
+    else if (m_fullPending) {
+        m_fullPending = false;
+        m_syncSeenIds.clear();
+        requestPage(FullFetch, 1, kFullPageSize);
+    }
+
+    setisSyncing(m_fetchKind != NoFetch);
+}
+
+void HistoryManager::requestPage(FetchKind kind, int page, int pageSize)
+{
+    m_fetchKind = kind;
+    m_fetchPage = page;
+    m_fetchPageSize = pageSize;
+
+    if (kind == FilterFetch) {
+        // 搜索文本按结果字段查询，与服务器原有的筛选方式一致
+        m_apiManager->getQualityList(getsearchType(), "", "", getsearchText().trimmed(), getsearchDate(), page, pageSize);
+    }
+    else {
+        m_apiManager->getQualityList("", "", "", "", "", page, pageSize);
+    }
+}
+
+void HistoryManager::cancelFetch()
+{
+    if (m_fetchKind == NoFetch) {
+        return;
+    }
+    if (m_fetchKind == HeadFetch) {
+        m_headPending = true;
+    }
+    else if (m_fetchKind == FullFetch) {
+        m_fullPending = true;
+    }
+
+    // 被终止的请求不会再发出响应信号
+    m_apiManager->abortRequestsByType(ApiManager::GetQualityList);
+    m_fetchKind = NoFetch;
+    setisSyncing(false);
+}
+
+void HistoryManager::onFiltersChanged()
+{
+    if (m_store.userId().isEmpty()) {
+        return;
+    }
+
+    // 进行中的请求属于旧的筛选条件或会推迟新条件的查询，先终止
+    cancelFetch();
+
+    m_remoteMode = hasFilters() && !isStoreComplete();
+    m_remoteRequested = m_remoteMode;
+    m_remoteHasMore = m_remoteMode;
+    m_remotePage = 0;
+    m_remoteResults.clear();
+    m_tailRequested = false;
+
+    updateHistoryList();
+    scheduleFetch();
+}
+
+void HistoryManager::onFetchMoreRequested()
+{
+    if (m_remoteMode) {
+        m_remoteRequested = m_remoteHasMore;
+    }
+    else {
+        m_tailRequested = !isStoreComplete();
+    }
+    scheduleFetch();
+}
+
 void HistoryManager::onHistoryResponse(bool success, const QString& message, const QJsonObject& data)
 {
-    setisLoading(false);
+    const FetchKind kind = m_fetchKind;
+    if (kind == NoFetch) {
+        return;
+    }
+    m_fetchKind = NoFetch;
 
-    if (success) {
-        // 清空现有数据
-        for (HistoryRecord* record : m_records) {
-            if (record) {
-                record->deleteLater();
+    if (!success) {
+        qWarning() << "[HistoryManager] Failed to load history page:" << message;
+        // 失败后不再自动加载，下次打开页面时重试
+        m_remoteHasMore = false;
+        m_historyModel->setHasMore(false);
+        setisSyncing(false);
+        setisLoading(false);
+        return;
+    }
+
+    QJsonArray records = data.value("records").toArray();
+    QVector<HistoryEntry> entries;
+    entries.reserve(records.size());
+    for (const QJsonValue& value : records) {
+        entries.append(HistoryEntry::fromJson(value.toObject()));
+    }
+
+    const qint64 total = data.value("total").toVariant().toLongLong();
+    const bool lastPage = records.size() < m_fetchPageSize
+        || (total > 0 && static_cast<qint64>(m_fetchPage) * m_fetchPageSize >= total);
+
+    int changed = 0;
+    if (kind == FilterFetch) {
+        m_remoteResults += entries;
+        m_remotePage = m_fetchPage;
+        m_remoteHasMore = !lastPage;
+        changed = entries.size();
+    }
+    else {
+        // 服务器未返回总数时只能靠补齐到底判断记录是否完整
+        m_serverTotal = data.contains("total") ? total : -1;
+        changed = applyEntries(entries);
+    }
+
+    qDebug() << "[HistoryManager] Loaded page" << m_fetchPage << "kind:" << kind << "records:" << records.size()
+        << "changed:" << changed << "local:" << m_store.count() << "server:" << total;
+
+    if (kind == HeadFetch) {
+        // 服务器按 updateTime 从新到旧返回，遇到早于本地最新记录的数据说明新记录已全部拉取；
+        // 本地为空时只取第一页，其余由滚动加载和后台补齐完成
+        bool reachedWatermark = m_syncWatermark.isEmpty();
+        for (const HistoryEntry& entry : qAsConst(entries)) {
+            if (entry.updateTime < m_syncWatermark) {
+                reachedWatermark = true;
+                break;
+            }
+        }
+        if (!reachedWatermark && !lastPage) {
+            requestPage(HeadFetch, m_fetchPage + 1, m_fetchPageSize);
+        }
+        else if (m_serverTotal >= 0 && m_store.count() > m_serverTotal && !m_resynced) {
+            // 本地比服务器多，说明服务器上有记录被删除
+            qDebug() << "[HistoryManager] Record count mismatch, server:" << m_serverTotal << "local:" << m_store.count();
+            m_resynced = true;
+            m_fullPending = true;
+        }
+    }
+    else if (kind == TailFetch) {
+        // 没有拿到新记录说明已经到底（或服务器上有记录被删除导致分页偏移，由全量同步处理）
+        if (lastPage || changed == 0) {
+            m_tailExhausted = true;
+        }
+    }
+    else if (kind == FullFetch) {
+        for (const HistoryEntry& entry : qAsConst(entries)) {
+            m_syncSeenIds.insert(entry.id);
+        }
+        if (!lastPage) {
+            requestPage(FullFetch, m_fetchPage + 1, m_fetchPageSize);
+        }
+        else {
+            // 只有拉取完所有页时才能确定哪些记录已在服务器上删除
+            const QStringList removed = m_store.retain(m_syncSeenIds);
+            for (const QString& id : removed) {
+                m_searchIndex.remove(id);
             }
+            changed += removed.size();
+            m_syncSeenIds.clear();
         }
-        m_records.clear();
+    }
+
+    // 本地记录补齐后筛选不再需要查询服务器
+    if (m_remoteMode && kind != FilterFetch && isStoreComplete()) {
+        m_remoteMode = false;
+        m_remoteResults.clear();
+        changed = qMax(changed, 1);
+    }
 
-        parseHistoryData(data);
+    if (changed > 0) {
         updateHistoryList();
+    }
+    else {
+        m_historyModel->setHasMore(m_remoteMode ? m_remoteHasMore : !isStoreComplete());
+    }
+    setisLoading(false);
+    scheduleFetch();
+}
+
+void HistoryManager::onQualityRecordAdded(bool success, const QString& message, const QJsonObject& data)
+{
+    Q_UNUSED(message);
 
-        qDebug() << "[HistoryManager] History loaded successfully. Total records:" << m_records.size();
+    // 本地记录尚未加载时，打开历史记录页面会同步到新记录
+    if (!success || m_store.userId().isEmpty()) {
+        return;
+    }
+
+    // 服务器返回了完整记录时直接写入，否则拉取一次增量
+    if (data.contains("id") && data.contains("updateTime")) {
+        if (applyEntries({ HistoryEntry::fromJson(data) }) > 0) {
+            if (m_serverTotal >= 0) {
+                ++m_serverTotal;
+            }
+            updateHistoryList();
+        }
     }
     else {
-        qWarning() << "[HistoryManager] Failed to load history:" << message;
+        m_headPending = true;
+        scheduleFetch();
     }
 }
 
-void HistoryManager::updateHistoryList()
+int HistoryManager::applyEntries(const QVector<HistoryEntry>& entries)
 {
-    QVariantList list;
-    for (HistoryRecord* record : m_records) {
-        if (record) {
-            list.append(record->toVariantMap());
+    int changed = m_store.upsert(entries);
+    if (changed > 0) {
+        // 索引对未变化的记录不做处理
+        for (const HistoryEntry& entry : entries) {
+            if (entry.isDelete != 0) {
+                m_searchIndex.remove(entry.id);
+            }
+            else {
+                m_searchIndex.update(entry);
+            }
         }
     }
-    sethistoryList(list);
+    return changed;
 }
 
-void HistoryManager::parseHistoryData(const QJsonObject& data)
+void HistoryManager::updateHistoryList()
 {
-    // 解析记录列表
-    QJsonArray records = data.value("records").toArray();
-    for (const QJsonValue& value : records) {
-        QJsonObject recordObj = value.toObject();
-        HistoryRecord* record = HistoryRecord::fromJson(recordObj, this);
-        if (record) {
-            m_records.append(record);
+    const QString text = getsearchText().trimmed();
+    const QString type = getsearchType();
+    const QString date = getsearchDate();
+
+    m_historyModel->setHasMore(m_remoteMode ? m_remoteHasMore : !isStoreComplete());
+
+    if (text.isEmpty() && type.isEmpty() && date.isEmpty()) {
+        m_historyModel->setEntries(m_store.entries());
+        return;
+    }
+
+    QVector<HistoryEntry> list;
+    if (text.isEmpty()) {
+        // 不按文本搜索时直接按类型和日期筛选，记录已按时间排好序
+        for (const HistoryEntry& entry : m_store.entries()) {
+            if (!type.isEmpty() && entry.type != type) {
+                continue;
+            }
+            if (!date.isEmpty() && !entry.updateTime.startsWith(date)) {
+                continue;
+            }
+            list.append(entry);
         }
     }
-}
\ No newline at end of file
+    else {
+        QElapsedTimer timer;
+        timer.start();
+
+        // 索引返回的候选记录再逐条校验查询词是否连续出现
+        const QStringList terms = HistorySearchIndex::queryTerms(text);
+        const QStringList candidates = m_searchIndex.search(text, type, date);
+        for (const QString& id : candidates) {
+            const HistoryEntry* entry = m_store.find(id);
+            if (entry && HistorySearchIndex::matches(*entry, terms)) {
+                list.append(*entry);
+            }
+        }
+
+        qDebug() << "[HistoryManager] Search" << text << "matched" << list.size() << "of" << candidates.size()
+            << "candidates in" << timer.elapsed() << "ms";
+    }
+
+    // 本地记录不完整时合并服务器已返回的筛选结果
+    if (m_remoteMode) {
+        list = mergeNewestFirst(list, m_remoteResults);
+    }
+    m_historyModel->setEntries(list);
+}
@@ -5,73 +5,39 @@
 #include <QString>
 #include <QJsonObject>
 #include <QJsonArray>
-#include <QVariantList>
 #include <QDateTime>
+#include <QSet>
 #include "CommonFunc.h"
+#include "HistoryStore.h"
+#include "HistorySearchIndex.h"
+#include "HistoryListModel.h"
 
 class ApiManager;
 
-// 历史记录数据类
-class HistoryRecord : public QObject
-{
-    Q_OBJECT
-        Q_PROPERTY(QString id READ getId CONSTANT)
-        Q_PROPERTY(QString userId READ getUserId CONSTANT)
-        Q_PROPERTY(QString type READ getType CONSTANT)
-        Q_PROPERTY(QString title READ getTitle CONSTANT)
-        Q_PROPERTY(QString chatId READ getChatId CONSTANT)
-        Q_PROPERTY(QString content READ getContent CONSTANT)
-        Q_PROPERTY(QString result READ getResult CONSTANT)
-        Q_PROPERTY(QDateTime createTime READ getCreateTime CONSTANT)
-        Q_PROPERTY(QDateTime updateTime READ getUpdateTime CONSTANT)
-        Q_PROPERTY(int isDelete READ getIsDelete CONSTANT)
-
-public:
-    explicit HistoryRecord(QObject* parent = nullptr);
-    explicit HistoryRecord(const QJsonObject& json, QObject* parent = nullptr);
-
-    // Getter方法
-    QString getId() const { return m_id; }
-    QString getUserId() const { return m_userId; }
-    QString getType() const { return m_type; }
-    QString getTitle() const { return m_title; }
-    QString getChatId() const { return m_chatId; }
-    QString getContent() const { return m_content; }
-    QString getResult() const { return m_result; }
-    QDateTime getCreateTime() const { return m_createTime; }
-    QDateTime getUpdateTime() const { return m_updateTime; }
-    int getIsDelete() const { return m_isDelete; }
-
-    // 转换为QVariantMap用于QML
-    QVariantMap toVariantMap() const;
-
-    // 从JSON对象创建
-    static HistoryRecord* fromJson(const QJsonObject& json, QObject* parent = nullptr);
-
-private:
-    QString m_id;
-    QString m_userId;
-    QString m_type;
-    QString m_title;
-    QString m_chatId;
-    QString m_content;
-    QString m_result;
-    QDateTime m_createTime;
-    QDateTime m_updateTime;
-    int m_isDelete;
-};
-
 // 历史记录管理类
+// 记录保存在本地（见 HistoryStore），打开时直接从磁盘显示，再向服务器增量同步新记录；
+// 搜索和筛选通过本地倒排索引完成（见 HistorySearchIndex）。
+// 本地记录不完整时（首次使用或旧记录尚未补齐）按页向服务器请求：首屏只请求一小页，
+// 列表滚动到接近末尾时加载下一页，空闲时在后台继续补齐；有筛选条件时同时按条件分页查询服务器，
+// 筛选条件变化时终止进行中的请求
 class HistoryManager : public QObject
 {
     Q_OBJECT
-        QUICK_PROPERTY(QVariantList, historyList)
+        // 筛选后的历史记录列表模型，供QML绑定
+        Q_PROPERTY(HistoryListModel* historyModel READ historyModel CONSTANT)
         QUICK_PROPERTY(bool, isLoading)
+        QUICK_PROPERTY(bool, isSyncing)
         QUICK_PROPERTY(QString, searchText)
         QUICK_PROPERTY(QString, searchType)
         QUICK_PROPERTY(QString, searchDate)
         SINGLETON_CLASS(HistoryManager)
 
+public:
+    HistoryListModel* historyModel() const { return m_historyModel; }
+
+    // 清除本地记录：终止同步，清空内存中的记录、索引和列表，并删除磁盘上的记录文件
+    void clearLocalCache();
+
 public slots:
     // QML调用的方法
     Q_INVOKABLE void updateList();
@@ -79,16 +45,65 @@ public slots:
 
 private slots:
     void onHistoryResponse(bool success, const QString& message, const QJsonObject& data);
+    void onQualityRecordAdded(bool success, const QString& message, const QJsonObject& data);
+    void onFiltersChanged();
+    void onFetchMoreRequested();
 
 private:
+    // 分页请求类型，同一时间只有一个请求在进行
+    enum FetchKind {
+        NoFetch,        // 没有请求
+        HeadFetch,      // 增量同步：从第一页拉取到本地最新记录为止
+        TailFetch,      // 补齐：拉取本地已有记录之后的一页旧记录
+        FullFetch,      // 全量同步：拉取全部记录，删除服务器上已不存在的记录
+        FilterFetch     // 按筛选条件查询服务器（本地记录不完整时）
+    };
+
     ApiManager* m_apiManager;
-    QList<HistoryRecord*> m_records;
+    HistoryStore m_store;               // 当前用户的本地记录
+    HistorySearchIndex m_searchIndex;   // 本地记录的搜索索引
+    HistoryListModel* m_historyModel;   // 筛选后的记录列表
+    QString m_loadingUserId;            // 正在从磁盘读取记录的用户ID
 
-    // 更新QML可访问的历史记录列表
-    void updateHistoryList();
+    // 同步状态
+    FetchKind m_fetchKind;              // 正在进行的请求
+    int m_fetchPage;                    // 正在请求的页码
+    int m_fetchPageSize;                // 正在请求的每页记录数
+    qint64 m_serverTotal;               // 服务器上的记录总数，未知时为-1
+    bool m_headPending;                 // 等待增量同步
+    bool m_tailRequested;               // 列表滚动到末尾，等待下一页旧记录
+    bool m_tailExhausted;               // 补齐时服务器已没有更多旧记录
+    bool m_fullPending;                 // 等待全量同步
+    bool m_resynced;                    // 本次登录是否已因数量不一致做过全量同步
+    QString m_syncWatermark;            // 增量同步起点（本地最新的 updateTime）
+    QSet<QString> m_syncSeenIds;        // 全量同步中服务器返回过的记录ID
+
+    // 服务器筛选查询状态
+    bool m_remoteMode;                  // 当前筛选结果是否需要查询服务器
+    bool m_remoteRequested;             // 等待下一页筛选结果
+    bool m_remoteHasMore;               // 服务器是否还有更多筛选结果
+    int m_remotePage;                   // 已加载的筛选结果页数
+    QVector<HistoryEntry> m_remoteResults;  // 服务器返回的筛选结果
+
+    // 在后台线程读取指定用户的本地记录
+    void loadStore(const QString& userId);
 
-    // 解析服务器响应的历史记录数据
-    void parseHistoryData(const QJsonObject& data);
+    // 本地是否已有服务器上的全部记录
+    bool isStoreComplete() const;
+    bool hasFilters() const;
+
+    // 没有请求进行时按优先级发出下一个请求：筛选查询 > 增量同步 > 滚动加载 > 全量同步 > 后台补齐
+    void scheduleFetch();
+    void requestPage(FetchKind kind, int page, int pageSize);
+
+    // 终止进行中的请求，被终止的增量/全量同步稍后重新开始
+    void cancelFetch();
+
+    // 写入服务器返回的记录并同步更新索引，返回实际变化的记录数
+    int applyEntries(const QVector<HistoryEntry>& entries);
+
+    // 按筛选条件从本地记录（和服务器筛选结果）更新QML可访问的历史记录列表
+    void updateHistoryList();
 };
 
 #endif // HISTORYMANAGER_H 
\ No newline at end of file
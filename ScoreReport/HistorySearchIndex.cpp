@@ -0,0 +1,267 @@
+﻿#include "HistorySearchIndex.h"
+#include <QSet>
+#include <algorithm>
+#include <iterator>
+
+namespace {
+/// @brief 单个字段超过该长度的记录不分词
+const int kMaxIndexedLength = 4096;
+
+/// @brief 是否为按字切分的中日韩文字
+bool isCjk(QChar c)
+{
+    const ushort u = c.unicode();
+    return (u >= 0x3040 && u <= 0x30FF)     // 日文假名
+        || (u >= 0x3400 && u <= 0x4DBF)     // 扩展A
+        || (u >= 0x4E00 && u <= 0x9FFF)     // 基本汉字
+        || (u >= 0xAC00 && u <= 0xD7AF)     // 韩文音节
+        || (u >= 0xF900 && u <= 0xFAFF);    // 兼容汉字
+}
+
+/// @brief 把文本切分为连续的中日韩文字段和小写单词，标点和空白作为分隔
+QStringList splitRuns(const QString& text)
+{
+    QStringList runs;
+    const int length = text.size();
+    int i = 0;
+    while (i < length) {
+        const int start = i;
+        if (isCjk(text.at(i))) {
+            while (i < length && isCjk(text.at(i))) {
+                ++i;
+            }
+            runs.append(text.mid(start, i - start));
+        }
+        else if (text.at(i).isLetterOrNumber()) {
+            while (i < length && !isCjk(text.at(i)) && text.at(i).isLetterOrNumber()) {
+                ++i;
+            }
+            runs.append(text.mid(start, i - start).toCaseFolded());
+        }
+        else {
+            ++i;
+        }
+    }
+    return runs;
+}
+
+/// @brief 收集文本中的所有词（去重）
+void collectTokens(const QString& text, QSet<QString>& tokens)
+{
+    const QStringList runs = splitRuns(text);
+    for (const QString& run : runs) {
+        if (!isCjk(run.at(0))) {
+            tokens.insert(run);
+            continue;
+        }
+        for (int i = 0; i < run.size(); ++i) {
+            tokens.insert(run.mid(i, 1));
+            if (i + 1 < run.size()) {
+                tokens.insert(run.mid(i, 2));
+            }
+        }
+    }
+}
+
+QVector<int> intersect(const QVector<int>& a, const QVector<int>& b)
+{
+    QVector<int> result;
+    std::set_intersection(a.constBegin(), a.constEnd(), b.constBegin(), b.constEnd(), std::back_inserter(result));
+    return result;
+}
+
+QVector<int> unite(const QVector<int>& a, const QVector<int>& b)
+{
+    QVector<int> result;
+    result.reserve(a.size() + b.size());
+    std::set_union(a.constBegin(), a.constEnd(), b.constBegin(), b.constEnd(), std::back_inserter(result));
+    return result;
+}
+}
+
+HistorySearchIndex::HistorySearchIndex()
+{
+}
+
+void HistorySearchIndex::rebuild(const QVector<HistoryEntry>& entries)
+{
+    m_documents.clear();
+    m_docIds.clear();
+    m_postings.clear();
+    m_unindexedDocs.clear();
+    m_typeIds.clear();
+
+    m_documents.reserve(entries.size());
+    m_docIds.reserve(entries.size());
+    for (const HistoryEntry& entry : entries) {
+        addDocument(entry);
+    }
+}
+
+void HistorySearchIndex::update(const HistoryEntry& entry)
+{
+    auto it = m_docIds.constFind(entry.id);
+    if (it != m_docIds.constEnd()) {
+        Document& document = m_documents[it.value()];
+        if (document.updateTime == entry.updateTime) {
+            return;
+        }
+        document.alive = false;
+    }
+    addDocument(entry);
+}
+
+void HistorySearchIndex::remove(const QString& recordId)
+{
+    auto it = m_docIds.find(recordId);
+    if (it != m_docIds.end()) {
+        m_documents[it.value()].alive = false;
+        m_docIds.erase(it);
+    }
+}
+
+QStringList HistorySearchIndex::search(const QString& text, const QString& type, const QString& date) const
+{
+    int typeId = -1;
+    if (!type.isEmpty()) {
+        typeId = typeIdOf(type);
+        if (typeId < 0) {
+            return QStringList();
+        }
+    }
+    const int day = date.isEmpty() ? 0 : dayOf(date);
+
+    // 所有查询词的倒排表求交集
+    const QStringList terms = queryTerms(text);
+    QVector<int> candidates;
+    for (int i = 0; i < terms.size(); ++i) {
+        QVector<int> postings = postingsForTerm(terms.at(i));
+        candidates = (i == 0) ? postings : intersect(candidates, postings);
+        if (candidates.isEmpty()) {
+            break;
+        }
+    }
+    if (!terms.isEmpty()) {
+        candidates = unite(candidates, m_unindexedDocs);
+    }
+
+    QVector<const Document*> matched;
+    auto accept = [&](const Document& document) {
+        if (document.alive && (typeId < 0 || document.typeId == typeId) && (day == 0 || document.day == day)) {
+            matched.append(&document);
+        }
+    };
+    if (terms.isEmpty()) {
+        for (const Document& document : m_documents) {
+            accept(document);
+        }
+    }
+    else {
+        for (int docId : qAsConst(candidates)) {
+            accept(m_documents.at(docId));
+        }
+    }
+
+    std::sort(matched.begin(), matched.end(), [](const Document* a, const Document* b) {
+        if (a->updateTime != b->updateTime) {
+            return a->updateTime > b->updateTime;
+        }
+        return a->recordId > b->recordId;
+    });
+
+    QStringList ids;
+    ids.reserve(matched.size());
+    for (const Document* document : qAsConst(matched)) {
+        ids.append(document->recordId);
+    }
+    return ids;
+}
+
+bool HistorySearchIndex::matches(const HistoryEntry& entry, const QStringList& terms)
+{
+    for (const QString& term : terms) {
+        if (!entry.title.contains(term, Qt::CaseInsensitive)
+            && !entry.result.contains(term, Qt::CaseInsensitive)
+            && !entry.content.contains(term, Qt::CaseInsensitive)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+QStringList HistorySearchIndex::queryTerms(const QString& text)
+{
+    return splitRuns(text);
+}
+
+int HistorySearchIndex::addDocument(const HistoryEntry& entry)
+{
+    const int docId = m_documents.size();
+
+    auto type = m_typeIds.constFind(entry.type);
+    if (type == m_typeIds.constEnd()) {
+        type = m_typeIds.insert(entry.type, m_typeIds.size());
+    }
+
+    Document document;
+    document.recordId = entry.id;
+    document.updateTime = entry.updateTime;
+    document.typeId = type.value();
+    document.day = dayOf(entry.updateTime);
+    document.alive = true;
+    m_documents.append(document);
+    m_docIds.insert(entry.id, docId);
+
+    if (entry.title.size() > kMaxIndexedLength || entry.content.size() > kMaxIndexedLength
+        || entry.result.size() > kMaxIndexedLength) {
+        m_unindexedDocs.append(docId);
+        return docId;
+    }
+
+    QSet<QString> tokens;
+    collectTokens(entry.title, tokens);
+    collectTokens(entry.content, tokens);
+    collectTokens(entry.result, tokens);
+    // 文档ID递增，直接追加即保持倒排表有序
+    for (const QString& token : qAsConst(tokens)) {
+        m_postings[token].append(docId);
+    }
+    return docId;
+}
+
+int HistorySearchIndex::typeIdOf(const QString& type) const
+{
+    return m_typeIds.value(type, -1);
+}
+
+QVector<int> HistorySearchIndex::postingsForTerm(const QString& term) const
+{
+    if (isCjk(term.at(0))) {
+        if (term.size() == 1) {
+            return m_postings.value(term);
+        }
+        // 多字查询：所有相邻两字都要出现，是否连续由 matches() 校验
+        QVector<int> result = m_postings.value(term.left(2));
+        for (int i = 1; i + 1 < term.size() && !result.isEmpty(); ++i) {
+            result = intersect(result, m_postings.value(term.mid(i, 2)));
+        }
+        return result;
+    }
+
+    // 单词按前缀匹配，合并所有以查询词开头的单词
+    QVector<int> result;
+    for (auto it = m_postings.lowerBound(term); it != m_postings.constEnd() && it.key().startsWith(term); ++it) {
+        result += it.value();
+    }
+    std::sort(result.begin(), result.end());
+    result.erase(std::unique(result.begin(), result.end()), result.end());
+    return result;
+}
+
+int HistorySearchIndex::dayOf(const QString& dateTime)
+{
+    // "yyyy-MM-dd ..." -> yyyyMMdd
+    QString date = dateTime.left(10);
+    date.remove('-');
+    return date.toInt();
+}
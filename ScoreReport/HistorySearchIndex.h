@@ -0,0 +1,87 @@
+﻿#ifndef HISTORYSEARCHINDEX_H
+#define HISTORYSEARCHINDEX_H
+
+#include <QString>
+#include <QStringList>
+#include <QVector>
+#include <QHash>
+#include <QMap>
+#include "HistoryStore.h"
+
+/**
+ * @brief 评测历史记录的本地倒排索引
+ *
+ * 对标题、内容和结果分词后建立倒排表：
+ * - 中日韩文字按单字和相邻两字（bigram）切分，单字查询查单字表，多字查询求所有bigram的交集
+ * - 其他字母数字按单词切分并转为小写，查询词按前缀匹配
+ * 类型和日期（updateTime 所在日）作为分面在候选集上过滤。
+ *
+ * 索引只负责缩小范围，返回的记录可能多于真正匹配的记录，
+ * 调用方需再用 matches() 逐条校验。单个字段超过 kMaxIndexedLength 的记录不分词，
+ * 每次查询都作为候选返回，避免超长内容撑大索引。
+ *
+ * 记录更新或删除时旧文档只标记为失效，重新加载时重建索引。
+ */
+class HistorySearchIndex
+{
+public:
+    HistorySearchIndex();
+
+    /// @brief 根据全部记录重建索引，可在后台线程调用
+    void rebuild(const QVector<HistoryEntry>& entries);
+
+    /**
+     * @brief 新增或更新一条记录
+     *
+     * 与已索引版本的 updateTime 相同时不做任何处理。
+     */
+    void update(const HistoryEntry& entry);
+
+    /// @brief 删除一条记录
+    void remove(const QString& recordId);
+
+    /**
+     * @brief 查询候选记录
+     * @param text 搜索文本，空字符串表示不按文本过滤
+     * @param type 记录类型，空字符串表示全部类型
+     * @param date 日期 "yyyy-MM-dd"，空字符串表示全部日期
+     * @return 候选记录ID，按 updateTime 从新到旧排列
+     */
+    QStringList search(const QString& text, const QString& type, const QString& date) const;
+
+    /**
+     * @brief 校验记录是否包含搜索文本中的所有查询词
+     * @param entry 记录
+     * @param terms queryTerms() 拆分出的查询词
+     */
+    static bool matches(const HistoryEntry& entry, const QStringList& terms);
+
+    /// @brief 把搜索文本拆分为查询词（中日韩连续文字或单词）
+    static QStringList queryTerms(const QString& text);
+
+    int documentCount() const { return m_docIds.size(); }
+
+private:
+    /// @brief 一个被索引的文档（一条记录的一个版本）
+    struct Document {
+        QString recordId;
+        QString updateTime;
+        int typeId;
+        int day;        ///< updateTime 所在日，如 20250726
+        bool alive;
+    };
+
+    int addDocument(const HistoryEntry& entry);
+    int typeIdOf(const QString& type) const;
+    QVector<int> postingsForTerm(const QString& term) const;
+
+    static int dayOf(const QString& dateTime);
+
+    QVector<Document> m_documents;              ///< 文档ID即下标，按索引顺序递增
+    QHash<QString, int> m_docIds;               ///< 记录ID -> 当前有效文档ID
+    QMap<QString, QVector<int>> m_postings;     ///< 词 -> 文档ID（升序）
+    QVector<int> m_unindexedDocs;               ///< 因内容过长未分词的文档ID（升序）
+    QHash<QString, int> m_typeIds;              ///< 记录类型 -> 类型ID
+};
+
+#endif // HISTORYSEARCHINDEX_H
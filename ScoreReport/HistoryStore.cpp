@@ -0,0 +1,265 @@
+﻿#include "HistoryStore.h"
+#include <QDir>
+#include <QFile>
+#include <QJsonDocument>
+#include <QSaveFile>
+#include <QDebug>
+#include <algorithm>
+
+namespace {
+/// @brief 本地记录保存目录
+const char* const kStoreDir = "AppData/cache/history/";
+
+/// @brief 过期行数超过该值且超过有效记录数时压缩文件
+const int kCompactThreshold = 1000;
+
+/// @brief 排序规则：updateTime 从新到旧，相同时按ID
+bool isNewer(const HistoryEntry& a, const HistoryEntry& b)
+{
+    if (a.updateTime != b.updateTime) {
+        return a.updateTime > b.updateTime;
+    }
+    return a.id > b.id;
+}
+}
+
+HistoryEntry HistoryEntry::fromJson(const QJsonObject& json)
+{
+    HistoryEntry entry;
+    entry.id = json.value("id").toString();
+    entry.userId = json.value("userId").toString();
+    entry.type = json.value("type").toString();
+    entry.title = json.value("title").toString();
+    entry.chatId = json.value("chatId").toString();
+    entry.content = json.value("content").toString();
+    entry.result = json.value("result").toString();
+    entry.createTime = json.value("createTime").toString();
+    entry.updateTime = json.value("updateTime").toString();
+    entry.isDelete = json.value("isDelete").toInt();
+    return entry;
+}
+
+QJsonObject HistoryEntry::toJson() const
+{
+    QJsonObject json;
+    json["id"] = id;
+    json["userId"] = userId;
+    json["type"] = type;
+    json["title"] = title;
+    json["chatId"] = chatId;
+    json["content"] = content;
+    json["result"] = result;
+    json["createTime"] = createTime;
+    json["updateTime"] = updateTime;
+    json["isDelete"] = isDelete;
+    return json;
+}
+
+HistoryStore::HistoryStore()
+    : m_lineCount(0)
+{
+}
+
+void HistoryStore::removeAll()
+{
+    QDir dir(kStoreDir);
+    const QStringList files = dir.entryList(QStringList() << "*.jsonl", QDir::Files);
+    for (const QString& fileName : files) {
+        dir.remove(fileName);
+    }
+}
+
+HistoryStore HistoryStore::load(const QString& userId)
+{
+    HistoryStore store;
+    store.m_userId = userId;
+    store.m_path = QString(kStoreDir) + userId + ".jsonl";
+
+    QFile file(store.m_path);
+    if (!file.open(QIODevice::ReadOnly)) {
+        return store;
+    }
+
+    // 后出现的行覆盖先出现的同ID行
+    QHash<QString, HistoryEntry> latest;
+    while (!file.atEnd()) {
+        QByteArray line = file.readLine().trimmed();
+        if (line.isEmpty()) {
+            continue;
+        }
+        ++store.m_lineCount;
+
+        QJsonObject json = QJsonDocument::fromJson(line).object();
+        HistoryEntry entry = HistoryEntry::fromJson(json);
+        if (entry.id.isEmpty()) {
+            continue;
+        }
+        if (entry.isDelete != 0) {
+            latest.remove(entry.id);
+        } else {
+            latest.insert(entry.id, entry);
+        }
+    }
+
+    store.m_entries.reserve(latest.size());
+    for (auto it = latest.constBegin(); it != latest.constEnd(); ++it) {
+        store.m_entries.append(it.value());
+        store.m_updateTimes.insert(it.key(), it->updateTime);
+    }
+    std::sort(store.m_entries.begin(), store.m_entries.end(), isNewer);
+
+    qDebug() << "[HistoryStore] Loaded" << store.m_entries.size() << "records from" << store.m_lineCount
+             << "lines for user" << userId;
+
+    if (store.m_lineCount - store.m_entries.size() > qMax(kCompactThreshold, store.m_entries.size())) {
+        store.compact();
+    }
+    return store;
+}
+
+QString HistoryStore::latestUpdateTime() const
+{
+    return m_entries.isEmpty() ? QString() : m_entries.first().updateTime;
+}
+
+int HistoryStore::upsert(const QVector<HistoryEntry>& entries)
+{
+    QList<QJsonObject> lines;
+    for (const HistoryEntry& entry : entries) {
+        if (entry.id.isEmpty()) {
+            continue;
+        }
+
+        if (entry.isDelete != 0) {
+            if (removeEntry(entry.id)) {
+                QJsonObject tombstone;
+                tombstone["id"] = entry.id;
+                tombstone["isDelete"] = 1;
+                lines.append(tombstone);
+            }
+            continue;
+        }
+
+        auto existing = m_updateTimes.constFind(entry.id);
+        if (existing != m_updateTimes.constEnd()) {
+            // 服务器每次修改都会更新 updateTime，时间相同说明记录未变化
+            if (existing.value() == entry.updateTime) {
+                continue;
+            }
+            removeEntry(entry.id);
+        }
+        insertSorted(entry);
+        lines.append(entry.toJson());
+    }
+
+    appendLines(lines);
+    return lines.size();
+}
+
+const HistoryEntry* HistoryStore::find(const QString& id) const
+{
+    int index = indexOf(id);
+    return index < 0 ? nullptr : &m_entries.at(index);
+}
+
+QStringList HistoryStore::retain(const QSet<QString>& ids)
+{
+    QStringList removed;
+    QList<QJsonObject> lines;
+    const QStringList localIds = m_updateTimes.keys();
+    for (const QString& id : localIds) {
+        if (!ids.contains(id) && removeEntry(id)) {
+            QJsonObject tombstone;
+            tombstone["id"] = id;
+            tombstone["isDelete"] = 1;
+            lines.append(tombstone);
+            removed.append(id);
+        }
+    }
+
+    appendLines(lines);
+    return removed;
+}
+
+int HistoryStore::indexOf(const QString& id) const
+{
+    auto it = m_updateTimes.constFind(id);
+    if (it == m_updateTimes.constEnd()) {
+        return -1;
+    }
+
+    HistoryEntry key;
+    key.id = id;
+    key.updateTime = it.value();
+    auto pos = std::lower_bound(m_entries.constBegin(), m_entries.constEnd(), key, isNewer);
+    if (pos == m_entries.constEnd() || pos->id != id) {
+        return -1;
+    }
+    return static_cast<int>(pos - m_entries.constBegin());
+}
+
+void HistoryStore::insertSorted(const HistoryEntry& entry)
+{
+    // 新记录通常最新，插入位置靠前
+    auto pos = std::lower_bound(m_entries.begin(), m_entries.end(), entry, isNewer);
+    m_entries.insert(pos, entry);
+    m_updateTimes.insert(entry.id, entry.updateTime);
+}
+
+bool HistoryStore::removeEntry(const QString& id)
+{
+    int index = indexOf(id);
+    if (index < 0) {
+        return false;
+    }
+    m_entries.remove(index);
+    m_updateTimes.remove(id);
+    return true;
+}
+
+void HistoryStore::appendLines(const QList<QJsonObject>& lines)
+{
+    if (lines.isEmpty() || m_path.isEmpty()) {
+        return;
+    }
+
+    QDir().mkpath(kStoreDir);
+    QFile file(m_path);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Append)) {
+        qWarning() << "[HistoryStore] Failed to open" << m_path << file.errorString();
+        return;
+    }
+
+    QByteArray data;
+    for (const QJsonObject& line : lines) {
+        data += QJsonDocument(line).toJson(QJsonDocument::Compact);
+        data += '\n';
+    }
+    file.write(data);
+    m_lineCount += lines.size();
+
+    if (m_lineCount - m_entries.size() > qMax(kCompactThreshold, m_entries.size())) {
+        file.close();
+        compact();
+    }
+}
+
+void HistoryStore::compact()
+{
+    QDir().mkpath(kStoreDir);
+    QSaveFile file(m_path);
+    if (!file.open(QIODevice::WriteOnly)) {
+        qWarning() << "[HistoryStore] Failed to compact" << m_path << file.errorString();
+        return;
+    }
+
+    // 从旧到新写入，与追加顺序一致
+    for (auto it = m_entries.crbegin(); it != m_entries.crend(); ++it) {
+        file.write(QJsonDocument(it->toJson()).toJson(QJsonDocument::Compact));
+        file.write("\n");
+    }
+    if (file.commit()) {
+        qDebug() << "[HistoryStore] Compacted" << m_path << "from" << m_lineCount << "to" << m_entries.size() << "lines";
+        m_lineCount = m_entries.size();
+    }
+}
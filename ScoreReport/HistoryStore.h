@@ -0,0 +1,105 @@
+﻿#ifndef HISTORYSTORE_H
+#define HISTORYSTORE_H
+
+#include <QString>
+#include <QStringList>
+#include <QVector>
+#include <QHash>
+#include <QSet>
+#include <QJsonObject>
+
+/**
+ * @brief 一条评测历史记录
+ *
+ * 时间字段保留服务器返回的 "yyyy-MM-dd HH:mm:ss" 字符串，按字符串比较即可得到先后顺序。
+ */
+struct HistoryEntry
+{
+    QString id;
+    QString userId;
+    QString type;
+    QString title;
+    QString chatId;
+    QString content;
+    QString result;
+    QString createTime;
+    QString updateTime;
+    int isDelete = 0;
+
+    /// @brief 从服务器返回的记录对象解析
+    static HistoryEntry fromJson(const QJsonObject& json);
+
+    /// @brief 转换为保存到本地文件的JSON对象
+    QJsonObject toJson() const;
+};
+
+/**
+ * @brief 评测历史记录本地存储
+ *
+ * 每个用户的全部记录保存在 AppData/cache/history/<用户ID>.jsonl，每行一条记录：
+ * - 新增或更新的记录追加到文件末尾，读取时后出现的行覆盖同ID的旧行
+ * - 删除的记录追加一行 {"id": ..., "isDelete": 1}
+ * - 过期的行超过有效记录数时重写文件压缩
+ *
+ * 内存中的记录按 updateTime 从新到旧排列。load() 可在后台线程调用，
+ * 返回的对象交给GUI线程使用，其余接口不是线程安全的。
+ */
+class HistoryStore
+{
+public:
+    HistoryStore();
+
+    /**
+     * @brief 读取指定用户的本地记录
+     * @param userId 用户ID
+     * @return 读取到的存储，文件不存在时为空存储
+     */
+    static HistoryStore load(const QString& userId);
+
+    /// @brief 删除所有用户的本地记录文件
+    static void removeAll();
+
+    /// @brief 所属用户ID，未加载时为空
+    QString userId() const { return m_userId; }
+
+    /// @brief 全部记录，按 updateTime 从新到旧排列
+    const QVector<HistoryEntry>& entries() const { return m_entries; }
+
+    int count() const { return m_entries.size(); }
+    bool contains(const QString& id) const { return m_updateTimes.contains(id); }
+
+    /// @brief 按ID查找记录，不存在时返回nullptr（记录变化后指针失效）
+    const HistoryEntry* find(const QString& id) const;
+
+    /// @brief 本地最新记录的 updateTime，增量同步以此为起点
+    QString latestUpdateTime() const;
+
+    /**
+     * @brief 写入服务器返回的记录（新增、更新或删除）
+     * @param entries 记录列表，isDelete 不为0的记录从本地删除
+     * @return 实际发生变化的记录数
+     */
+    int upsert(const QVector<HistoryEntry>& entries);
+
+    /**
+     * @brief 只保留指定ID的记录，全量同步后删除服务器上已不存在的记录
+     * @param ids 服务器上现有的记录ID
+     * @return 被删除的记录ID
+     */
+    QStringList retain(const QSet<QString>& ids);
+
+private:
+    int indexOf(const QString& id) const;
+    void insertSorted(const HistoryEntry& entry);
+    bool removeEntry(const QString& id);
+    void appendLines(const QList<QJsonObject>& lines);
+    void compact();
+
+    QString m_userId;
+    QString m_path;
+    QVector<HistoryEntry> m_entries;        ///< 按 updateTime 从新到旧排列
+    QHash<QString, QString> m_updateTimes;  ///< 记录ID -> updateTime，用于定位记录
+    int m_lineCount;                        ///< 文件中的行数（包括已被覆盖的行）
+};
+
+#endif // HISTORYSTORE_H
@@ -1,8 +1,12 @@
 ﻿#include "KnowledgeChatManager.h"
 #include "ApiManager.h"
 #include "LoginManager.h"
+#include "DocxReader.h"
+#include "ExtractedTextCache.h"
+#include "LogCategories.h"
 #include <QDateTime>
 #include <QDebug>
+#include <QElapsedTimer>
 #include <QDir>
 #include <QFileInfo>
 #include <QJsonDocument>
@@ -43,7 +47,8 @@ KnowledgeChatManager::KnowledgeChatManager(QObject* parent)
     , m_lastUserMessage("")
     , m_maxFileCount(DEFAULT_MAX_FILE_COUNT)
     , m_maxFileSize(DEFAULT_MAX_FILE_SIZE)
-    , m_updateTimer(new QTimer(this))
+    , m_messageModel(new ChatMessageModel(this))
+    , m_currentAiLength(0)
 {
     // 连接API管理器的信号
     auto* apiManager = GET_SINGLETON(ApiManager);
@@ -72,11 +77,6 @@ KnowledgeChatManager::KnowledgeChatManager(QObject* parent)
     setknowledgeBaseList(QVariantList());
     setselectedKnowledgeBases(QStringList());
     setretrievedMetadata(QVariantList());
-    
-    // 配置UI更新定时器
-    m_updateTimer->setInterval(30);  // 每30ms批量更新一次UI,平衡流畅度和性能
-    m_updateTimer->setSingleShot(true);
-    connect(m_updateTimer, &QTimer::timeout, this, &KnowledgeChatManager::flushPendingUpdates);
 }
 
 void KnowledgeChatManager::sendMessage(const QString& message)
@@ -104,7 +104,7 @@ void KnowledgeChatManager::sendMessage(const QString& message)
     // 设置发送状态
     setisSending(true);
     setisThinking(true);
-    m_currentAiMessage.clear();
+    m_currentAiLength = 0;
 
     // 清空之前的元数据
     setretrievedMetadata(QVariantList());
@@ -127,12 +127,8 @@ void KnowledgeChatManager::sendMessage(const QString& message)
 
 void KnowledgeChatManager::resetWithWelcomeMessage()
 {
-    // 停止定时器并清空缓冲区
-    m_updateTimer->stop();
-    m_pendingUpdateBuffer.clear();
-    
     // 清空消息列表
-    setmessages(QVariantList());
+    m_messageModel->clear();
     setknowledgeBaseList(QVariantList());
     setselectedKnowledgeBases(QStringList());
     setretrievedMetadata(QVariantList());
@@ -141,7 +137,7 @@ void KnowledgeChatManager::resetWithWelcomeMessage()
     setcurrentChatId(m_currentChatId);
 
     // 重置所有状态
-    m_currentAiMessage.clear();
+    m_currentAiLength = 0;
     setisSending(false);
     setisThinking(false);
     setlastUserMessage("");
@@ -157,14 +153,7 @@ void KnowledgeChatManager::regenerateLastResponse()
     }
 
     // 移除最后一条AI消息
-    QVariantList currentMessages = getmessages();
-    if (!currentMessages.isEmpty()) {
-        QVariantMap lastMessage = currentMessages.last().toMap();
-        if (lastMessage["type"].toString() == "ai") {
-            currentMessages.removeLast();
-            setmessages(currentMessages);
-        }
-    }
+    m_messageModel->removeLast("ai");
 
     // 重新发送最后一条消息
     QString lastMessage = getlastUserMessage();
@@ -172,7 +161,7 @@ void KnowledgeChatManager::regenerateLastResponse()
     // 设置状态
     setisSending(true);
     setisThinking(true);
-    m_currentAiMessage.clear();
+    m_currentAiLength = 0;
 
     addThinkingMessage();
 
@@ -194,9 +183,8 @@ void KnowledgeChatManager::endAnalysis(bool clearfile)
     // 中断当前聊天
     GET_SINGLETON(ApiManager)->abortStreamChatByChatId(m_currentChatId);
 
-    // 停止定时器并立即刷新待更新内容
-    m_updateTimer->stop();
-    flushPendingUpdates();
+    // 立即刷新待更新内容
+    m_messageModel->flushPending();
 
     // 取消所有文件上传（读取）任务（确保不在持锁状态下等待线程）
     if (clearfile) {
@@ -204,95 +192,41 @@ void KnowledgeChatManager::endAnalysis(bool clearfile)
     }
 
     // 重置状态
-    m_currentAiMessage.clear();
-    m_pendingUpdateBuffer.clear();
+    m_currentAiLength = 0;
     setisSending(false);
     setisThinking(false);
 
     // 替换思考消息为中断消息
-    QVariantList currentMessages = getmessages();
-    if (!currentMessages.isEmpty() && currentMessages.last().toMap()["type"] == "thinking") {
-        currentMessages.removeLast();
-
-        QVariantMap interruptMessage;
-        interruptMessage["type"] = "interrupt";
-        interruptMessage["content"] = QStringLiteral("消息已中断！");
-        interruptMessage["timestamp"] = QDateTime::currentDateTime().toString("hh:mm");
-        currentMessages.append(interruptMessage);
-
-        setmessages(currentMessages);
+    if (m_messageModel->removeLast("thinking")) {
+        m_messageModel->append("interrupt", QStringLiteral("消息已中断！"));
     }
 }
 
 void KnowledgeChatManager::addUserMessage(const QString& message)
 {
-    QVariantMap userMessage;
-    userMessage["type"] = "user";
-    userMessage["content"] = message;
-    userMessage["timestamp"] = QDateTime::currentDateTime().toString("hh:mm");
-
-    QVariantList currentMessages = getmessages();
-    currentMessages.append(userMessage);
-    setmessages(currentMessages);
+    m_messageModel->append("user", message);
 }
 
 void KnowledgeChatManager::addAiMessage(const QString& message)
 {
-    QVariantMap aiMessage;
-    aiMessage["type"] = "ai";
-    aiMessage["content"] = message;
-    aiMessage["timestamp"] = QDateTime::currentDateTime().toString("hh:mm");
-
-    QVariantList currentMessages = getmessages();
-    currentMessages.append(aiMessage);
-    setmessages(currentMessages);
+    m_messageModel->append("ai", message);
 }
 
 void KnowledgeChatManager::addThinkingMessage()
 {
-    QVariantMap thinkingMessage;
-    thinkingMessage["type"] = "thinking";
-    thinkingMessage["content"] = getselectedKnowledgeBases().isEmpty() ? QStringLiteral("思考中") : QStringLiteral("查询中");
-    thinkingMessage["timestamp"] = QDateTime::currentDateTime().toString("hh:mm");
-
-    QVariantList currentMessages = getmessages();
-    currentMessages.append(thinkingMessage);
-    setmessages(currentMessages);
+    m_messageModel->append("thinking", getselectedKnowledgeBases().isEmpty() ? QStringLiteral("思考中") : QStringLiteral("查询中"));
 }
 
 void KnowledgeChatManager::removeThinkingMessage()
 {
-    QVariantList currentMessages = getmessages();
-
     // 从后往前查找并移除思考中消息
-    for (int i = currentMessages.size() - 1; i >= 0; i--) {
-        QVariantMap message = currentMessages[i].toMap();
-        if (message["type"].toString() == "thinking") {
-            currentMessages.removeAt(i);
-            setmessages(currentMessages);
-            break;
-        }
-    }
+    m_messageModel->removeLastOfType("thinking");
 }
 
 void KnowledgeChatManager::updateLastAiMessage(const QString& additionalText)
 {
-    QVariantList currentMessages = getmessages();
-    if (currentMessages.isEmpty()) {
-        return;
-    }
-
-    QVariantMap lastMessage = currentMessages.last().toMap();
-    if (lastMessage["type"].toString() == "ai") {
-        // 追加内容
-        QString currentContent = lastMessage["content"].toString();
-        lastMessage["content"] = currentContent + additionalText;
-
-        // 更新消息列表
-        currentMessages.removeLast();
-        currentMessages.append(lastMessage);
-        setmessages(currentMessages);
-    }
+    // 原地追加到最后一条AI消息，按渲染帧合并后只刷新这一行
+    m_messageModel->appendToLastDeferred("ai", additionalText);
 }
 
 QString KnowledgeChatManager::buildMessageWithFiles(const QString& userMessage, const QVariantList& files)
@@ -362,16 +296,16 @@ void KnowledgeChatManager::onStreamChatResponse(const QString& data, const QStri
         return;
     }
 
-    if (m_currentAiMessage.isEmpty()) {
+    if (m_currentAiLength == 0) {
         // 第一次接收响应：移除思考状态
         setisThinking(false);
         removeThinkingMessage();
         addAiMessage(data);
-        m_currentAiMessage = data;
+        m_currentAiLength += data.size();
     }
     else {
-        // 追加响应内容
-        m_currentAiMessage += data;
+        // 追加响应内容，按渲染帧合并刷新
+        m_currentAiLength += data.size();
         updateLastAiMessage(data);
     }
 }
@@ -383,7 +317,10 @@ void KnowledgeChatManager::onStreamChatFinished(bool success, const QString& mes
         return;
     }
 
-    qDebug() << "[KnowledgeChatManager] Chat finished, success:" << success;
+    LOG_DEBUG(lcStream) << "[KnowledgeChatManager] Chat finished, success:" << success;
+
+    // 立即刷新所有待更新的内容
+    m_messageModel->flushPending();
 
     // 重置状态
     setisSending(false);
@@ -396,12 +333,12 @@ void KnowledgeChatManager::onStreamChatFinished(bool success, const QString& mes
     }
 
     // 处理空响应
-    if (m_currentAiMessage.isEmpty()) {
+    if (m_currentAiLength == 0) {
         removeThinkingMessage();
         addAiMessage(QStringLiteral("抱歉，我无法回复您的消息。"));
     }
 
-    m_currentAiMessage.clear();
+    m_currentAiLength = 0;
 }
 
 bool KnowledgeChatManager::addFile(const QString& filePath)
@@ -465,7 +402,7 @@ int KnowledgeChatManager::addFiles(const QStringList& filePaths)
         }
     }
 
-    qDebug() << "[KnowledgeChatManager] Batch add files: added" << addedCount << "skipped" << skipCount;
+    LOG_DEBUG(lcFile) << "[KnowledgeChatManager] Batch add files: added" << addedCount << "skipped" << skipCount;
     return addedCount;
 }
 
@@ -494,7 +431,7 @@ bool KnowledgeChatManager::removeFile(int index)
 
     emit fileOperationResult(QStringLiteral("文件已移除！"), "warning");
 
-    qDebug() << "[KnowledgeChatManager] File removed at index:" << index;
+    LOG_DEBUG(lcFile) << "[KnowledgeChatManager] File removed at index:" << index;
     return true;
 }
 
@@ -598,7 +535,7 @@ QString KnowledgeChatManager::readFileContent(const QString& filePath)
     QFileInfo fileInfo(filePath);
 
     if (!fileInfo.exists() || !fileInfo.isFile()) {
-        qDebug() << "[KnowledgeChatManager] File does not exist:" << filePath;
+        LOG_DEBUG(lcFile) << "[KnowledgeChatManager] File does not exist:" << filePath;
         return QString();
     }
 
@@ -616,7 +553,7 @@ QString KnowledgeChatManager::readFileContent(const QString& filePath)
             return content;
         }
         else {
-            qDebug() << "[KnowledgeChatManager] Failed to open txt file:" << filePath;
+            LOG_DEBUG(lcFile) << "[KnowledgeChatManager] Failed to open txt file:" << filePath;
             return QString();
         }
     }
@@ -637,7 +574,14 @@ QString KnowledgeChatManager::readFileContent(const QString& filePath)
 
 QString KnowledgeChatManager::readDocxContent(const QString& filePath)
 {
-    return readWordDocumentWithPowerShell(filePath, QStringLiteral("DOCX文档: %1 - 内容读取需要Microsoft Word"));
+    // DOCX直接解析压缩包中的 word/document.xml，不需要启动Word
+    DocxReader reader;
+    if (reader.read(filePath) && !reader.text().isEmpty()) {
+        return reader.text();
+    }
+
+    LOG_DEBUG(lcFile) << "[KnowledgeChatManager] DOCX read failed:" << reader.errorString();
+    return QStringLiteral("[DOCX文档: %1 - 内容读取失败]").arg(QFileInfo(filePath).fileName());
 }
 
 QString KnowledgeChatManager::readDocContent(const QString& filePath)
@@ -670,29 +614,13 @@ QString KnowledgeChatManager::readWordDocumentWithPowerShell(const QString& file
         }
     }
 
-    qDebug() << "[KnowledgeChatManager] PowerShell method failed for" << fileInfo.suffix();
+    LOG_DEBUG(lcFile) << "[KnowledgeChatManager] PowerShell method failed for" << fileInfo.suffix();
     return QStringLiteral("[%1]").arg(fallbackMessage.arg(fileInfo.fileName()));
 }
 
-QString KnowledgeChatManager::extractTextFromXml(const QString& xmlContent)
-{
-    QXmlStreamReader xml(xmlContent);
-    QString text;
-
-    while (!xml.atEnd()) {
-        xml.readNext();
-        if (xml.isCharacters()) {
-            text += xml.text().toString();
-        }
-    }
-
-    return text.simplified();
-}
-
-
 // FileReaderThread
 FileReaderThread1::FileReaderThread1(const QString& filePath, const QString& fileName, QObject* parent)
-    : QThread(parent), m_filePath(filePath), m_fileName(fileName)
+    : QThread(parent), m_filePath(filePath), m_fileName(fileName), m_extracted(false)
 {
 }
 
@@ -718,6 +646,15 @@ void FileReaderThread1::run()
         emitProgress(10);
 
         QString extension = fileInfo.suffix().toLower();
+        const bool cacheable = (extension == "docx" || extension == "doc");
+        ExtractedTextCache* cache = GET_SINGLETON(ExtractedTextCache);
+
+        // 同一份文档之前提取过时直接使用缓存的文本
+        if (cacheable && cache->lookup(m_filePath, content)) {
+            emitProgress(100);
+            emit readCompleted(m_filePath, content, true, QString());
+            return;
+        }
 
         // 根据文件类型读取
         if (extension == "txt") {
@@ -746,6 +683,11 @@ void FileReaderThread1::run()
             return;
         }
 
+        // 只缓存真正提取出的文本，读取失败时的占位提示不缓存
+        if (cacheable && m_extracted) {
+            cache->store(m_filePath, content);
+        }
+
         emitProgress(100);
 
         if (!success && errorMessage.isEmpty()) {
@@ -786,7 +728,27 @@ QString FileReaderThread1::readTextFile(const QString& filePath)
 
 QString FileReaderThread1::readDocxFile(const QString& filePath)
 {
-    return readWordFileWithProgress(filePath, QStringLiteral("DOCX文档: %1 - 内容读取需要Microsoft Word"));
+    emitProgress(30);
+    if (isInterruptionRequested()) return QString();
+
+    QElapsedTimer timer;
+    timer.start();
+
+    DocxReader reader;
+    reader.setCancelCheck([this]() { return isInterruptionRequested(); });
+    bool ok = reader.read(filePath);
+    if (isInterruptionRequested()) return QString();
+
+    emitProgress(90);
+
+    if (!ok || reader.text().isEmpty()) {
+        LOG_DEBUG(lcFile) << "[FileReaderThread1] DOCX read failed:" << reader.errorString();
+        return QStringLiteral("[DOCX文档: %1 - 内容读取失败]").arg(QFileInfo(filePath).fileName());
+    }
+
+    LOG_DEBUG(lcFile) << "[FileReaderThread1] DOCX read in" << timer.elapsed() << "ms, chars:" << reader.text().size();
+    m_extracted = true;
+    return reader.text();
 }
 
 QString FileReaderThread1::readDocFile(const QString& filePath)
@@ -834,6 +796,7 @@ QString FileReaderThread1::readWordFileWithProgress(const QString& filePath, con
     if (process.exitCode() == 0) {
         QString content = QString::fromUtf8(process.readAllStandardOutput()).trimmed();
         if (!content.isEmpty()) {
+            m_extracted = true;
             return content;
         }
     }
@@ -901,7 +864,7 @@ void KnowledgeChatManager::startFileReadTask(const QString& filePath, const QStr
     // 启动线程
     thread->start();
 
-    qDebug() << "[KnowledgeChatManager] Started file read task for:" << fileName;
+    LOG_DEBUG(lcFile) << "[KnowledgeChatManager] Started file read task for:" << fileName;
 }
 
 void KnowledgeChatManager::cleanupFileReadTask(const QString& filePath)
@@ -955,7 +918,8 @@ void KnowledgeChatManager::cleanupAllFileReadTasks()
         for (const QString& filePath : filePaths) {
             QFileInfo fileInfo(filePath);
             QString extension = fileInfo.suffix().toLower();
-            if (extension == "doc" || extension == "docx") {
+            // 只有 .doc 经由Word自动化读取，.docx 由 DocxReader 直接解析，不会留下WINWORD进程
+            if (extension == "doc") {
                 hasWordDocs = true;
                 break;
             }
@@ -971,7 +935,7 @@ void KnowledgeChatManager::cleanupAllFileReadTasks()
 
     // 如果有Word文档任务被清理，启动延迟Word进程清理
     if (hasWordDocs) {
-        qDebug() << "[KnowledgeChatManager] Word document tasks were cleaned up, starting delayed Word process cleanup";
+        LOG_DEBUG(lcFile) << "[KnowledgeChatManager] Word document tasks were cleaned up, starting delayed Word process cleanup";
         startDelayedWordProcessCleanup();
     }
 }
@@ -1021,10 +985,10 @@ void KnowledgeChatManager::onFileReadCompleted(const QString& filePath, const QS
         // 存储文件内容（如果未被取消）
         if (success && !content.isEmpty()) {
             m_fileContents[filePath] = content;
-            qDebug() << "[KnowledgeChatManager] File content stored for:" << filePath;
+            LOG_DEBUG(lcFile) << "[KnowledgeChatManager] File content stored for:" << filePath;
         }
         else {
-            qDebug() << "[KnowledgeChatManager] File read finished with status:" << (success ? "success" : "failed") << filePath << errorMessage;
+            LOG_DEBUG(lcFile) << "[KnowledgeChatManager] File read finished with status:" << (success ? "success" : "failed") << filePath << errorMessage;
         }
 
         // 清理任务
@@ -1078,12 +1042,12 @@ void KnowledgeChatManager::startDelayedWordProcessCleanup()
 
         // 执行多次清理确保所有进程都被清除
         for (int attempt = 1; attempt <= 3; ++attempt) {
-            qDebug() << "[KnowledgeChatManager] Word cleanup attempt" << attempt << "of 3";
+            LOG_DEBUG(lcFile) << "[KnowledgeChatManager] Word cleanup attempt" << attempt << "of 3";
 
             int processCount = cleanupHangingWordProcesses();
 
             if (processCount == 0) {
-                qDebug() << "[KnowledgeChatManager] No more Word processes to clean, stopping";
+                LOG_DEBUG(lcFile) << "[KnowledgeChatManager] No more Word processes to clean, stopping";
                 break;
             }
 
@@ -1093,7 +1057,7 @@ void KnowledgeChatManager::startDelayedWordProcessCleanup()
             }
         }
 
-        qDebug() << "[KnowledgeChatManager] Delayed Word process cleanup completed";
+        LOG_DEBUG(lcFile) << "[KnowledgeChatManager] Delayed Word process cleanup completed";
         });
 }
 
@@ -1137,7 +1101,7 @@ int KnowledgeChatManager::cleanupHangingWordProcesses()
         QString errorOutput = QString::fromUtf8(process.readAllStandardError());
 
         if (!output.trimmed().isEmpty()) {
-            qDebug() << "[KnowledgeChatManager] Word cleanup output:" << output;
+            LOG_DEBUG(lcFile) << "[KnowledgeChatManager] Word cleanup output:" << output;
 
             // 提取清理的进程数量
             QRegularExpression re("PROCESS_COUNT:(\\d+)");
@@ -1148,18 +1112,18 @@ int KnowledgeChatManager::cleanupHangingWordProcesses()
         }
 
         if (!errorOutput.trimmed().isEmpty()) {
-            qDebug() << "[KnowledgeChatManager] Word cleanup errors:" << errorOutput;
+            LOG_DEBUG(lcFile) << "[KnowledgeChatManager] Word cleanup errors:" << errorOutput;
         }
 
         if (process.exitCode() == 0) {
-            qDebug() << "[KnowledgeChatManager] Word process cleanup completed successfully, cleaned" << cleanedProcessCount << "processes";
+            LOG_DEBUG(lcFile) << "[KnowledgeChatManager] Word process cleanup completed successfully, cleaned" << cleanedProcessCount << "processes";
         }
         else {
-            qDebug() << "[KnowledgeChatManager] Word process cleanup completed with exit code:" << process.exitCode();
+            LOG_DEBUG(lcFile) << "[KnowledgeChatManager] Word process cleanup completed with exit code:" << process.exitCode();
         }
     }
     else {
-        qDebug() << "[KnowledgeChatManager] Word process cleanup timed out";
+        LOG_DEBUG(lcFile) << "[KnowledgeChatManager] Word process cleanup timed out";
         process.kill(); // 强制终止PowerShell进程
     }
 
@@ -1170,7 +1134,7 @@ void KnowledgeChatManager::loadKnowledgeBaseList()
 {
     auto* apiManager = GET_SINGLETON(ApiManager);
     apiManager->getKnowledgeBaseList();
-    qDebug() << "[KnowledgeChatManager] Loading knowledge base list";
+    LOG_DEBUG(lcUi) << "[KnowledgeChatManager] Loading knowledge base list";
 }
 
 void KnowledgeChatManager::clearKnowledgeBaseList()
@@ -1180,7 +1144,7 @@ void KnowledgeChatManager::clearKnowledgeBaseList()
 
 void KnowledgeChatManager::onKnowledgeBaseListResponse(bool success, const QString& message, const QJsonObject& data)
 {
-    qDebug() << "[KnowledgeChatManager] Knowledge base list response - success:" << success << "message:" << message;
+    LOG_DEBUG(lcUi) << "[KnowledgeChatManager] Knowledge base list response - success:" << success << "message:" << message;
 
     if (success && data.contains("records")) {
         QJsonArray records = data["records"].toArray();
@@ -1201,10 +1165,10 @@ void KnowledgeChatManager::onKnowledgeBaseListResponse(bool success, const QStri
         }
 
         setknowledgeBaseList(knowledgeList);
-        qDebug() << "[KnowledgeChatManager] Successfully loaded" << knowledgeList.size() << "knowledge bases";
+        LOG_DEBUG(lcUi) << "[KnowledgeChatManager] Successfully loaded" << knowledgeList.size() << "knowledge bases";
     }
     else {
-        qDebug() << "[KnowledgeChatManager] Failed to load knowledge base list:" << message;
+        LOG_DEBUG(lcUi) << "[KnowledgeChatManager] Failed to load knowledge base list:" << message;
         setknowledgeBaseList(QVariantList()); // 清空列表
     }
 }
@@ -1216,23 +1180,17 @@ void KnowledgeChatManager::onStreamKnowledgeChatResponse(const QString& data, co
         return;
     }
 
-    if (m_currentAiMessage.isEmpty()) {
+    if (m_currentAiLength == 0) {
         // 第一次接收响应：移除思考状态
         setisThinking(false);
         removeThinkingMessage();
         addAiMessage(data);
-        m_currentAiMessage = data;
-        m_pendingUpdateBuffer.clear();  // 清空缓冲区
+        m_currentAiLength += data.size();
     }
     else {
-        // 将新数据放入缓冲区
-        m_pendingUpdateBuffer += data;
-        m_currentAiMessage += data;
-        
-        // 启动或重启定时器(单次触发模式会自动重置)
-        if (!m_updateTimer->isActive()) {
-            m_updateTimer->start();
-        }
+        // 将新数据放入缓冲区，按渲染帧合并刷新
+        m_currentAiLength += data.size();
+        updateLastAiMessage(data);
     }
 }
 
@@ -1243,11 +1201,10 @@ void KnowledgeChatManager::onStreamKnowledgeChatFinished(bool success, const QSt
         return;
     }
 
-    qDebug() << "[KnowledgeChatManager] Knowledge chat finished, success:" << success;
+    LOG_DEBUG(lcStream) << "[KnowledgeChatManager] Knowledge chat finished, success:" << success;
 
-    // 停止定时器并立即刷新所有待更新的内容
-    m_updateTimer->stop();
-    flushPendingUpdates();
+    // 立即刷新所有待更新的内容
+    m_messageModel->flushPending();
 
     // 重置状态
     setisSending(false);
@@ -1260,13 +1217,12 @@ void KnowledgeChatManager::onStreamKnowledgeChatFinished(bool success, const QSt
     }
 
     // 处理空响应
-    if (m_currentAiMessage.isEmpty()) {
+    if (m_currentAiLength == 0) {
         removeThinkingMessage();
         addAiMessage(QStringLiteral("抱歉，我无法回复您的消息。"));
     }
 
-    m_currentAiMessage.clear();
-    m_pendingUpdateBuffer.clear();
+    m_currentAiLength = 0;
 }
 
 QStringList KnowledgeChatManager::getSelectedBuckets() const
@@ -1301,23 +1257,14 @@ void KnowledgeChatManager::onKnowledgeChatMetadataReceived(const QString& chatId
     // 存储检索到的元数据
     setretrievedMetadata(retrievedMetadata);
 
-    qDebug() << "[KnowledgeChatManager] Retrieved metadata received for chat:" << chatId
+    LOG_DEBUG(lcStream) << "[KnowledgeChatManager] Retrieved metadata received for chat:" << chatId
         << "Items count:" << retrievedMetadata.size();
 
     // 打印详细元数据信息（调试用）
     for (int i = 0; i < retrievedMetadata.size(); ++i) {
         QVariantMap metaMap = retrievedMetadata[i].toMap();
-        qDebug() << "  [" << i << "] File:" << metaMap["file_name"].toString()
+        LOG_DEBUG(lcStream) << "  [" << i << "] File:" << metaMap["file_name"].toString()
             << "Pages:" << metaMap["page_numbers"].toList()
             << "Retriever:" << metaMap["retriever_name"].toString();
     }
-}
-
-void KnowledgeChatManager::flushPendingUpdates()
-{
-    // 如果缓冲区有待更新的内容,批量更新UI
-    if (!m_pendingUpdateBuffer.isEmpty()) {
-        updateLastAiMessage(m_pendingUpdateBuffer);
-        m_pendingUpdateBuffer.clear();
-    }
 }
\ No newline at end of file
@@ -0,0 +1,135 @@
+﻿#include "KnowledgeFileLedger.h"
+#include <QCryptographicHash>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QSaveFile>
+#include <QVariantMap>
+#include <QDebug>
+
+namespace {
+/// @brief 记录文件保存目录
+const char* const kLedgerDir = "AppData/cache/upload/";
+
+/// @brief 记录文件路径
+const char* const kLedgerPath = "AppData/cache/upload/ledger.json";
+
+/// @brief 计算哈希时的读取块大小
+const qint64 kHashChunkSize = 256 * 1024;
+}
+
+KnowledgeFileLedger::KnowledgeFileLedger()
+{
+    load();
+}
+
+QString KnowledgeFileLedger::hashFile(const QString& filePath)
+{
+    QFile file(filePath);
+    if (!file.open(QIODevice::ReadOnly)) {
+        qWarning() << "[KnowledgeFileLedger] Cannot open file for hashing:" << filePath;
+        return QString();
+    }
+
+    QCryptographicHash hash(QCryptographicHash::Sha256);
+    while (!file.atEnd()) {
+        QByteArray chunk = file.read(kHashChunkSize);
+        if (chunk.isEmpty()) {
+            qWarning() << "[KnowledgeFileLedger] Failed to read file:" << filePath << file.errorString();
+            return QString();
+        }
+        hash.addData(chunk);
+    }
+    return QString::fromLatin1(hash.result().toHex());
+}
+
+QString KnowledgeFileLedger::findDuplicate(const QString& knowledgeBaseId, const QString& filePath, const QString& sha256,
+                                           const QVariantList& serverFiles) const
+{
+    QFileInfo info(filePath);
+    const QHash<QString, Entry> uploaded = m_entries.value(knowledgeBaseId);
+    const auto recorded = uploaded.constFind(sha256);
+
+    for (const QVariant& item : serverFiles) {
+        const QVariantMap file = item.toMap();
+        const QString fileName = file.value("fileName").toString();
+        const qint64 fileSize = file.value("fileSize").toLongLong();
+        const QString fileHash = file.value("fileHash").toString();
+
+        if (!sha256.isEmpty() && fileHash.compare(sha256, Qt::CaseInsensitive) == 0) {
+            return fileName;
+        }
+        if (recorded != uploaded.constEnd() && recorded->fileName == fileName && recorded->fileSize == fileSize) {
+            return fileName;
+        }
+        if (fileName == info.fileName() && fileSize == info.size()) {
+            return fileName;
+        }
+    }
+    return QString();
+}
+
+void KnowledgeFileLedger::record(const QString& knowledgeBaseId, const QString& sha256, const QString& fileName,
+                                 qint64 fileSize)
+{
+    if (knowledgeBaseId.isEmpty() || sha256.isEmpty()) {
+        return;
+    }
+
+    Entry entry;
+    entry.fileName = fileName;
+    entry.fileSize = fileSize;
+    m_entries[knowledgeBaseId].insert(sha256, entry);
+    save();
+}
+
+void KnowledgeFileLedger::clear()
+{
+    m_entries.clear();
+    QFile::remove(kLedgerPath);
+}
+
+void KnowledgeFileLedger::load()
+{
+    QFile file(kLedgerPath);
+    if (!file.open(QIODevice::ReadOnly)) {
+        return;
+    }
+
+    QJsonObject root = QJsonDocument::fromJson(file.readAll()).object();
+    for (auto kb = root.constBegin(); kb != root.constEnd(); ++kb) {
+        QJsonObject files = kb.value().toObject();
+        QHash<QString, Entry>& entries = m_entries[kb.key()];
+        for (auto it = files.constBegin(); it != files.constEnd(); ++it) {
+            QJsonObject obj = it.value().toObject();
+            Entry entry;
+            entry.fileName = obj.value("fileName").toString();
+            entry.fileSize = static_cast<qint64>(obj.value("fileSize").toDouble());
+            entries.insert(it.key(), entry);
+        }
+    }
+}
+
+void KnowledgeFileLedger::save() const
+{
+    QJsonObject root;
+    for (auto kb = m_entries.constBegin(); kb != m_entries.constEnd(); ++kb) {
+        QJsonObject files;
+        for (auto it = kb.value().constBegin(); it != kb.value().constEnd(); ++it) {
+            QJsonObject obj;
+            obj["fileName"] = it->fileName;
+            obj["fileSize"] = it->fileSize;
+            files[it.key()] = obj;
+        }
+        root[kb.key()] = files;
+    }
+
+    QDir().mkpath(kLedgerDir);
+    QSaveFile file(kLedgerPath);
+    if (file.open(QIODevice::WriteOnly)) {
+        file.write(QJsonDocument(root).toJson(QJsonDocument::Compact));
+        file.commit();
+    }
+}
@@ -0,0 +1,67 @@
+﻿#ifndef KNOWLEDGEFILELEDGER_H
+#define KNOWLEDGEFILELEDGER_H
+
+#include <QString>
+#include <QHash>
+#include <QVariantList>
+
+/**
+ * @brief 知识库文件内容记录 - 上传前查重
+ *
+ * 知识库详情接口返回的文件列表只有文件名和大小，没有内容哈希，
+ * 因此本地记录每个成功上传文件的 SHA-256，保存在 AppData/cache/upload/ledger.json：
+ * - 内容哈希与记录一致，且该记录对应的文件（按文件名 + 大小）仍在知识库中时视为重复
+ * - 服务器文件列表带有 fileHash 字段时直接按哈希比较
+ * - 文件名和大小都与知识库中已有文件相同时也视为重复
+ *
+ * hashFile() 可在任意线程调用，其余接口只在GUI线程使用。
+ */
+class KnowledgeFileLedger
+{
+public:
+    KnowledgeFileLedger();
+
+    /**
+     * @brief 流式计算文件内容的SHA-256
+     * @param filePath 文件路径
+     * @return 十六进制哈希，文件无法读取时返回空字符串
+     */
+    static QString hashFile(const QString& filePath);
+
+    /**
+     * @brief 查找知识库中与本地文件重复的文件
+     * @param knowledgeBaseId 知识库ID
+     * @param filePath 本地文件路径
+     * @param sha256 本地文件内容哈希
+     * @param serverFiles 知识库详情中的文件列表（fileName / fileSize / fileHash）
+     * @return 重复时返回知识库中已有文件的名称，否则返回空字符串
+     */
+    QString findDuplicate(const QString& knowledgeBaseId, const QString& filePath, const QString& sha256,
+                          const QVariantList& serverFiles) const;
+
+    /**
+     * @brief 记录一个成功上传的文件
+     * @param knowledgeBaseId 知识库ID
+     * @param sha256 文件内容哈希
+     * @param fileName 上传后的文件名
+     * @param fileSize 文件大小
+     */
+    void record(const QString& knowledgeBaseId, const QString& sha256, const QString& fileName, qint64 fileSize);
+
+    /// @brief 清空全部上传记录并删除记录文件
+    void clear();
+
+private:
+    /// @brief 一条上传记录
+    struct Entry {
+        QString fileName;
+        qint64 fileSize;
+    };
+
+    void load();
+    void save() const;
+
+    QHash<QString, QHash<QString, Entry>> m_entries;   ///< 知识库ID -> (内容哈希 -> 上传记录)
+};
+
+#endif // KNOWLEDGEFILELEDGER_H
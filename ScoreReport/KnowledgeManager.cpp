@@ -1,9 +1,13 @@
 ﻿#include "KnowledgeManager.h"
 #include "ApiManager.h"
 #include "LoginManager.h"
+#include "KnowledgeUploadQueue.h"
 #include <QJsonArray>
 #include <QJsonObject>
 #include <QVariantMap>
+#include <QFileInfo>
+#include <QFutureWatcher>
+#include <QtConcurrent/QtConcurrent>
 #include <QDebug>
 
 /**
@@ -14,20 +18,21 @@
  */
 KnowledgeManager::KnowledgeManager(QObject* parent)
     : QObject(parent)
+    , m_uploadConcurrency(3)
+    , m_uploadQueue(new KnowledgeUploadQueue(this))
 {
     setisLoading(false);
     setknowledgeList(QVariantList());
     setisLoadingDetail(false);
     setcurrentKnowledgeDetail(QVariantMap());
     setexpandedKnowledgeId(QString());
+    setisCheckingDuplicates(false);
 
     // 连接ApiManager的响应信号
     connect(GET_SINGLETON(ApiManager), &ApiManager::getKnowledgeBaseListResponse,
         this, &KnowledgeManager::onKnowledgeBaseListResponse);
     connect(GET_SINGLETON(ApiManager), &ApiManager::getKnowledgeBaseResponse,
         this, &KnowledgeManager::onKnowledgeBaseDetailResponse);
-    connect(GET_SINGLETON(ApiManager), &ApiManager::uploadFileResponse,
-        this, &KnowledgeManager::onFileUploadResponse);
     connect(GET_SINGLETON(ApiManager), &ApiManager::deleteKnowledgeBaseFilesResponse,
         this, &KnowledgeManager::onFileDeleteResponse);
     connect(GET_SINGLETON(ApiManager), &ApiManager::createKnowledgeBaseResponse,
@@ -36,6 +41,19 @@ KnowledgeManager::KnowledgeManager(QObject* parent)
         this, &KnowledgeManager::onDeleteKnowledgeBaseResponse);
     connect(GET_SINGLETON(ApiManager), &ApiManager::updateKnowledgeBaseResponse,
         this, &KnowledgeManager::onUpdateKnowledgeBaseResponse);
+
+    // 上传队列按上传ID返回每个文件的进度和结果
+    m_uploadQueue->setMaxConcurrent(m_uploadConcurrency);
+    connect(this, &KnowledgeManager::uploadConcurrencyChanged, this, [this]() {
+        m_uploadQueue->setMaxConcurrent(m_uploadConcurrency);
+    });
+    connect(m_uploadQueue, &KnowledgeUploadQueue::uploadProgress, this,
+        [this](const QString& uploadId, const QString& filePath, qint64 bytesSent, qint64 bytesTotal) {
+            Q_UNUSED(uploadId);
+            emit uploadProgress(filePath, bytesSent, bytesTotal);
+        });
+    connect(m_uploadQueue, &KnowledgeUploadQueue::uploadFinished,
+        this, &KnowledgeManager::onUploadFinished);
 }
 
 /**
@@ -180,6 +198,7 @@ void KnowledgeManager::onKnowledgeBaseDetailResponse(bool success, const QString
                 fileItem["knowledgeBaseId"] = file["knowledgeBaseId"].toString();  // 改为字符串格式
                 fileItem["fileName"] = file["fileName"].toString();
                 fileItem["fileSize"] = file["fileSize"].toString().toLong();
+                fileItem["fileHash"] = file["fileHash"].toString();  // 服务器未返回时为空
                 fileItem["fileType"] = file["fileType"].toString();
                 fileItem["status"] = file["status"].toString();
                 fileItem["fileUrl"] = file["fileUrl"].toString();
@@ -229,8 +248,9 @@ void KnowledgeManager::uploadFileToCurrentKnowledge(const QString& filePath)
         return;
     }
 
-    // 调用ApiManager上传文件
-    GET_SINGLETON(ApiManager)->uploadFileToKnowledgeBase(filePath, currentKnowledgeId, userId);
+    // 单个文件优先于排队中的批量文件上传
+    m_singleUploadIds.insert(m_uploadQueue->enqueue(filePath, currentKnowledgeId, userId,
+                                                    KnowledgeUploadQueue::HighPriority));
 
     qDebug() << "[KnowledgeManager] Uploading file:" << filePath
         << "to knowledge base:" << currentKnowledgeId;
@@ -240,7 +260,10 @@ void KnowledgeManager::uploadFileToCurrentKnowledge(const QString& filePath)
  * @brief 批量上传文件到当前展开的知识库
  * @param filePaths 要上传的文件路径列表
  *
- * 将多个文件逐个上传到当前展开的知识库中，通过计数器跟踪上传进度。
+ * 先在后台线程流式计算每个文件的SHA-256，与知识库中已有的文件比较后，
+ * 只把新文件加入上传队列，队列限制同时上传的数量并在网络失败时重试；
+ * 每个文件的结果按上传ID记录，所有文件结束后发出 batchUploadCompleted。
+ * 上一批尚未结束时新文件并入同一批次。
  */
 void KnowledgeManager::uploadMultipleFilesToCurrentKnowledge(const QStringList& filePaths)
 {
@@ -267,17 +290,117 @@ void KnowledgeManager::uploadMultipleFilesToCurrentKnowledge(const QStringList&
         return;
     }
 
+    qDebug() << "[KnowledgeManager] Hashing" << filePaths.size() << "files before uploading to knowledge base:" << currentKnowledgeId;
+
+    // 大文件哈希耗时较长，放到后台线程，完成后回到GUI线程入队
+    ++m_hashingBatchCount;
+    setisCheckingDuplicates(true);
+
+    auto* watcher = new QFutureWatcher<QStringList>(this);
+    connect(watcher, &QFutureWatcher<QStringList>::finished, this,
+        [this, watcher, filePaths, currentKnowledgeId, userId]() {
+            watcher->deleteLater();
+            --m_hashingBatchCount;
+            setisCheckingDuplicates(m_hashingBatchCount > 0);
+            enqueueBatchUploads(filePaths, watcher->result(), currentKnowledgeId, userId);
+        });
+    watcher->setFuture(QtConcurrent::run([filePaths]() {
+        QStringList hashes;
+        for (const QString& filePath : filePaths) {
+            hashes.append(KnowledgeFileLedger::hashFile(filePath));
+        }
+        return hashes;
+    }));
+}
+
+/**
+ * @brief 文件哈希计算完成后筛掉重复文件并加入上传队列
+ * @param filePaths 本次选择的文件
+ * @param hashes 与 filePaths 一一对应的内容哈希，读取失败的文件为空
+ * @param knowledgeBaseId 目标知识库ID
+ * @param userId 用户ID
+ *
+ * 以下文件不再上传：
+ * - 与知识库中已有文件重复（见 KnowledgeFileLedger::findDuplicate）
+ * - 与本批次中前面的文件内容相同
+ * 知识库详情尚未加载时只做批次内查重。无法读取的文件照常入队，由上传流程报告错误。
+ */
+void KnowledgeManager::enqueueBatchUploads(const QStringList& filePaths, const QStringList& hashes,
+                                           const QString& knowledgeBaseId, const QString& userId)
+{
     // 初始化批量上传状态
-    m_totalUploadCount = filePaths.size();
-    m_successUploadCount = 0;
-    m_completedUploadCount = 0;
+    if (m_batchUploadIds.isEmpty() && m_hashingBatchCount == 0) {
+        m_totalUploadCount = 0;
+        m_successUploadCount = 0;
+        m_skippedUploadCount = 0;
+    }
+
+    QVariantMap detail = getcurrentKnowledgeDetail();
+    QVariantList serverFiles;
+    if (detail.value("id").toString() == knowledgeBaseId) {
+        serverFiles = detail.value("files").toList();
+    }
+
+    QSet<QString> batchHashes;
+    QStringList skippedNames;
+    for (int i = 0; i < filePaths.size(); ++i) {
+        const QString& filePath = filePaths.at(i);
+        const QString sha256 = hashes.value(i);
+
+        if (!sha256.isEmpty()) {
+            QString existing = batchHashes.contains(sha256)
+                ? QFileInfo(filePath).fileName()
+                : m_fileLedger.findDuplicate(knowledgeBaseId, filePath, sha256, serverFiles);
+            if (!existing.isEmpty()) {
+                qDebug() << "[KnowledgeManager] Skipping duplicate file:" << filePath << "existing:" << existing;
+                skippedNames.append(QFileInfo(filePath).fileName());
+                continue;
+            }
+            batchHashes.insert(sha256);
+        }
+
+        // 队列在下一次事件循环才开始上传，登记上传ID时不会错过同步失败的结果
+        QString uploadId = m_uploadQueue->enqueue(filePath, knowledgeBaseId, userId);
+        m_batchUploadIds.insert(uploadId);
+        if (!sha256.isEmpty()) {
+            m_pendingContents.insert(uploadId, PendingContent{ knowledgeBaseId, sha256 });
+        }
+    }
 
-    qDebug() << "[KnowledgeManager] Starting batch upload of" << m_totalUploadCount << "files to knowledge base:" << currentKnowledgeId;
+    m_totalUploadCount += filePaths.size() - skippedNames.size();
+    m_skippedUploadCount += skippedNames.size();
 
-    // 逐个上传文件
-    for (const QString& filePath : filePaths) {
-        GET_SINGLETON(ApiManager)->uploadFileToKnowledgeBase(filePath, currentKnowledgeId, userId);
+    qDebug() << "[KnowledgeManager] Starting batch upload of" << filePaths.size() - skippedNames.size()
+        << "files to knowledge base:" << knowledgeBaseId << "skipped duplicates:" << skippedNames.size();
+
+    if (!skippedNames.isEmpty()) {
+        emit duplicateFilesSkipped(skippedNames);
     }
+
+    // 全部文件都重复时不会再有上传结果回调
+    finishBatchIfDone();
+}
+
+/**
+ * @brief 取消所有排队中和上传中的文件
+ */
+void KnowledgeManager::cancelAllUploads()
+{
+    qDebug() << "[KnowledgeManager] Canceling all uploads, active:" << m_uploadQueue->activeCount()
+        << "pending:" << m_uploadQueue->pendingCount();
+    m_uploadQueue->cancelAll();
+}
+
+/**
+ * @brief 清除上传相关的本地缓存
+ *
+ * 先取消上传，避免进行中的上传在清除后又写回记录。
+ */
+void KnowledgeManager::clearUploadCache()
+{
+    cancelAllUploads();
+    m_fileLedger.clear();
+    qDebug() << "[KnowledgeManager] Upload ledger cleared";
 }
 
 /**
@@ -301,49 +424,43 @@ void KnowledgeManager::deleteKnowledgeFile(const QString& fileId)
 }
 
 /**
- * @brief 处理文件上传响应
- * @param success 请求是否成功
- * @param message 响应消息
- * @param data 响应数据
+ * @brief 处理单个文件上传结束
+ * @param uploadId 上传ID
+ * @param filePath 文件路径
+ * @param success 是否上传成功
+ * @param message 结果消息
  *
- * 处理文件上传完成后的响应，成功时自动刷新当前知识库的详情。
- * 如果在批量上传模式下，会更新计数器并在所有文件完成时发送批量上传信号。
+ * 按上传ID判断文件属于单文件上传还是批量上传：
+ * 单文件上传成功时自动刷新当前知识库的详情；
+ * 批量上传更新计数，批次中所有文件结束时刷新详情并发送批量上传信号。
  */
-void KnowledgeManager::onFileUploadResponse(bool success, const QString& message, const QJsonObject& data)
+void KnowledgeManager::onUploadFinished(const QString& uploadId, const QString& filePath, bool success, const QString& message)
 {
-    // 检查是否处于批量上传模式
-    if (m_totalUploadCount > 0) {
+    emit fileUploadFinished(filePath, success, message);
+
+    // 成功上传的文件记入查重记录，下次上传相同内容时跳过
+    PendingContent content = m_pendingContents.take(uploadId);
+    if (success && !content.sha256.isEmpty()) {
+        QFileInfo info(filePath);
+        m_fileLedger.record(content.knowledgeBaseId, content.sha256, info.fileName(), info.size());
+    }
+
+    if (m_batchUploadIds.remove(uploadId)) {
         // 批量上传模式
-        m_completedUploadCount++;
         if (success) {
             m_successUploadCount++;
         }
+        else {
+            qWarning() << "[KnowledgeManager] Batch upload failed:" << filePath << message;
+        }
 
-        qDebug() << "[KnowledgeManager] Batch upload progress:" << m_completedUploadCount << "/" << m_totalUploadCount
-            << "Success count:" << m_successUploadCount;
+        qDebug() << "[KnowledgeManager] Batch upload progress:" << m_totalUploadCount - m_batchUploadIds.size()
+            << "/" << m_totalUploadCount << "Success count:" << m_successUploadCount;
 
         // 检查是否所有文件都已上传完成
-        if (m_completedUploadCount >= m_totalUploadCount) {
-            // 批量上传完成，刷新知识库详情
-            QString currentKnowledgeId = getexpandedKnowledgeId();
-            if (!currentKnowledgeId.isEmpty()) {
-                getKnowledgeDetail(currentKnowledgeId);
-            }
-
-            // 发送批量上传完成信号
-            QString batchMessage = QStringLiteral("完成批量上传：成功 %1/%2 个文件")
-                .arg(m_successUploadCount).arg(m_totalUploadCount);
-            emit batchUploadCompleted(m_successUploadCount, m_totalUploadCount, batchMessage);
-
-            // 重置批量上传状态
-            m_totalUploadCount = 0;
-            m_successUploadCount = 0;
-            m_completedUploadCount = 0;
-
-            qDebug() << "[KnowledgeManager] Batch upload completed:" << batchMessage;
-        }
+        finishBatchIfDone();
     }
-    else {
+    else if (m_singleUploadIds.remove(uploadId)) {
         // 单文件上传模式
         if (success) {
             // 上传成功后，自动刷新当前知识库详情
@@ -353,15 +470,48 @@ void KnowledgeManager::onFileUploadResponse(bool success, const QString& message
             }
 
             emit fileUploadCompleted(true, QStringLiteral("文件上传成功"));
-            qDebug() << "[KnowledgeManager] File upload successful";
+            qDebug() << "[KnowledgeManager] File upload successful:" << filePath;
         }
         else {
-            qWarning() << "[KnowledgeManager] File upload failed:" << message;
+            qWarning() << "[KnowledgeManager] File upload failed:" << filePath << message;
             emit fileUploadCompleted(false, message);
         }
     }
 }
 
+/**
+ * @brief 批次中所有文件都已结束时刷新详情并发送批量上传完成信号
+ *
+ * 仍有文件在计算哈希时批次尚未结束；因重复跳过的文件不计入总数。
+ */
+void KnowledgeManager::finishBatchIfDone()
+{
+    if (!m_batchUploadIds.isEmpty() || m_hashingBatchCount > 0) {
+        return;
+    }
+
+    // 批量上传完成，刷新知识库详情
+    QString currentKnowledgeId = getexpandedKnowledgeId();
+    if (!currentKnowledgeId.isEmpty() && m_totalUploadCount > 0) {
+        getKnowledgeDetail(currentKnowledgeId);
+    }
+
+    // 发送批量上传完成信号
+    QString batchMessage = QStringLiteral("完成批量上传：成功 %1/%2 个文件")
+        .arg(m_successUploadCount).arg(m_totalUploadCount);
+    if (m_skippedUploadCount > 0) {
+        batchMessage += QStringLiteral("，跳过重复文件 %1 个").arg(m_skippedUploadCount);
+    }
+    emit batchUploadCompleted(m_successUploadCount, m_totalUploadCount, batchMessage);
+
+    // 重置批量上传状态
+    m_totalUploadCount = 0;
+    m_successUploadCount = 0;
+    m_skippedUploadCount = 0;
+
+    qDebug() << "[KnowledgeManager] Batch upload completed:" << batchMessage;
+}
+
 /**
  * @brief 处理文件删除响应
  * @param success 请求是否成功
@@ -2,6 +2,11 @@
 #include "CommonFunc.h"
 #include <QJsonArray>
 #include <QVariantList>
+#include <QSet>
+#include <QHash>
+#include "KnowledgeFileLedger.h"
+
+class KnowledgeUploadQueue;
 
 class KnowledgeManager : public QObject
 {
@@ -23,6 +28,12 @@ class KnowledgeManager : public QObject
         /// @brief 当前展开显示详情的知识库ID，空字符串表示没有展开的
         QUICK_PROPERTY(QString, expandedKnowledgeId)
 
+        /// @brief 同时进行的最大上传数
+        QUICK_PROPERTY(int, uploadConcurrency)
+
+        /// @brief 是否正在计算待上传文件的内容哈希（上传前查重）
+        QUICK_PROPERTY(bool, isCheckingDuplicates)
+
 public:
     /**
      * @brief 更新知识库列表
@@ -59,10 +70,18 @@ public:
      * @brief 批量上传文件到当前展开的知识库
      * @param filePaths 要上传的文件路径列表
      *
-     * 将多个文件批量上传到当前展开的知识库中
+     * 将多个文件批量上传到当前展开的知识库中，
+     * 上传前在后台线程计算文件哈希，跳过知识库中已有的文件和本批次中内容重复的文件
      */
     Q_INVOKABLE void uploadMultipleFilesToCurrentKnowledge(const QStringList& filePaths);
 
+    /**
+     * @brief 取消所有排队中和上传中的文件
+     *
+     * 被取消的文件计为失败，批量上传随之结束
+     */
+    Q_INVOKABLE void cancelAllUploads();
+
     /**
      * @brief 删除指定的知识库文件
      * @param fileId 要删除的文件ID
@@ -95,6 +114,13 @@ public:
      */
     Q_INVOKABLE void resetAllStates();
 
+    /**
+     * @brief 清除上传相关的本地缓存
+     *
+     * 取消进行中的上传，删除上传查重记录
+     */
+    void clearUploadCache();
+
     /**
      * @brief 编辑知识库
      * @param knowledgeId 知识库ID
@@ -136,6 +162,28 @@ signals:
      */
     void batchUploadCompleted(int successCount, int totalCount, const QString& message);
 
+    /**
+     * @brief 单个文件上传进度信号
+     * @param filePath 文件路径
+     * @param bytesSent 已发送字节数
+     * @param bytesTotal 总字节数，未知时为-1
+     */
+    void uploadProgress(const QString& filePath, qint64 bytesSent, qint64 bytesTotal);
+
+    /**
+     * @brief 单个文件上传结束信号（批量上传中的每个文件都会发出）
+     * @param filePath 文件路径
+     * @param success 是否上传成功
+     * @param message 结果消息
+     */
+    void fileUploadFinished(const QString& filePath, bool success, const QString& message);
+
+    /**
+     * @brief 批量上传时跳过重复文件信号
+     * @param fileNames 被跳过的文件名列表
+     */
+    void duplicateFilesSkipped(const QStringList& fileNames);
+
     /**
      * @brief 文件删除完成信号
      * @param success 是否删除成功
@@ -165,10 +213,36 @@ signals:
     void knowledgeBaseEditCompleted(bool success, const QString& message);
 
 private:
-    // 批量上传状态跟踪
-    int m_totalUploadCount = 0;      // 总上传文件数量
-    int m_successUploadCount = 0;    // 成功上传文件数量
-    int m_completedUploadCount = 0;  // 完成上传文件数量（成功+失败）
+    /**
+     * @brief 文件哈希计算完成后筛掉重复文件并加入上传队列
+     * @param filePaths 本次选择的文件
+     * @param hashes 与 filePaths 一一对应的内容哈希，读取失败的文件为空
+     * @param knowledgeBaseId 目标知识库ID
+     * @param userId 用户ID
+     */
+    void enqueueBatchUploads(const QStringList& filePaths, const QStringList& hashes,
+                             const QString& knowledgeBaseId, const QString& userId);
+
+    /// @brief 批次中所有文件都已结束时刷新详情并发送批量上传完成信号
+    void finishBatchIfDone();
+
+    /// @brief 已加入上传队列的文件内容，上传成功后写入查重记录
+    struct PendingContent {
+        QString knowledgeBaseId;
+        QString sha256;
+    };
+
+    KnowledgeUploadQueue* m_uploadQueue;    // 上传队列（限制并发、重试）
+    KnowledgeFileLedger m_fileLedger;       // 已上传文件的内容哈希记录
+    QHash<QString, PendingContent> m_pendingContents;   // 上传ID -> 文件内容
+    int m_hashingBatchCount = 0;            // 正在计算哈希的批次数量
+
+    // 上传状态跟踪，按上传ID对应到具体文件
+    QSet<QString> m_singleUploadIds;        // 单文件上传中的上传ID
+    QSet<QString> m_batchUploadIds;         // 当前批次中尚未结束的上传ID
+    int m_totalUploadCount = 0;             // 当前批次总文件数量
+    int m_successUploadCount = 0;           // 当前批次成功上传文件数量
+    int m_skippedUploadCount = 0;           // 当前批次因重复跳过的文件数量
 
 private slots:
     /**
@@ -188,12 +262,13 @@ private slots:
     void onKnowledgeBaseDetailResponse(bool success, const QString& message, const QJsonObject& data);
 
     /**
-     * @brief 处理文件上传响应
-     * @param success 请求是否成功
-     * @param message 响应消息
-     * @param data 响应数据
+     * @brief 处理单个文件上传结束
+     * @param uploadId 上传ID
+     * @param filePath 文件路径
+     * @param success 是否上传成功
+     * @param message 结果消息
      */
-    void onFileUploadResponse(bool success, const QString& message, const QJsonObject& data);
+    void onUploadFinished(const QString& uploadId, const QString& filePath, bool success, const QString& message);
 
     /**
      * @brief 处理文件删除响应
@@ -0,0 +1,193 @@
+﻿#include "KnowledgeUploadQueue.h"
+#include "ApiManager.h"
+#include <QTimer>
+#include <QDebug>
+
+namespace {
+/// @brief 默认最大并发上传数（QNetworkAccessManager对同一主机最多6个连接）
+const int kDefaultMaxConcurrent = 3;
+/// @brief 默认网络失败重试次数
+const int kDefaultMaxRetries = 3;
+/// @brief 第一次重试前的等待时间（毫秒），之后每次加倍
+const int kRetryBaseDelayMs = 2000;
+}
+
+KnowledgeUploadQueue::KnowledgeUploadQueue(QObject* parent)
+    : QObject(parent)
+    , m_maxConcurrent(kDefaultMaxConcurrent)
+    , m_maxRetries(kDefaultMaxRetries)
+    , m_nextId(0)
+    , m_starting(false)
+    , m_startScheduled(false)
+{
+    connect(GET_SINGLETON(ApiManager), &ApiManager::uploadFileProgress,
+        this, &KnowledgeUploadQueue::onUploadFileProgress);
+    connect(GET_SINGLETON(ApiManager), &ApiManager::uploadFileFinished,
+        this, &KnowledgeUploadQueue::onUploadFileFinished);
+}
+
+QString KnowledgeUploadQueue::enqueue(const QString& filePath, const QString& knowledgeBaseId, const QString& userId,
+                                      int priority)
+{
+    Job job;
+    job.id = QStringLiteral("upload-%1").arg(++m_nextId);
+    job.filePath = filePath;
+    job.knowledgeBaseId = knowledgeBaseId;
+    job.userId = userId;
+    job.priority = priority;
+    job.attempts = 0;
+
+    m_queued[priority].append(job);
+
+    // 在下一次事件循环开始上传，调用方可以先记录返回的上传ID
+    if (!m_startScheduled) {
+        m_startScheduled = true;
+        QTimer::singleShot(0, this, [this]() {
+            m_startScheduled = false;
+            startNext();
+        });
+    }
+    return job.id;
+}
+
+bool KnowledgeUploadQueue::cancel(const QString& uploadId)
+{
+    Job job;
+    if (m_active.contains(uploadId)) {
+        // 先移出上传中列表，终止时 ApiManager 发出的完成信号会被忽略
+        job = m_active.take(uploadId);
+        GET_SINGLETON(ApiManager)->abortUpload(uploadId);
+    } else if (m_waiting.contains(uploadId)) {
+        job = m_waiting.take(uploadId);
+    } else {
+        bool found = false;
+        for (auto it = m_queued.begin(); it != m_queued.end() && !found; ++it) {
+            QList<Job>& jobs = it.value();
+            for (int i = 0; i < jobs.size(); ++i) {
+                if (jobs.at(i).id == uploadId) {
+                    job = jobs.takeAt(i);
+                    found = true;
+                    break;
+                }
+            }
+        }
+        if (!found) {
+            return false;
+        }
+    }
+
+    qDebug() << "[KnowledgeUploadQueue] Upload canceled:" << job.filePath;
+    emit uploadFinished(job.id, job.filePath, false, QStringLiteral("上传已取消"));
+    startNext();
+    return true;
+}
+
+void KnowledgeUploadQueue::cancelAll()
+{
+    QStringList ids = m_waiting.keys();
+    for (const QList<Job>& jobs : qAsConst(m_queued)) {
+        for (const Job& job : jobs) {
+            ids.append(job.id);
+        }
+    }
+    // 先取消排队中的任务，避免取消上传中的任务后又启动新的上传
+    ids.append(m_active.keys());
+
+    for (const QString& id : qAsConst(ids)) {
+        cancel(id);
+    }
+}
+
+void KnowledgeUploadQueue::setMaxConcurrent(int maxConcurrent)
+{
+    m_maxConcurrent = qMax(1, maxConcurrent);
+    startNext();
+}
+
+int KnowledgeUploadQueue::pendingCount() const
+{
+    int count = m_waiting.size();
+    for (const QList<Job>& jobs : m_queued) {
+        count += jobs.size();
+    }
+    return count;
+}
+
+void KnowledgeUploadQueue::startNext()
+{
+    if (m_starting) {
+        return;
+    }
+    m_starting = true;
+
+    while (m_active.size() < m_maxConcurrent) {
+        // QMap按键升序遍历，取优先级最高的非空队列
+        auto it = m_queued.begin();
+        while (it != m_queued.end() && it.value().isEmpty()) {
+            it = m_queued.erase(it);
+        }
+        if (it == m_queued.end()) {
+            break;
+        }
+
+        Job job = it.value().takeFirst();
+        ++job.attempts;
+        m_active.insert(job.id, job);
+
+        qDebug() << "[KnowledgeUploadQueue] Starting upload:" << job.filePath << "attempt:" << job.attempts
+                 << "active:" << m_active.size() << "queued:" << pendingCount();
+        // 文件无法打开等错误会同步回调 onUploadFileFinished，m_starting 保证不会重入
+        GET_SINGLETON(ApiManager)->uploadFileToKnowledgeBase(job.filePath, job.knowledgeBaseId, job.userId, job.id);
+    }
+
+    m_starting = false;
+}
+
+void KnowledgeUploadQueue::retryLater(const Job& job)
+{
+    const int delay = kRetryBaseDelayMs << (job.attempts - 1);
+    qDebug() << "[KnowledgeUploadQueue] Retrying upload in" << delay << "ms:" << job.filePath;
+
+    m_waiting.insert(job.id, job);
+    const QString id = job.id;
+    QTimer::singleShot(delay, this, [this, id]() {
+        // 等待期间可能已被取消
+        if (!m_waiting.contains(id)) {
+            return;
+        }
+        Job retryJob = m_waiting.take(id);
+        // 重试的任务排在同优先级队列最前面
+        m_queued[retryJob.priority].prepend(retryJob);
+        startNext();
+    });
+}
+
+void KnowledgeUploadQueue::onUploadFileProgress(const QString& uploadId, qint64 bytesSent, qint64 bytesTotal)
+{
+    auto it = m_active.constFind(uploadId);
+    if (it != m_active.constEnd()) {
+        emit uploadProgress(uploadId, it->filePath, bytesSent, bytesTotal);
+    }
+}
+
+void KnowledgeUploadQueue::onUploadFileFinished(const QString& uploadId, bool success, bool retryable,
+                                                const QString& message, const QJsonObject& data)
+{
+    Q_UNUSED(data);
+
+    // 已取消或不属于本队列的上传
+    if (!m_active.contains(uploadId)) {
+        return;
+    }
+    Job job = m_active.take(uploadId);
+
+    if (!success && retryable && job.attempts <= m_maxRetries) {
+        qWarning() << "[KnowledgeUploadQueue] Upload failed, will retry:" << job.filePath << message;
+        retryLater(job);
+    } else {
+        qDebug() << "[KnowledgeUploadQueue] Upload finished:" << job.filePath << "success:" << success;
+        emit uploadFinished(job.id, job.filePath, success, message);
+    }
+
+    startNext();
+}
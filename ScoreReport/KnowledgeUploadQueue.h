@@ -0,0 +1,115 @@
+﻿#ifndef KNOWLEDGEUPLOADQUEUE_H
+#define KNOWLEDGEUPLOADQUEUE_H
+
+#include <QObject>
+#include <QString>
+#include <QHash>
+#include <QMap>
+#include <QList>
+#include <QJsonObject>
+
+/**
+ * @brief 知识库文件上传队列
+ *
+ * 批量上传时不再一次性发出所有multipart请求，而是：
+ * - 按优先级排队（数值越小越先上传），同一优先级先进先出
+ * - 同时进行的上传数不超过 maxConcurrent，给聊天等其他请求留出连接
+ * - 每个上传分配唯一的上传ID，进度和结果都按ID对应到具体文件
+ * - 网络原因失败时按指数退避重试，服务器拒绝的文件不重试
+ * - 支持取消单个文件或全部文件，排队中、等待重试中和上传中的文件都可以取消
+ */
+class KnowledgeUploadQueue : public QObject
+{
+    Q_OBJECT
+
+public:
+    /// @brief 上传优先级
+    enum Priority {
+        HighPriority = 0,   ///< 单个文件上传
+        NormalPriority = 1  ///< 批量上传
+    };
+
+    explicit KnowledgeUploadQueue(QObject* parent = nullptr);
+
+    /**
+     * @brief 加入上传队列
+     * @param filePath 文件路径
+     * @param knowledgeBaseId 知识库ID
+     * @param userId 用户ID
+     * @param priority 优先级，数值越小越先上传
+     * @return 上传ID，上传在下一次事件循环中开始
+     */
+    QString enqueue(const QString& filePath, const QString& knowledgeBaseId, const QString& userId,
+                    int priority = NormalPriority);
+
+    /**
+     * @brief 取消指定上传，被取消的文件通过 uploadFinished 返回失败
+     * @return 上传ID不存在或已完成时返回false
+     */
+    bool cancel(const QString& uploadId);
+
+    /// @brief 取消全部上传
+    void cancelAll();
+
+    /// @brief 设置最大并发上传数（至少为1）
+    void setMaxConcurrent(int maxConcurrent);
+    int maxConcurrent() const { return m_maxConcurrent; }
+
+    /// @brief 设置网络失败后的最大重试次数
+    void setMaxRetries(int maxRetries) { m_maxRetries = qMax(0, maxRetries); }
+    int maxRetries() const { return m_maxRetries; }
+
+    /// @brief 排队中和等待重试的文件数
+    int pendingCount() const;
+
+    /// @brief 正在上传的文件数
+    int activeCount() const { return m_active.size(); }
+
+signals:
+    /**
+     * @brief 单个文件上传进度
+     * @param uploadId 上传ID
+     * @param filePath 文件路径
+     * @param bytesSent 已发送字节数
+     * @param bytesTotal 请求体总字节数，未知时为-1
+     */
+    void uploadProgress(const QString& uploadId, const QString& filePath, qint64 bytesSent, qint64 bytesTotal);
+
+    /**
+     * @brief 单个文件上传结束（成功、最终失败或被取消）
+     * @param uploadId 上传ID
+     * @param filePath 文件路径
+     * @param success 是否上传成功
+     * @param message 结果消息
+     */
+    void uploadFinished(const QString& uploadId, const QString& filePath, bool success, const QString& message);
+
+private slots:
+    void onUploadFileProgress(const QString& uploadId, qint64 bytesSent, qint64 bytesTotal);
+    void onUploadFileFinished(const QString& uploadId, bool success, bool retryable, const QString& message, const QJsonObject& data);
+
+private:
+    /// @brief 一个上传任务
+    struct Job {
+        QString id;
+        QString filePath;
+        QString knowledgeBaseId;
+        QString userId;
+        int priority;
+        int attempts;   ///< 已经发起的次数
+    };
+
+    void startNext();
+    void retryLater(const Job& job);
+
+    QMap<int, QList<Job>> m_queued;     ///< 优先级 -> 排队中的任务
+    QHash<QString, Job> m_active;       ///< 上传ID -> 上传中的任务
+    QHash<QString, Job> m_waiting;      ///< 上传ID -> 等待重试的任务
+    int m_maxConcurrent;
+    int m_maxRetries;
+    quint64 m_nextId;
+    bool m_starting;                    ///< 正在 startNext() 中，防止同步失败回调时重入
+    bool m_startScheduled;              ///< 已安排在下一次事件循环中启动上传
+};
+
+#endif // KNOWLEDGEUPLOADQUEUE_H
@@ -0,0 +1,273 @@
+﻿#include "LogArchiver.h"
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QSaveFile>
+#include <QThread>
+#include <QtConcurrent>
+#include <QDebug>
+#include <cstring>
+#include <QtZlib/zlib.h>   // Qt自带的zlib，由QtCore导出
+
+namespace {
+/// @brief 日志分段文件名
+const QStringList kSegmentFilters = { "ScoreReport_*.log", "ScoreReport_*.log.gz" };
+
+/// @brief 压缩和解压时每次读取的字节数
+const qint64 kBlockSize = 64 * 1024;
+
+/// @brief zlib 的 windowBits：15 为最大窗口，加 16 表示读写gzip头尾
+const int kGzipWindowBits = 15 + 16;
+
+/// @brief 后台任务以最低优先级运行，不与界面和网络线程争抢CPU
+void lowerPriority()
+{
+    QThread::currentThread()->setPriority(QThread::LowestPriority);
+}
+}
+
+LogArchiver* LogArchiver::getInstance()
+{
+    static LogArchiver instance;
+    return &instance;
+}
+
+LogArchiver::LogArchiver()
+    : m_logDir("AppData/logs")
+    , m_retentionBytes(200 * 1024 * 1024)
+{
+    m_pool.setMaxThreadCount(1);
+}
+
+void LogArchiver::configure(const QString& logDir, qint64 retentionBytes)
+{
+    m_logDir = logDir;
+    m_retentionBytes = retentionBytes;
+}
+
+void LogArchiver::archive(const QString& segmentPath)
+{
+    QtConcurrent::run(&m_pool, [this, segmentPath]() {
+        lowerPriority();
+        compressFile(segmentPath);
+        enforceRetention(QString());
+    });
+}
+
+void LogArchiver::archivePending(const QString& activePath)
+{
+    QtConcurrent::run(&m_pool, [this, activePath]() {
+        lowerPriority();
+        const QString activeName = QFileInfo(activePath).fileName();
+        const QStringList files = segments(m_logDir);
+        for (const QString& filePath : files) {
+            if (filePath.endsWith(".log") && QFileInfo(filePath).fileName() != activeName) {
+                compressFile(filePath);
+            }
+        }
+        enforceRetention(activePath);
+    });
+}
+
+void LogArchiver::waitForDone()
+{
+    m_pool.waitForDone();
+}
+
+QString LogArchiver::compressFile(const QString& filePath)
+{
+    QFile file(filePath);
+    if (!file.open(QIODevice::ReadOnly)) {
+        qWarning() << "[LogArchiver] Failed to open segment:" << filePath << file.errorString();
+        return QString();
+    }
+
+    const QString gzPath = filePath + ".gz";
+    QSaveFile output(gzPath);
+    if (!output.open(QIODevice::WriteOnly)) {
+        qWarning() << "[LogArchiver] Failed to write" << gzPath << output.errorString();
+        return QString();
+    }
+    if (!gzipCopy(file, output)) {
+        qWarning() << "[LogArchiver] Failed to compress segment:" << filePath << output.errorString();
+        output.cancelWriting();
+        return QString();
+    }
+    const qint64 compressedSize = output.size();
+    if (!output.commit()) {
+        qWarning() << "[LogArchiver] Failed to write" << gzPath << output.errorString();
+        return QString();
+    }
+
+    const qint64 originalSize = file.size();
+    file.close();
+    QFile::remove(filePath);
+    qDebug() << "[LogArchiver] Compressed" << QFileInfo(filePath).fileName() << originalSize << "->" << compressedSize << "bytes";
+    return gzPath;
+}
+
+QByteArray LogArchiver::readSegment(const QString& filePath)
+{
+    QFile file(filePath);
+    if (!file.open(QIODevice::ReadOnly)) {
+        return QByteArray();
+    }
+    return filePath.endsWith(".gz") ? gunzip(file) : file.readAll();
+}
+
+QStringList LogArchiver::search(const QString& logDir, const QString& text, int maxResults)
+{
+    QStringList results;
+    const QStringList files = segments(logDir);
+    for (const QString& filePath : files) {
+        const QByteArray data = readSegment(filePath);
+        if (data.isEmpty()) {
+            continue;
+        }
+
+        const QString fileName = QFileInfo(filePath).fileName();
+        const QString content = QString::fromUtf8(data);
+        int start = 0;
+        while (start < content.size()) {
+            int end = content.indexOf('\n', start);
+            if (end < 0) {
+                end = content.size();
+            }
+            const QStringRef line = content.midRef(start, end - start);
+            if (line.contains(text, Qt::CaseInsensitive)) {
+                results.append(fileName + ": " + line.toString());
+                if (maxResults > 0 && results.size() >= maxResults) {
+                    return results;
+                }
+            }
+            start = end + 1;
+        }
+    }
+    return results;
+}
+
+QStringList LogArchiver::segments(const QString& logDir)
+{
+    QStringList files;
+    const QFileInfoList infos = QDir(logDir).entryInfoList(kSegmentFilters, QDir::Files, QDir::Time | QDir::Reversed);
+    for (const QFileInfo& info : infos) {
+        files.append(info.filePath());
+    }
+    return files;
+}
+
+void LogArchiver::enforceRetention(const QString& activePath)
+{
+    const QFileInfoList infos = QDir(m_logDir).entryInfoList(kSegmentFilters, QDir::Files, QDir::Time | QDir::Reversed);
+    qint64 total = 0;
+    for (const QFileInfo& info : infos) {
+        total += info.size();
+    }
+
+    // 从最旧的分段开始删除；最新的分段是当前正在写入的文件，始终保留
+    const QString activeName = QFileInfo(activePath).fileName();
+    for (int i = 0; i + 1 < infos.size() && total > m_retentionBytes; ++i) {
+        const QFileInfo& info = infos.at(i);
+        if (info.fileName() == activeName) {
+            continue;
+        }
+        if (QFile::remove(info.filePath())) {
+            total -= info.size();
+            qDebug() << "[LogArchiver] Removed old segment:" << info.fileName();
+        }
+    }
+}
+
+bool LogArchiver::gzipCopy(QIODevice& input, QIODevice& output)
+{
+    z_stream stream;
+    memset(&stream, 0, sizeof(stream));
+    if (deflateInit2(&stream, 6, Z_DEFLATED, kGzipWindowBits, 8, Z_DEFAULT_STRATEGY) != Z_OK) {
+        return false;
+    }
+
+    QByteArray in;
+    QByteArray out(static_cast<int>(kBlockSize), Qt::Uninitialized);
+    int result = Z_OK;
+    while (result != Z_STREAM_END) {
+        in = input.read(kBlockSize);
+        const int flush = input.atEnd() ? Z_FINISH : Z_NO_FLUSH;
+        stream.next_in = reinterpret_cast<Bytef*>(in.data());
+        stream.avail_in = static_cast<uInt>(in.size());
+
+        // 压缩输出可能多于一个输出块，直到本次输入全部消耗
+        do {
+            stream.next_out = reinterpret_cast<Bytef*>(out.data());
+            stream.avail_out = static_cast<uInt>(out.size());
+            result = deflate(&stream, flush);
+            const qint64 produced = out.size() - static_cast<qint64>(stream.avail_out);
+            if (result == Z_STREAM_ERROR || (produced > 0 && output.write(out.constData(), produced) != produced)) {
+                deflateEnd(&stream);
+                return false;
+            }
+        } while (stream.avail_out == 0);
+
+        if (flush != Z_FINISH && in.isEmpty()) {
+            // 读取出错：没有更多数据但也没有到达文件末尾
+            deflateEnd(&stream);
+            return false;
+        }
+    }
+
+    deflateEnd(&stream);
+    return true;
+}
+
+QByteArray LogArchiver::gunzip(QIODevice& input)
+{
+    z_stream stream;
+    memset(&stream, 0, sizeof(stream));
+    if (inflateInit2(&stream, kGzipWindowBits) != Z_OK) {
+        return QByteArray();
+    }
+
+    QByteArray result;
+    QByteArray in;
+    QByteArray out(static_cast<int>(kBlockSize), Qt::Uninitialized);
+    bool ok = true;
+    bool memberDone = false;
+    while (ok && !input.atEnd()) {
+        in = input.read(kBlockSize);
+        if (in.isEmpty()) {
+            break;
+        }
+        stream.next_in = reinterpret_cast<Bytef*>(in.data());
+        stream.avail_in = static_cast<uInt>(in.size());
+
+        for (;;) {
+            // 一个gzip成员结束后还有数据时，按下一个成员继续解压
+            if (memberDone) {
+                if (stream.avail_in == 0) {
+                    break;
+                }
+                if (inflateReset(&stream) != Z_OK) {
+                    ok = false;
+                    break;
+                }
+                memberDone = false;
+            }
+            stream.next_out = reinterpret_cast<Bytef*>(out.data());
+            stream.avail_out = static_cast<uInt>(out.size());
+            const int status = inflate(&stream, Z_NO_FLUSH);
+            if (status != Z_OK && status != Z_STREAM_END && status != Z_BUF_ERROR) {
+                ok = false;
+                break;
+            }
+            result.append(out.constData(), out.size() - static_cast<int>(stream.avail_out));
+            if (status == Z_STREAM_END) {
+                memberDone = true;
+            } else if (stream.avail_out != 0) {
+                break;  // 本块输入已全部消耗，读取下一块
+            }
+        }
+    }
+
+    // 输入在压缩流中途结束（文件被截断）视为失败
+    inflateEnd(&stream);
+    return ok && memberDone ? result : QByteArray();
+}
@@ -0,0 +1,93 @@
+﻿#ifndef LOGARCHIVER_H
+#define LOGARCHIVER_H
+
+#include <QString>
+#include <QStringList>
+#include <QByteArray>
+#include <QThreadPool>
+
+class QIODevice;
+
+/**
+ * @brief 日志分段的后台压缩、保留空间清理和检索
+ *
+ * AsyncLogger 写满或写够时间的日志分段交给 archive()，在一个低优先级的专用线程中：
+ * - 压缩为 gzip（ScoreReport_*.log -> ScoreReport_*.log.gz）后删除原文件
+ * - 按修改时间从旧到新删除分段，直到日志目录总大小不超过保留空间
+ *
+ * 压缩和解压使用Qt自带的zlib（windowBits = 15 + 16），输出标准gzip格式，
+ * 可以直接用 zcat / 7-Zip 查看；压缩时按块读取分段，不把整个文件读入内存。
+ *
+ * search() 按时间顺序检索所有分段（含压缩分段），命令行 ScoreReport --log-search 文本 调用它。
+ */
+class LogArchiver
+{
+public:
+    static LogArchiver* getInstance();
+
+    /**
+     * @brief 设置日志目录和保留空间
+     * @param logDir 日志目录
+     * @param retentionBytes 所有分段（含当前分段）的总大小上限
+     */
+    void configure(const QString& logDir, qint64 retentionBytes);
+
+    /**
+     * @brief 在后台压缩一个已结束的分段，并清理超出保留空间的旧分段
+     * @param segmentPath 已关闭的日志文件
+     */
+    void archive(const QString& segmentPath);
+
+    /**
+     * @brief 在后台压缩上次运行遗留的未压缩分段
+     * @param activePath 当前正在写入的分段，不处理
+     */
+    void archivePending(const QString& activePath);
+
+    /// @brief 等待所有后台任务完成（退出前调用）
+    void waitForDone();
+
+    /**
+     * @brief 把日志文件压缩为 gzip
+     * @return 成功时返回压缩文件路径，原文件已删除；失败返回空字符串
+     */
+    static QString compressFile(const QString& filePath);
+
+    /**
+     * @brief 读取一个分段的全部内容，.gz 分段自动解压
+     * @return 读取或解压失败时返回空
+     */
+    static QByteArray readSegment(const QString& filePath);
+
+    /**
+     * @brief 检索日志目录下所有分段
+     * @param logDir 日志目录
+     * @param text 要查找的文本（不区分大小写）
+     * @param maxResults 最多返回的行数，0 表示不限制
+     * @return 匹配的行，格式为 "文件名: 行内容"，按分段时间从旧到新排列
+     */
+    static QStringList search(const QString& logDir, const QString& text, int maxResults = 0);
+
+    /// @brief 日志目录下的所有分段（.log 和 .log.gz），按修改时间从旧到新
+    static QStringList segments(const QString& logDir);
+
+private:
+    LogArchiver();
+    ~LogArchiver() {}
+    LogArchiver(const LogArchiver&) = delete;
+    LogArchiver& operator=(const LogArchiver&) = delete;
+
+    void enforceRetention(const QString& activePath);
+
+    /// @brief 把 input 的剩余内容按块压缩为gzip写入 output
+    static bool gzipCopy(QIODevice& input, QIODevice& output);
+
+    /// @brief 解压gzip数据（支持多个gzip成员首尾相接），失败返回空
+    static QByteArray gunzip(QIODevice& input);
+
+    QThreadPool m_pool;             ///< 单线程，低优先级运行压缩和清理
+    QString m_logDir;
+    qint64 m_retentionBytes;
+};
+
+#endif // LOGARCHIVER_H
@@ -0,0 +1,84 @@
+﻿#include "LogCategories.h"
+#include <QCoreApplication>
+#include <QFile>
+#include <QFileInfo>
+#include <QFileSystemWatcher>
+#include <QJsonDocument>
+#include <QStringList>
+#include <QDebug>
+
+Q_LOGGING_CATEGORY(lcNet, "net")
+Q_LOGGING_CATEGORY(lcStream, "stream")
+Q_LOGGING_CATEGORY(lcFile, "file")
+Q_LOGGING_CATEGORY(lcScorer, "scorer")
+Q_LOGGING_CATEGORY(lcUi, "ui")
+
+namespace {
+/// @brief 按从低到高排列的级别名，与过滤规则中的后缀一致
+const char* const kLevels[] = { "debug", "info", "warning", "critical" };
+const int kLevelCount = 4;
+
+QJsonObject readLoggingConfig(const QString& configPath)
+{
+    QFile configFile(configPath);
+    if (!configFile.open(QIODevice::ReadOnly)) {
+        return QJsonObject();
+    }
+    return QJsonDocument::fromJson(configFile.readAll()).object().value("logging").toObject();
+}
+}
+
+void LogCategories::applyConfig(const QJsonObject& loggingObj)
+{
+    const QJsonObject categories = loggingObj.value("categories").toObject();
+
+    // 每个分类关闭低于配置级别的所有级别，"off" 关闭全部
+    QStringList rules;
+    for (auto it = categories.constBegin(); it != categories.constEnd(); ++it) {
+        const QString level = it.value().toString().toLower();
+        int minLevel = kLevelCount;
+        for (int i = 0; i < kLevelCount; ++i) {
+            if (level == QLatin1String(kLevels[i])) {
+                minLevel = i;
+                break;
+            }
+        }
+        if (minLevel == kLevelCount && level != QLatin1String("off")) {
+            qWarning() << "[LogCategories] Unknown level" << level << "for category" << it.key();
+            continue;
+        }
+        for (int i = 0; i < minLevel; ++i) {
+            rules.append(QStringLiteral("%1.%2=false").arg(it.key(), QLatin1String(kLevels[i])));
+        }
+    }
+
+    QLoggingCategory::setFilterRules(rules.join('\n'));
+    if (!rules.isEmpty()) {
+        qInfo() << "[LogCategories] Filter rules applied:" << rules.join(", ");
+    }
+}
+
+void LogCategories::watchConfigFile(const QString& configPath)
+{
+    static QFileSystemWatcher* watcher = nullptr;
+    if (watcher) {
+        return;
+    }
+    watcher = new QFileSystemWatcher(QCoreApplication::instance());
+
+    // 同时监视目录：文件不存在或被编辑器替换时，通过目录变化重新挂上文件监视
+    const QString configDir = QFileInfo(configPath).absolutePath();
+    watcher->addPath(configDir);
+    if (QFile::exists(configPath)) {
+        watcher->addPath(configPath);
+    }
+
+    auto reload = [configPath]() {
+        if (QFile::exists(configPath) && !watcher->files().contains(configPath)) {
+            watcher->addPath(configPath);
+        }
+        applyConfig(readLoggingConfig(configPath));
+    };
+    QObject::connect(watcher, &QFileSystemWatcher::fileChanged, reload);
+    QObject::connect(watcher, &QFileSystemWatcher::directoryChanged, reload);
+}
@@ -0,0 +1,80 @@
+﻿#ifndef LOGCATEGORIES_H
+#define LOGCATEGORIES_H
+
+#include <QLoggingCategory>
+#include <QJsonObject>
+#include <QString>
+
+/**
+ * @brief 按子系统划分的日志分类
+ *
+ * - net：请求收发、请求体/响应体、终止请求
+ * - stream：SSE流式数据、流式对话开始/结束
+ * - file：文件上传下载、附件读取、Word进程清理
+ * - scorer：各评分模块
+ * - ui：界面刷新、列表加载等界面状态
+ *
+ * 调用方使用 LOG_DEBUG(lcNet) << ... 等宏。分类未启用对应级别时，
+ * 流式表达式（包括其中的 QString::arg 等拼接）不会被求值。
+ *
+ * 编译期最低级别由 SCORE_LOG_MIN_LEVEL 控制（0=debug 1=info 2=warning 3=critical，默认0），
+ * 低于该级别的宏展开为 while (false)，不产生任何代码。
+ *
+ * 运行期在 config.json 的 logging.categories 中按分类设置最低级别，例如
+ * {"stream": "info", "net": "warning"}，可选 debug / info / warning / critical / off，
+ * 修改配置文件后立即生效。
+ */
+Q_DECLARE_LOGGING_CATEGORY(lcNet)
+Q_DECLARE_LOGGING_CATEGORY(lcStream)
+Q_DECLARE_LOGGING_CATEGORY(lcFile)
+Q_DECLARE_LOGGING_CATEGORY(lcScorer)
+Q_DECLARE_LOGGING_CATEGORY(lcUi)
+
+#ifndef SCORE_LOG_MIN_LEVEL
+#define SCORE_LOG_MIN_LEVEL 0
+#endif
+
+// 编译期关闭的级别：条件恒为假，流式表达式不会被求值，编译器直接丢弃
+#define SCORE_LOG_DISABLED while (false) QMessageLogger().noDebug()
+
+#if SCORE_LOG_MIN_LEVEL <= 0
+#define LOG_DEBUG(category) qCDebug(category)
+#else
+#define LOG_DEBUG(category) SCORE_LOG_DISABLED
+#endif
+
+#if SCORE_LOG_MIN_LEVEL <= 1
+#define LOG_INFO(category) qCInfo(category)
+#else
+#define LOG_INFO(category) SCORE_LOG_DISABLED
+#endif
+
+#if SCORE_LOG_MIN_LEVEL <= 2
+#define LOG_WARNING(category) qCWarning(category)
+#else
+#define LOG_WARNING(category) SCORE_LOG_DISABLED
+#endif
+
+#if SCORE_LOG_MIN_LEVEL <= 3
+#define LOG_CRITICAL(category) qCCritical(category)
+#else
+#define LOG_CRITICAL(category) SCORE_LOG_DISABLED
+#endif
+
+class LogCategories
+{
+public:
+    /**
+     * @brief 按 config.json 的 logging 节设置各分类的运行期最低级别
+     * @param loggingObj logging 节，未配置的分类输出全部级别
+     */
+    static void applyConfig(const QJsonObject& loggingObj);
+
+    /**
+     * @brief 监视配置文件，修改后重新应用分类级别
+     * @param configPath config.json 路径，文件尚不存在时等待其创建
+     */
+    static void watchConfigFile(const QString& configPath);
+};
+
+#endif // LOGCATEGORIES_H
@@ -9,7 +9,20 @@
 #include <QDateTime>
 #include <QTimer>
 #include <QProcess>
+#include <QSaveFile>
+#include <QCryptographicHash>
 #include "Version.h"
+#include "ExtractedTextCache.h"
+#include "HistoryManager.h"
+#include "KnowledgeManager.h"
+
+namespace {
+/// @brief 更新包下载中断后自动续传的最大次数
+const int kMaxDownloadRetries = 3;
+/// @brief 自动续传的基础等待时间（毫秒），按重试次数递增
+const int kDownloadRetryDelayMs = 3000;
+}
+
 LoginManager::LoginManager(QObject* parent)
     : QObject(parent)
     , m_apiManager(nullptr)
@@ -56,6 +69,8 @@ LoginManager::LoginManager(QObject* parent)
         this, &LoginManager::onSystemUpdateListResponse);
     connect(m_apiManager, &ApiManager::downloadAppFileResponse,
         this, &LoginManager::onDownloadAppFileResponse);
+    connect(m_apiManager, &ApiManager::downloadAppFileProgress,
+        this, &LoginManager::onDownloadAppFileProgress);
     // 启动时加载保存的凭据和用户列表
     loadSavedCredentials();
     loadUserList();
@@ -110,6 +125,9 @@ void LoginManager::logout()
 {
     qDebug() << "[LoginManager] User logout";
     setisLoggedIn(false);
+    if (m_apiManager) {
+        m_apiManager->setSessionActive(false);
+    }
     setcurrentUserName("");
     setcurrentUserAvatar("");
     setcurrentUserId("");
@@ -402,6 +420,15 @@ void LoginManager::clearAllCache()
     // 清除日志文件
     clearLogFiles();
     
+    // 清除附件文本缓存
+    GET_SINGLETON(ExtractedTextCache)->clear();
+    
+    // 清除本地评测历史记录及其搜索索引
+    GET_SINGLETON(HistoryManager)->clearLocalCache();
+    
+    // 清除上传查重记录
+    GET_SINGLETON(KnowledgeManager)->clearUploadCache();
+    
     // 清除LoginManager的所有设置
     m_settings->clear();
     m_settings->sync();
@@ -421,8 +448,8 @@ void LoginManager::clearLogFiles()
         return;
     }
     
-    // 获取所有.log文件（包括应用日志和更新日志）
-    QStringList logFiles = dir.entryList(QStringList() << "*.log", QDir::Files);
+    // 获取所有.log文件（包括应用日志和更新日志）及压缩后的日志分段
+    QStringList logFiles = dir.entryList(QStringList() << "*.log" << "*.log.gz", QDir::Files);
     if (logFiles.isEmpty()) {
         qDebug() << "[LoginManager] No log files found in:" << logDir;
         return;
@@ -518,6 +545,8 @@ void LoginManager::downloadAndInstallUpdate()
     }
     
     setisDownloadingUpdate(true);
+    m_downloadPercentage = -1;
+    m_downloadRetryCount = 0;
     qDebug() << "[LoginManager] Starting update download:" << getupdateFileName();
     m_apiManager->downloadAppFile(getupdateFileName());
 }
@@ -552,6 +581,11 @@ void LoginManager::onSystemUpdateListResponse(bool success, const QString& messa
     QJsonObject latestUpdate = updateList[0].toObject();
     QString versionNumber = latestUpdate.value("versionNumber").toString();
     QString fileName = latestUpdate.value("fileName").toString();
+    // 服务器公布的安装包哈希（可选），用于校验下载内容本身
+    QString publishedSha256 = latestUpdate.value("sha256").toString();
+    if (publishedSha256.isEmpty()) {
+        publishedSha256 = latestUpdate.value("fileHash").toString();
+    }
     
     if (versionNumber.isEmpty() || fileName.isEmpty()) {
         qWarning() << "[LoginManager] Invalid update data: missing version or filename";
@@ -566,6 +600,27 @@ void LoginManager::onSystemUpdateListResponse(bool success, const QString& messa
     // 保存更新信息
     setlatestVersion(versionNumber);
     setupdateFileName(fileName);
+    m_publishedSha256 = publishedSha256.trimmed();
+}
+
+/**
+ * @brief 处理下载App文件进度
+ * @param bytesReceived 已接收字节数
+ * @param bytesTotal 文件总字节数，未知时为-1
+ * 
+ * 只在百分比变化时发出 updateDownloadProgress，避免每个数据块都通知界面
+ */
+void LoginManager::onDownloadAppFileProgress(qint64 bytesReceived, qint64 bytesTotal)
+{
+    if (bytesTotal <= 0) {
+        return;
+    }
+    
+    int percentage = static_cast<int>(bytesReceived * 100 / bytesTotal);
+    if (percentage != m_downloadPercentage) {
+        m_downloadPercentage = percentage;
+        emit updateDownloadProgress(percentage);
+    }
 }
 
 /**
@@ -579,25 +634,42 @@ void LoginManager::onDownloadAppFileResponse(bool success, const QString& messag
     qDebug() << "[LoginManager] ========== Download App File Response Received ==========";
     qDebug() << "[LoginManager] Success:" << success << "Message:" << message;
     
-    setisDownloadingUpdate(false);
-    
     if (!success) {
+        // 网络中断时已下载的部分保留在临时目录，稍后自动从断点继续
+        if (data.value("resumable").toBool() && m_downloadRetryCount < kMaxDownloadRetries) {
+            ++m_downloadRetryCount;
+            qWarning() << "[LoginManager] Update download interrupted:" << message
+                       << "received:" << static_cast<qint64>(data.value("bytesReceived").toDouble())
+                       << "retry" << m_downloadRetryCount << "of" << kMaxDownloadRetries;
+            QTimer::singleShot(kDownloadRetryDelayMs * m_downloadRetryCount, this, [this]() {
+                if (getisDownloadingUpdate()) {
+                    m_apiManager->downloadAppFile(getupdateFileName());
+                }
+            });
+            return;
+        }
+        
+        setisDownloadingUpdate(false);
         qWarning() << "[LoginManager] ERROR: Failed to download update file:" << message;
         return;
     }
     
+    setisDownloadingUpdate(false);
+    
     qDebug() << "[LoginManager] Update file downloaded successfully";
     qDebug() << "[LoginManager] Response data keys:" << data.keys();
     emit updateDownloadCompleted();
     
-    // 文件已经被ApiManager保存到临时位置，直接获取文件路径
+    // 文件已经被ApiManager边下载边保存到临时位置，同时给出了大小和SHA-256
     QString downloadedFilePath = data.value("filePath").toString();
     QString fileName = data.value("fileName").toString();
-    int fileSize = data.value("fileSize").toInt();
+    qint64 fileSize = static_cast<qint64>(data.value("fileSize").toDouble());
+    QString sha256 = data.value("sha256").toString();
     
     qDebug() << "[LoginManager] Downloaded file info - Path:" << downloadedFilePath;
     qDebug() << "[LoginManager] Downloaded file name:" << fileName;
     qDebug() << "[LoginManager] Expected file size:" << fileSize << "bytes";
+    qDebug() << "[LoginManager] Downloaded SHA-256:" << sha256;
     
     // 验证文件是否存在且有效
     if (downloadedFilePath.isEmpty()) {
@@ -610,28 +682,28 @@ void LoginManager::onDownloadAppFileResponse(bool success, const QString& messag
         return;
     }
     
-    qDebug() << "[LoginManager] Downloaded file exists, verifying size...";
-    
-    // 验证文件大小
-    QFileInfo fileInfo(downloadedFilePath);
-    qDebug() << "[LoginManager] Actual file size:" << fileInfo.size() << "bytes";
-    qDebug() << "[LoginManager] File readable:" << fileInfo.isReadable();
-    qDebug() << "[LoginManager] File writable:" << fileInfo.isWritable();
-    
-    if (fileInfo.size() == 0) {
+    if (fileSize == 0) {
         qWarning() << "[LoginManager] ERROR: Downloaded file is empty!";
         return;
     }
     
-    if (fileInfo.size() != fileSize) {
-        qWarning() << "[LoginManager] WARNING: File size mismatch! Expected:" << fileSize 
-                   << "Actual:" << fileInfo.size();
-        // 不返回，继续尝试安装
+    // 与服务器公布的哈希比较，发现损坏或不完整的下载；不一致时删除文件，下次重新完整下载
+    if (!m_publishedSha256.isEmpty()) {
+        if (sha256.compare(m_publishedSha256, Qt::CaseInsensitive) != 0) {
+            qWarning() << "[LoginManager] ERROR: Downloaded file does not match published SHA-256! Published:"
+                       << m_publishedSha256 << "Downloaded:" << sha256;
+            QFile::remove(downloadedFilePath);
+            return;
+        }
+        qDebug() << "[LoginManager] Downloaded file matches published SHA-256";
+    } else {
+        qWarning() << "[LoginManager] Server did not publish a SHA-256 for the update, "
+                      "the download itself cannot be verified";
     }
     
     // 安装更新
     qDebug() << "[LoginManager] Starting update installation...";
-    if (installUpdate(downloadedFilePath)) {
+    if (installUpdate(downloadedFilePath, fileSize, sha256)) {
         qDebug() << "[LoginManager] Update installation initiated successfully";
         emit updateInstallationCompleted();
     } else {
@@ -697,12 +769,64 @@ void LoginManager::compareVersions(const QString& serverVersion)
     }
 }
 
+/**
+ * @brief 复制更新压缩包并计算SHA-256
+ * @param sourcePath 源文件路径
+ * @param targetPath 目标文件路径
+ * @param sha256 输出：复制内容的SHA-256（十六进制）
+ * @return 是否复制成功
+ * 
+ * 分块读写，目标文件通过QSaveFile写入，失败时不会留下不完整的文件
+ */
+bool LoginManager::copyUpdateFile(const QString& sourcePath, const QString& targetPath, QString& sha256)
+{
+    QFile source(sourcePath);
+    if (!source.open(QIODevice::ReadOnly)) {
+        qWarning() << "[LoginManager] Failed to open update file:" << source.errorString();
+        return false;
+    }
+    
+    QSaveFile target(targetPath);
+    if (!target.open(QIODevice::WriteOnly)) {
+        qWarning() << "[LoginManager] Failed to create update.zip:" << target.errorString();
+        return false;
+    }
+    
+    QCryptographicHash hash(QCryptographicHash::Sha256);
+    QByteArray buffer;
+    while (!source.atEnd()) {
+        buffer = source.read(256 * 1024);
+        if (buffer.isEmpty() || target.write(buffer) != buffer.size()) {
+            qWarning() << "[LoginManager] Copy failed:" << source.errorString() << target.errorString();
+            target.cancelWriting();
+            return false;
+        }
+        hash.addData(buffer);
+    }
+    
+    if (!target.commit()) {
+        qWarning() << "[LoginManager] Failed to commit update.zip:" << target.errorString();
+        return false;
+    }
+    
+    sha256 = QString::fromLatin1(hash.result().toHex());
+    return true;
+}
+
 /**
  * @brief 安装更新
  * @param downloadedFilePath 下载的更新压缩包路径
+ * @param expectedSize 下载时写入的字节数
+ * @param expectedSha256 下载时计算的SHA-256（十六进制）
  * @return 是否成功启动安装过程
+ * 
+ * 复制压缩包到应用程序目录时顺带计算哈希，大小或哈希与下载时不一致则拒绝安装，
+ * 不需要为校验再单独读一遍文件。
+ * 
+ * 这里只是磁盘一致性检查：比较的是本客户端下载时自己计算的哈希，只能发现下载完成后文件被改动，
+ * 发现不了下载本身的损坏或截断。下载内容的校验依赖服务器公布的哈希，见 onDownloadAppFileResponse。
  */
-bool LoginManager::installUpdate(const QString& downloadedFilePath)
+bool LoginManager::installUpdate(const QString& downloadedFilePath, qint64 expectedSize, const QString& expectedSha256)
 {
     qDebug() << "[LoginManager] ========== Starting Update Installation ==========";
     qDebug() << "[LoginManager] Downloaded file path:" << downloadedFilePath;
@@ -742,22 +866,30 @@ bool LoginManager::installUpdate(const QString& downloadedFilePath)
     }
     
     qDebug() << "[LoginManager] Copying update file to:" << updateZipPath;
-    if (!QFile::copy(downloadedFilePath, updateZipPath)) {
+    if (downloadedFileInfo.size() != expectedSize) {
+        qWarning() << "[LoginManager] ERROR: File size mismatch! Expected:" << expectedSize
+                   << "Actual:" << downloadedFileInfo.size();
+        return false;
+    }
+    
+    QString copiedSha256;
+    if (!copyUpdateFile(downloadedFilePath, updateZipPath, copiedSha256)) {
         qWarning() << "[LoginManager] ERROR: Failed to copy update file to app directory";
         QFile::Permissions perms = downloadedFileInfo.permissions();
         qWarning() << "[LoginManager] Source file permissions:" << perms;
         return false;
     }
     
-    // 验证复制后的文件
-    QFileInfo copiedFileInfo(updateZipPath);
+    // 验证复制后的文件与下载时的哈希一致（磁盘一致性检查）
     qDebug() << "[LoginManager] Update file copied successfully";
     qDebug() << "[LoginManager] Copied file path:" << updateZipPath;
-    qDebug() << "[LoginManager] Copied file size:" << copiedFileInfo.size() << "bytes";
-    qDebug() << "[LoginManager] Original file size:" << downloadedFileInfo.size() << "bytes";
+    qDebug() << "[LoginManager] Copied file SHA-256:" << copiedSha256;
     
-    if (copiedFileInfo.size() != downloadedFileInfo.size()) {
-        qWarning() << "[LoginManager] WARNING: File size mismatch after copy!";
+    if (expectedSha256.isEmpty() || copiedSha256.compare(expectedSha256, Qt::CaseInsensitive) != 0) {
+        qWarning() << "[LoginManager] ERROR: SHA-256 mismatch, refusing to install! Expected:" << expectedSha256
+                   << "Actual:" << copiedSha256;
+        QFile::remove(updateZipPath);
+        return false;
     }
     
     // 创建更新锁文件，防止用户在更新期间再次启动应用
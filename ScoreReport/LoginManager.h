@@ -77,13 +77,15 @@ private slots:
     void onTimeout();
     void onSystemUpdateListResponse(bool success, const QString& message, const QJsonObject& data);
     void onDownloadAppFileResponse(bool success, const QString& message, const QJsonObject& data);
+    void onDownloadAppFileProgress(qint64 bytesReceived, qint64 bytesTotal);
 private:
     void loadUserList();
     void saveUserList();
     QVariantMap findUserInList(const QString& userId);
     void clearLogFiles();
     void compareVersions(const QString& serverVersion);
-    bool installUpdate(const QString& downloadedFilePath);
+    bool copyUpdateFile(const QString& sourcePath, const QString& targetPath, QString& sha256);
+    bool installUpdate(const QString& downloadedFilePath, qint64 expectedSize, const QString& expectedSha256);
     GlobalTextMonitor* m_selector;
     ApiManager* m_apiManager;
     QSettings* m_settings;
@@ -92,6 +94,9 @@ private:
     QString m_currentStr = "";
     QPoint currentPos;
     bool m_isManual = false;
+    int m_downloadPercentage = -1;
+    int m_downloadRetryCount = 0;
+    QString m_publishedSha256;  // 更新列表中服务器公布的安装包SHA-256，未提供时为空
 };
 
 #endif // LOGINMANAGER_H 
\ No newline at end of file
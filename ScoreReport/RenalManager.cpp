@@ -1,4 +1,5 @@
 ﻿#include "RenalManager.h"
+#include "LogCategories.h"
 #include <QDebug>
 
 RenalManager::RenalManager(QObject *parent)
@@ -53,7 +54,7 @@ void RenalManager::endAnalysis()
         m_apiManager->deleteChatById(currentChatId);
     }
     resetAllParams();
-    m_apiManager->abortRequestsByType("renal-ai-score");
+    m_apiManager->abortRequestsByType(ApiManager::RenalAiScore);
 }
 
 void RenalManager::submitContent(const QString& inputContents)
@@ -146,7 +147,7 @@ void RenalManager::onRenalAiQualityScoreResponse(bool success, const QString& me
             setisCompleted(false);
         }
     } else {
-        qWarning() << "[RenalManager] Renal analysis failed:" << message;
+        LOG_WARNING(lcScorer) << "[RenalManager] Renal analysis failed:" << message;
     }
 }
 
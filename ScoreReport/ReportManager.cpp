@@ -199,7 +199,7 @@ void ReportManager::generateReport(const QString& query, const QVariantList& tem
 }
 
 void ReportManager::endAnalysis() {
-    m_apiManager->abortRequestsByType("generate-quality-report");
+    m_apiManager->abortRequestsByType(ApiManager::GenerateQualityReport);
 }
 
 void ReportManager::onGenerateQualityReportResponse(bool success, const QString& message, const QJsonObject& data)
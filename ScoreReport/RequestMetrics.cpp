@@ -0,0 +1,296 @@
+﻿#include "RequestMetrics.h"
+#include "LogCategories.h"
+#include <QDateTime>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QSaveFile>
+#include <algorithm>
+
+namespace {
+/// @brief 快照中各阶段的字段名，与 RequestMetrics::Phase 顺序一致
+const char* const kPhaseNames[] = { "firstByteMs", "firstTokenMs", "totalMs" };
+
+QJsonArray toJsonArray(const QVector<double>& values)
+{
+    QJsonArray array;
+    for (double value : values) {
+        array.append(value);
+    }
+    return array;
+}
+}
+
+RequestMetrics::RequestMetrics()
+    : m_latencyBounds({ 5, 10, 25, 50, 100, 250, 500, 1000, 2500, 5000, 10000, 30000, 60000, 120000 })
+    , m_byteBounds({ 256, 1024, 4096, 16384, 65536, 262144, 1048576, 4194304, 16777216, 67108864 })
+    , m_since(QDateTime::currentMSecsSinceEpoch())
+    , m_dirty(false)
+{
+}
+
+void RequestMetrics::start(QNetworkReply* reply, const char* typeName, const QString& network)
+{
+    Pending pending;
+    pending.network = network;
+    pending.typeName = typeName;
+    pending.timer.start();
+    std::fill(pending.phaseMs, pending.phaseMs + PhaseCount, -1);
+    pending.bytesIn = 0;
+    pending.bytesOut = 0;
+    m_pending.insert(reply, pending);
+}
+
+void RequestMetrics::markPhase(QNetworkReply* reply, Phase phase)
+{
+    auto it = m_pending.find(reply);
+    if (it != m_pending.end() && it->phaseMs[phase] < 0) {
+        it->phaseMs[phase] = it->timer.elapsed();
+    }
+}
+
+void RequestMetrics::updateBytes(QNetworkReply* reply, qint64 bytesIn, qint64 bytesOut)
+{
+    auto it = m_pending.find(reply);
+    if (it != m_pending.end()) {
+        it->bytesIn = qMax(it->bytesIn, bytesIn);
+        it->bytesOut = qMax(it->bytesOut, bytesOut);
+    }
+}
+
+void RequestMetrics::finish(QNetworkReply* reply)
+{
+    auto it = m_pending.find(reply);
+    if (it == m_pending.end()) {
+        return;
+    }
+    Pending pending = it.value();
+    m_pending.erase(it);
+    m_dirty = true;
+
+    TypeStats& stats = m_stats[pending.network][QString::fromLatin1(pending.typeName)];
+    const QString error = errorClass(reply);
+    if (!error.isEmpty()) {
+        ++stats.errors[error];
+    }
+    if (error == QLatin1String("canceled")) {
+        return;
+    }
+
+    ++stats.count;
+    pending.phaseMs[TotalPhase] = pending.timer.elapsed();
+    for (int phase = 0; phase < PhaseCount; ++phase) {
+        if (pending.phaseMs[phase] >= 0) {
+            stats.phases[phase].add(pending.phaseMs[phase], m_latencyBounds);
+        }
+    }
+    stats.bytesIn.add(pending.bytesIn, m_byteBounds);
+    stats.bytesOut.add(pending.bytesOut, m_byteBounds);
+}
+
+void RequestMetrics::recordApiError(const char* typeName, const QString& network)
+{
+    ++m_stats[network][QString::fromLatin1(typeName)].errors["api"];
+    m_dirty = true;
+}
+
+bool RequestMetrics::takeDirty()
+{
+    const bool dirty = m_dirty;
+    m_dirty = false;
+    return dirty;
+}
+
+QJsonObject RequestMetrics::toJson() const
+{
+    QJsonObject networks;
+    for (auto network = m_stats.constBegin(); network != m_stats.constEnd(); ++network) {
+        QJsonObject types;
+        for (auto type = network->constBegin(); type != network->constEnd(); ++type) {
+            const TypeStats& stats = type.value();
+            QJsonObject typeObj;
+            typeObj["count"] = static_cast<double>(stats.count);
+            for (int phase = 0; phase < PhaseCount; ++phase) {
+                if (stats.phases[phase].count > 0) {
+                    typeObj[kPhaseNames[phase]] = stats.phases[phase].toJson(m_latencyBounds);
+                }
+            }
+            if (stats.bytesIn.count > 0) {
+                typeObj["bytesIn"] = stats.bytesIn.toJson(m_byteBounds);
+                typeObj["bytesOut"] = stats.bytesOut.toJson(m_byteBounds);
+            }
+            QJsonObject errors;
+            for (auto error = stats.errors.constBegin(); error != stats.errors.constEnd(); ++error) {
+                errors[error.key()] = static_cast<double>(error.value());
+            }
+            typeObj["errors"] = errors;
+            types[type.key()] = typeObj;
+        }
+        networks[network.key()] = types;
+    }
+
+    QJsonObject root;
+    root["since"] = QDateTime::fromMSecsSinceEpoch(m_since).toString(Qt::ISODate);
+    root["updated"] = QDateTime::currentDateTime().toString(Qt::ISODate);
+    root["latencyBucketsMs"] = toJsonArray(m_latencyBounds);
+    root["byteBuckets"] = toJsonArray(m_byteBounds);
+    root["networks"] = networks;
+    return root;
+}
+
+bool RequestMetrics::load(const QString& filePath)
+{
+    QFile file(filePath);
+    if (!file.open(QIODevice::ReadOnly)) {
+        return false;
+    }
+    const QJsonObject root = QJsonDocument::fromJson(file.readAll()).object();
+    if (root.value("latencyBucketsMs").toArray() != toJsonArray(m_latencyBounds)
+        || root.value("byteBuckets").toArray() != toJsonArray(m_byteBounds)) {
+        LOG_WARNING(lcNet) << "[RequestMetrics] Bucket layout changed, ignoring" << filePath;
+        return false;
+    }
+
+    const QDateTime since = QDateTime::fromString(root.value("since").toString(), Qt::ISODate);
+    if (since.isValid()) {
+        m_since = qMin(m_since, since.toMSecsSinceEpoch());
+    }
+
+    const QJsonObject networks = root.value("networks").toObject();
+    for (auto network = networks.constBegin(); network != networks.constEnd(); ++network) {
+        const QJsonObject types = network.value().toObject();
+        for (auto type = types.constBegin(); type != types.constEnd(); ++type) {
+            const QJsonObject typeObj = type.value().toObject();
+            TypeStats& stats = m_stats[network.key()][type.key()];
+            stats.count += static_cast<quint64>(typeObj.value("count").toDouble());
+            for (int phase = 0; phase < PhaseCount; ++phase) {
+                stats.phases[phase].merge(typeObj.value(kPhaseNames[phase]).toObject(), m_latencyBounds.size() + 1);
+            }
+            stats.bytesIn.merge(typeObj.value("bytesIn").toObject(), m_byteBounds.size() + 1);
+            stats.bytesOut.merge(typeObj.value("bytesOut").toObject(), m_byteBounds.size() + 1);
+            const QJsonObject errors = typeObj.value("errors").toObject();
+            for (auto error = errors.constBegin(); error != errors.constEnd(); ++error) {
+                stats.errors[error.key()] += static_cast<quint64>(error.value().toDouble());
+            }
+        }
+    }
+    return true;
+}
+
+bool RequestMetrics::save(const QString& filePath) const
+{
+    QDir().mkpath(QFileInfo(filePath).absolutePath());
+    QSaveFile file(filePath);
+    if (!file.open(QIODevice::WriteOnly)) {
+        LOG_WARNING(lcNet) << "[RequestMetrics] Failed to save" << filePath << file.errorString();
+        return false;
+    }
+    file.write(QJsonDocument(toJson()).toJson(QJsonDocument::Indented));
+    return file.commit();
+}
+
+QString RequestMetrics::errorClass(QNetworkReply* reply)
+{
+    switch (reply->error()) {
+    case QNetworkReply::NoError:
+        return QString();
+    case QNetworkReply::OperationCanceledError:
+        return QStringLiteral("canceled");
+    case QNetworkReply::TimeoutError:
+        return QStringLiteral("timeout");
+    case QNetworkReply::HostNotFoundError:
+        return QStringLiteral("dns");
+    case QNetworkReply::ConnectionRefusedError:
+    case QNetworkReply::RemoteHostClosedError:
+    case QNetworkReply::TemporaryNetworkFailureError:
+    case QNetworkReply::NetworkSessionFailedError:
+    case QNetworkReply::UnknownNetworkError:
+        return QStringLiteral("connect");
+    case QNetworkReply::SslHandshakeFailedError:
+        return QStringLiteral("tls");
+    default:
+        break;
+    }
+
+    const int status = reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt();
+    if (status >= 500) {
+        return QStringLiteral("http5xx");
+    }
+    if (status >= 400) {
+        return QStringLiteral("http4xx");
+    }
+    return QStringLiteral("other");
+}
+
+void RequestMetrics::Histogram::add(double value, const QVector<double>& bounds)
+{
+    if (buckets.isEmpty()) {
+        buckets.fill(0, bounds.size() + 1);
+    }
+    const int index = static_cast<int>(std::lower_bound(bounds.constBegin(), bounds.constEnd(), value) - bounds.constBegin());
+    ++buckets[index];
+    ++count;
+    sum += value;
+    max = qMax(max, value);
+}
+
+void RequestMetrics::Histogram::merge(const QJsonObject& json, int bucketCount)
+{
+    const QJsonArray array = json.value("buckets").toArray();
+    if (array.size() != bucketCount) {
+        return;
+    }
+    if (buckets.isEmpty()) {
+        buckets.fill(0, bucketCount);
+    }
+    for (int i = 0; i < bucketCount; ++i) {
+        buckets[i] += static_cast<quint32>(array.at(i).toDouble());
+    }
+    count += static_cast<quint64>(json.value("count").toDouble());
+    sum += json.value("sum").toDouble();
+    max = qMax(max, json.value("max").toDouble());
+}
+
+QJsonObject RequestMetrics::Histogram::toJson(const QVector<double>& bounds) const
+{
+    QJsonArray bucketArray;
+    for (quint32 value : buckets) {
+        bucketArray.append(static_cast<double>(value));
+    }
+
+    QJsonObject json;
+    json["count"] = static_cast<double>(count);
+    json["sum"] = sum;
+    json["max"] = max;
+    json["mean"] = count > 0 ? sum / count : 0.0;
+    json["p50"] = percentile(0.5, bounds);
+    json["p95"] = percentile(0.95, bounds);
+    json["buckets"] = bucketArray;
+    return json;
+}
+
+double RequestMetrics::Histogram::percentile(double q, const QVector<double>& bounds) const
+{
+    if (count == 0) {
+        return 0;
+    }
+
+    // 在目标所在的桶内线性插值，最后一个桶以最大值为上界
+    const double target = q * count;
+    double cumulative = 0;
+    for (int i = 0; i < buckets.size(); ++i) {
+        if (buckets.at(i) == 0) {
+            continue;
+        }
+        if (cumulative + buckets.at(i) >= target) {
+            const double lower = (i == 0) ? 0 : bounds.at(i - 1);
+            const double upper = qMin(max, (i < bounds.size()) ? bounds.at(i) : max);
+            const double fraction = (target - cumulative) / buckets.at(i);
+            return lower + (qMax(lower, upper) - lower) * fraction;
+        }
+        cumulative += buckets.at(i);
+    }
+    return max;
+}
@@ -0,0 +1,115 @@
+﻿#ifndef REQUESTMETRICS_H
+#define REQUESTMETRICS_H
+
+#include <QString>
+#include <QHash>
+#include <QMap>
+#include <QVector>
+#include <QElapsedTimer>
+#include <QJsonObject>
+#include <QNetworkReply>
+
+/**
+ * @brief 按请求类型统计的网络请求耗时和流量
+ *
+ * ApiManager 在发出请求时调用 start()，各阶段到达时调用 markPhase()，请求完成时调用 finish()。
+ * 统计按网络（public / internal）和请求类型（s_requestTable 中的名称）分组，每组包括：
+ * - 首字节、首个流式文本（仅流式请求）、总耗时的直方图（毫秒）
+ * - 收发字节数的直方图
+ * - 按错误类别计数，如 timeout / dns / connect / tls / http4xx / http5xx / api / canceled
+ *
+ * 直方图使用固定的对数分桶，可以跨次运行累加：启动时 load() 读取上次的快照，之后继续累加。
+ * 被取消的请求只计入错误类别，不计入耗时和流量。
+ *
+ * Qt 5 的 QNetworkReply 不报告连接建立时间（http 连接没有 encrypted 信号，连接池复用时也无从区分），
+ * 因此不单独统计连接阶段，连接耗时包含在首字节时间中。
+ */
+class RequestMetrics
+{
+public:
+    /// @brief 请求的计时阶段
+    enum Phase {
+        FirstBytePhase,     ///< 收到响应头
+        FirstTokenPhase,    ///< 流式请求收到第一段文本
+        TotalPhase,         ///< 请求完成
+        PhaseCount
+    };
+
+    RequestMetrics();
+
+    /**
+     * @brief 开始跟踪一个请求
+     * @param reply 网络回复对象
+     * @param typeName 请求类型名称
+     * @param network 网络名称，public 或 internal
+     */
+    void start(QNetworkReply* reply, const char* typeName, const QString& network);
+
+    /// @brief 记录请求到达某个阶段的时间，每个阶段只记录第一次
+    void markPhase(QNetworkReply* reply, Phase phase);
+
+    /// @brief 更新请求已接收/已发送的字节数，取最大值
+    void updateBytes(QNetworkReply* reply, qint64 bytesIn, qint64 bytesOut);
+
+    /**
+     * @brief 请求完成，把各阶段耗时和流量计入直方图
+     * @param reply 网络回复对象（仍可读取错误和HTTP状态）
+     */
+    void finish(QNetworkReply* reply);
+
+    /// @brief 请求在传输层成功但服务器返回失败（code != 0）
+    void recordApiError(const char* typeName, const QString& network);
+
+    /// @brief 自上次 takeDirty() 以来是否有新数据
+    bool takeDirty();
+
+    /// @brief 导出快照，包含分桶边界、各组直方图及由直方图估算的 p50 / p95
+    QJsonObject toJson() const;
+
+    /// @brief 读取保存的快照并与当前数据合并，分桶边界不一致时忽略
+    bool load(const QString& filePath);
+
+    /// @brief 保存快照
+    bool save(const QString& filePath) const;
+
+private:
+    struct Histogram {
+        QVector<quint32> buckets;       ///< 与边界对应，最后一个桶为超出最大边界的部分
+        quint64 count = 0;
+        double sum = 0;
+        double max = 0;
+
+        void add(double value, const QVector<double>& bounds);
+        void merge(const QJsonObject& json, int bucketCount);
+        QJsonObject toJson(const QVector<double>& bounds) const;
+        double percentile(double q, const QVector<double>& bounds) const;
+    };
+
+    struct TypeStats {
+        quint64 count = 0;
+        Histogram phases[PhaseCount];
+        Histogram bytesIn;
+        Histogram bytesOut;
+        QMap<QString, quint64> errors;
+    };
+
+    struct Pending {
+        QString network;
+        const char* typeName;
+        QElapsedTimer timer;
+        qint64 phaseMs[PhaseCount];
+        qint64 bytesIn;
+        qint64 bytesOut;
+    };
+
+    static QString errorClass(QNetworkReply* reply);
+
+    QHash<QNetworkReply*, Pending> m_pending;
+    QMap<QString, QMap<QString, TypeStats>> m_stats;    ///< 网络 -> 请求类型 -> 统计
+    QVector<double> m_latencyBounds;                    ///< 耗时分桶上界（毫秒）
+    QVector<double> m_byteBounds;                       ///< 字节数分桶上界
+    qint64 m_since;                                     ///< 统计开始时间（毫秒时间戳）
+    bool m_dirty;
+};
+
+#endif // REQUESTMETRICS_H
@@ -23,7 +23,31 @@ SOURCES += ./main.cpp \
     ./HistoryManager.cpp \
     ./LanguageManager.cpp \
     ./UCLSMRSManager.cpp \
-    ./ChatManager.cpp
+    ./ChatManager.cpp \
+    ./XGBoostModel.cpp \
+    ./SseParser.cpp \
+    ./StreamSession.cpp \
+    ./DownloadSession.cpp \
+    ./DocxReader.cpp \
+    ./ExtractedTextCache.cpp \
+    ./ChatMessageModel.cpp \
+    ./ChunkedTextBuffer.cpp \
+    ./UiFlushScheduler.cpp \
+    ./KnowledgeUploadQueue.cpp \
+    ./KnowledgeFileLedger.cpp \
+    ./HistoryStore.cpp \
+    ./HistorySearchIndex.cpp \
+    ./HistoryListModel.cpp \
+    ./AsyncLogger.cpp \
+    ./LogArchiver.cpp \
+    ./LogCategories.cpp \
+    ./RequestMetrics.cpp \
+    ./KnowledgeManager.cpp \
+    ./KnowledgeChatManager.cpp \
+    ./ReportManager.cpp \
+    ./DiagnosisResultManager.cpp \
+    ./GlobalMouseListener.cpp \
+    ./GlobalTextMonitor.cpp
 
 HEADERS += ./LoginManager.h \
     ./CCLSScorer.h \
@@ -36,7 +60,32 @@ HEADERS += ./LoginManager.h \
     ./CommonFunc.h \
     ./LanguageManager.h \
     ./UCLSMRSManager.h \
-    ./ChatManager.h
+    ./ChatManager.h \
+    ./XGBoostModel.h \
+    ./SseParser.h \
+    ./StreamSession.h \
+    ./DownloadSession.h \
+    ./DocxReader.h \
+    ./ExtractedTextCache.h \
+    ./ChatMessageModel.h \
+    ./ChunkedTextBuffer.h \
+    ./UiFlushScheduler.h \
+    ./KnowledgeUploadQueue.h \
+    ./KnowledgeFileLedger.h \
+    ./HistoryStore.h \
+    ./HistorySearchIndex.h \
+    ./HistoryListModel.h \
+    ./AsyncLogger.h \
+    ./LogArchiver.h \
+    ./LogCategories.h \
+    ./RequestMetrics.h \
+    ./KnowledgeManager.h \
+    ./KnowledgeChatManager.h \
+    ./ReportManager.h \
+    ./DiagnosisResultManager.h \
+    ./GlobalMouseListener.h \
+    ./GlobalTextMonitor.h \
+    ./Version.h
 RESOURCES += qml.qrc
 
 # 翻译文件配置
@@ -0,0 +1,133 @@
+"""
+生成 CCLS-AI 全输入空间（144种组合）的基准结果表 Scripts/model/ccls_ai_golden.csv。
+
+直接调用 kidney_processor.py 中的 CCLS() / calculate_CCLS() / calculate_CCRCC()，
+调试版本的 ScoreReport --ccls-golden 用这张表校验进程内的 XGBoost 推理与 Python 结果一致。
+
+用法（在 ScoreReport 目录下运行）：
+    python Scripts/python/make_golden_table.py
+
+已安装 xgboost / pandas 时使用真实的 XGBClassifier.predict_proba；
+未安装时以纯Python的参考实现代替 xgboost 模块（逐棵树按 float32 比较和累加，
+只使用前 best_iteration+1 轮），表头注释中会注明生成方式。
+"""
+import csv
+import json
+import math
+import os
+import struct
+import sys
+import types
+
+MODEL_PATH = 'Scripts/model/model_fold_1.json'
+OUTPUT_PATH = 'Scripts/model/ccls_ai_golden.csv'
+
+
+def f32(value):
+    """按 float32 舍入"""
+    return struct.unpack('f', struct.pack('f', value))[0]
+
+
+class ReferenceClassifier:
+    """XGBClassifier 的最小替代：只支持 gbtree + binary:logistic 的 predict_proba"""
+
+    def __init__(self):
+        self.base_score = None
+
+    def load_model(self, model_path):
+        with open(model_path, encoding='utf-8') as f:
+            learner = json.load(f)['learner']
+        self.trees = learner['gradient_booster']['model']['trees']
+        self.attributes = learner.get('attributes', {})
+        self.model_base_score = float(learner['learner_model_param']['base_score'])
+        best_iteration = self.attributes.get('best_iteration')
+        self.tree_limit = int(best_iteration) + 1 if best_iteration is not None else len(self.trees)
+
+    def set_params(self, **params):
+        if 'base_score' in params:
+            self.base_score = params['base_score']
+        return self
+
+    def get_booster(self):
+        owner = self
+
+        class Booster:
+            def attr(self, key):
+                if key == 'base_score':
+                    return str(owner.base_score)
+                return owner.attributes.get(key)
+        return Booster()
+
+    def _margin(self, row):
+        prob = f32(self.base_score if self.base_score is not None else self.model_base_score)
+        margin = f32(-math.log(1.0 / prob - 1.0))
+        for tree in self.trees[:self.tree_limit]:
+            node = 0
+            while tree['left_children'][node] != -1:
+                value = f32(row[tree['split_indices'][node]])
+                if value < f32(tree['split_conditions'][node]):
+                    node = tree['left_children'][node]
+                else:
+                    node = tree['right_children'][node]
+            margin = f32(margin + f32(tree['split_conditions'][node]))  # 叶子权重保存在 split_conditions 中
+        return margin
+
+    def predict_proba(self, rows):
+        result = []
+        for row in rows:
+            p = f32(1.0 / (1.0 + math.exp(-self._margin(row))))
+            result.append([f32(1.0 - p), p])
+        return result
+
+    def predict(self, rows):
+        return [1 if p[1] > 0.5 else 0 for p in self.predict_proba(rows)]
+
+
+def install_reference_modules():
+    """xgboost 不可用时注入替代模块，使 kidney_processor.py 可以原样导入"""
+    xgb = types.ModuleType('xgboost')
+    xgb.XGBClassifier = ReferenceClassifier
+    pd = types.ModuleType('pandas')
+    pd.DataFrame = lambda data, columns=None: [list(row) for row in data]
+    sklearn = types.ModuleType('sklearn')
+    metrics = types.ModuleType('sklearn.metrics')
+    metrics.accuracy_score = metrics.roc_auc_score = lambda *args, **kwargs: 0.0
+    sklearn.metrics = metrics
+    np = types.ModuleType('numpy')
+    np.random = types.SimpleNamespace(seed=lambda seed: None)
+    sys.modules.update({'xgboost': xgb, 'pandas': pd, 'sklearn': sklearn,
+                        'sklearn.metrics': metrics, 'numpy': np})
+
+
+def main():
+    try:
+        import xgboost  # noqa: F401
+        import pandas  # noqa: F401
+        backend = 'xgboost ' + xgboost.__version__
+    except ImportError:
+        install_reference_modules()
+        backend = 'reference evaluator (xgboost not installed)'
+
+    sys.path.insert(0, os.path.dirname(os.path.abspath(__file__)))
+    import kidney_processor as kp
+
+    with open(OUTPUT_PATH, 'w', newline='', encoding='utf-8') as f:
+        f.write('# generated by Scripts/python/make_golden_table.py from %s using %s\n' % (MODEL_PATH, backend))
+        writer = csv.writer(f)
+        writer.writerow(['t2', 'enhancement', 'micro', 'sei', 'ader', 'disp', 'cclsLevel', 'ccls', 'ccrcc'])
+        for t2 in range(3):
+            for enhancement in range(3):
+                for micro in range(2):
+                    for sei in range(2):
+                        for ader in range(2):
+                            for disp in range(2):
+                                inputs = [t2, enhancement, micro, sei, ader, disp]
+                                level = kp.CCLS(*[str(v) for v in inputs])
+                                ccls = kp.calculate_CCLS(*inputs)
+                                ccrcc = float(kp.calculate_CCRCC(*inputs, ccls))
+                                writer.writerow(inputs + [level, ccls, '%.9g' % ccrcc])
+    print('wrote 144 rows to %s (%s)' % (OUTPUT_PATH, backend))
+
+
+if __name__ == '__main__':
+    main()
@@ -0,0 +1,126 @@
+﻿#include "SseParser.h"
+#include <cstring>
+
+SseParser::SseParser()
+    : m_scanPos(0)
+    , m_skipLeadingNewlines(false)
+{
+}
+
+void SseParser::reset()
+{
+    m_buffer.clear();
+    m_scanPos = 0;
+    m_skipLeadingNewlines = false;
+}
+
+void SseParser::feed(const QByteArray& chunk, QVector<Event>& events)
+{
+    const char* input = chunk.constData();
+    int inputSize = chunk.size();
+
+    // 上一个事件恰好在块末尾结束时，下一块开头的换行符是同一个分隔符的剩余部分
+    if (m_skipLeadingNewlines) {
+        int skip = 0;
+        while (skip < inputSize && input[skip] == '\n') {
+            ++skip;
+        }
+        if (skip == inputSize) {
+            return;
+        }
+        input += skip;
+        inputSize -= skip;
+        m_skipLeadingNewlines = false;
+    }
+    if (inputSize == 0) {
+        return;
+    }
+
+    m_buffer.append(input, inputSize);
+
+    const char* data = m_buffer.constData();
+    const int size = m_buffer.size();
+    int eventStart = 0;
+    int pos = m_scanPos;
+
+    while (pos < size) {
+        const char* newline = static_cast<const char*>(std::memchr(data + pos, '\n', size - pos));
+        if (!newline) {
+            pos = size;
+            break;
+        }
+
+        const int runStart = static_cast<int>(newline - data);
+        int runEnd = runStart;
+        while (runEnd < size && data[runEnd] == '\n') {
+            ++runEnd;
+        }
+
+        if (runEnd - runStart < 2) {
+            if (runEnd == size) {
+                // 单个换行符位于末尾，可能是分隔符的前半部分，下次从这里重新扫描
+                pos = runStart;
+                break;
+            }
+            pos = runEnd;
+            continue;
+        }
+
+        // 连续两个换行符为事件边界，多出的换行符属于data内容
+        parseEvent(data + eventStart, data + runStart, runEnd - runStart - 2, events);
+        eventStart = runEnd;
+        pos = runEnd;
+        if (runEnd == size) {
+            m_skipLeadingNewlines = true;
+        }
+    }
+
+    // 只保留未完成事件的尾部
+    if (eventStart > 0) {
+        m_buffer.remove(0, eventStart);
+    }
+    m_scanPos = pos - eventStart;
+}
+
+void SseParser::parseEvent(const char* begin, const char* end, int extraNewlines, QVector<Event>& events) const
+{
+    QByteArray type;
+    const char* dataBegin = nullptr;
+    const char* dataEnd = nullptr;
+
+    const char* lineBegin = begin;
+    while (lineBegin < end) {
+        const char* lineEnd = static_cast<const char*>(std::memchr(lineBegin, '\n', end - lineBegin));
+        if (!lineEnd) {
+            lineEnd = end;
+        }
+
+        const int lineLength = static_cast<int>(lineEnd - lineBegin);
+        if (lineLength >= 5 && std::memcmp(lineBegin, "data:", 5) == 0) {
+            // data行保持原始格式，不去除空格；多行data时以最后一行为准
+            dataBegin = lineBegin + 5;
+            dataEnd = lineEnd;
+        } else {
+            QByteArray line = QByteArray::fromRawData(lineBegin, lineLength).trimmed();
+            if (line.startsWith("event:")) {
+                type = line.mid(6).trimmed();
+            }
+        }
+
+        lineBegin = lineEnd + 1;
+    }
+
+    if (type.isEmpty() && !dataBegin) {
+        return;
+    }
+
+    Event event;
+    event.type = QString::fromLatin1(type);
+    if (dataBegin) {
+        event.data = QString::fromUtf8(dataBegin, static_cast<int>(dataEnd - dataBegin));
+        if (extraNewlines > 0) {
+            event.data.append(QString(extraNewlines, QLatin1Char('\n')));
+        }
+    }
+    events.append(event);
+}
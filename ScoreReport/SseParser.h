@@ -0,0 +1,49 @@
+﻿#ifndef SSEPARSER_H
+#define SSEPARSER_H
+
+#include <QByteArray>
+#include <QString>
+#include <QVector>
+
+/**
+ * @brief Server-Sent Events 增量解析器
+ *
+ * 直接在 QNetworkReply::readAll() 得到的字节流上工作：
+ * - 每次只扫描新到达的字节，缓冲区中只保留尚未结束的事件尾部
+ * - 事件以连续两个及以上的 '\n' 结束，多出的换行符属于 data 内容
+ *   （与服务端约定一致：原先的 <<DOUBLE_NEWLINE>> / <<SINGLE_NEWLINE>> 处理）
+ * - 每个完整事件的 data 只做一次 UTF-8 解码
+ */
+class SseParser
+{
+public:
+    /// @brief 一个完整的SSE事件
+    struct Event {
+        QString type;   ///< event: 字段（已去除首尾空白）
+        QString data;   ///< data: 字段（保留原始空格及附加换行符）
+    };
+
+    SseParser();
+
+    /**
+     * @brief 输入一个新的数据块
+     * @param chunk 网络层读到的原始字节
+     * @param events 解析出的完整事件追加到此列表
+     */
+    void feed(const QByteArray& chunk, QVector<Event>& events);
+
+    /// @brief 清空内部状态
+    void reset();
+
+    /// @brief 当前缓冲的未完成字节数
+    int pendingBytes() const { return m_buffer.size(); }
+
+private:
+    void parseEvent(const char* begin, const char* end, int extraNewlines, QVector<Event>& events) const;
+
+    QByteArray m_buffer;            ///< 未完成事件的字节
+    int m_scanPos;                  ///< m_buffer 中已扫描过、确认不含事件边界的位置
+    bool m_skipLeadingNewlines;     ///< 上一个事件在块末尾结束，跳过下一块开头残余的换行符
+};
+
+#endif // SSEPARSER_H
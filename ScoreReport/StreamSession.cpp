@@ -0,0 +1,21 @@
+﻿#include "StreamSession.h"
+
+namespace {
+/// @brief 回复对象上保存会话指针的动态属性名
+const char* const kSessionProperty = "_streamSession";
+}
+
+StreamSession::StreamSession(Kind kind, const QString& chatId, QNetworkReply* reply)
+    : QObject(reply)
+    , m_kind(kind)
+    , m_chatId(chatId)
+    , m_reply(reply)
+    , m_finished(false)
+{
+    reply->setProperty(kSessionProperty, QVariant::fromValue(this));
+}
+
+StreamSession* StreamSession::fromReply(QNetworkReply* reply)
+{
+    return reply ? reply->property(kSessionProperty).value<StreamSession*>() : nullptr;
+}
@@ -0,0 +1,58 @@
+﻿#ifndef STREAMSESSION_H
+#define STREAMSESSION_H
+
+#include <QObject>
+#include <QString>
+#include <QNetworkReply>
+#include "SseParser.h"
+
+/**
+ * @brief 单个流式请求的会话状态
+ *
+ * 每个流式回复（普通流式聊天 / 知识库流式聊天）对应一个StreamSession，
+ * 集中保存SSE解析器和会话ID。解析出的文本逐条发出，
+ * 合并到UI的工作由各聊天管理器通过 UiFlushScheduler 按渲染帧完成。
+ *
+ * StreamSession 以 QNetworkReply 为父对象，随回复对象一起销毁，无需额外清理；
+ * 通过 fromReply() 从回复对象上直接取回，不需要按回复指针查表。
+ */
+class StreamSession : public QObject
+{
+    Q_OBJECT
+
+public:
+    /// @brief 流式请求种类
+    enum Kind {
+        Chat,           ///< /admin/Ai/chat
+        KnowledgeChat   ///< /admin/Ai/doc/chat
+    };
+
+    /**
+     * @brief 创建会话并挂载到回复对象上
+     * @param kind 流式请求种类
+     * @param chatId 会话ID
+     * @param reply 对应的网络回复，同时作为父对象
+     */
+    StreamSession(Kind kind, const QString& chatId, QNetworkReply* reply);
+
+    /// @brief 取回挂载在回复对象上的会话，非流式请求返回nullptr
+    static StreamSession* fromReply(QNetworkReply* reply);
+
+    Kind kind() const { return m_kind; }
+    const QString& chatId() const { return m_chatId; }
+    QNetworkReply* reply() const { return m_reply; }
+    SseParser& parser() { return m_parser; }
+
+    /// @brief 会话是否已经结束（完成信号已发出或已被终止）
+    bool isFinished() const { return m_finished; }
+    void setFinished() { m_finished = true; }
+
+private:
+    Kind m_kind;
+    QString m_chatId;
+    QNetworkReply* m_reply;
+    SseParser m_parser;
+    bool m_finished;
+};
+
+#endif // STREAMSESSION_H
@@ -1,4 +1,5 @@
 ﻿#include "TNMManager.h"
+#include "LogCategories.h"
 #include <QDebug>
 
 TNMManager::TNMManager(QObject *parent)
@@ -69,8 +70,8 @@ void TNMManager::endAnalysis()
         m_apiManager->deleteChatById(currentChatId);
     }
     resetAllParams();
-    m_apiManager->abortRequestsByType("tnm-ai-score");
-    m_apiManager->abortRequestsByType("cancer-diagnose-type");
+    m_apiManager->abortRequestsByType(ApiManager::TnmAiScore);
+    m_apiManager->abortRequestsByType(ApiManager::CancerDiagnoseType);
     
     // 重置癌种相关状态
     setisDetectingCancer(false);
@@ -228,7 +229,7 @@ void TNMManager::onTnmAiQualityScoreResponse(bool success, const QString& messag
             setisCompleted(false);
         }
     } else {
-        qWarning() << "[TNMManager] TNM analysis failed:" << message;
+        LOG_WARNING(lcScorer) << "[TNMManager] TNM analysis failed:" << message;
     }
 }
 
@@ -261,7 +262,7 @@ void TNMManager::onCancerDiagnoseTypeResponse(bool success, const QString& messa
         setcancerTypes(cancerList);
         setshowCancerSelection(true);
     } else {
-        qWarning() << "[TNMManager] Cancer diagnosis failed:" << message;
+        LOG_WARNING(lcScorer) << "[TNMManager] Cancer diagnosis failed:" << message;
         // 癌种检测失败，直接进行TNM分析
         skipCancerSelection();
     }
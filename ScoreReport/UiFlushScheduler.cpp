@@ -0,0 +1,208 @@
+﻿#include "UiFlushScheduler.h"
+#include "LogCategories.h"
+#include <QGuiApplication>
+#include <QScreen>
+#include <QDebug>
+
+namespace {
+/// @brief 没有新帧时的兜底刷新间隔（毫秒）
+const int kFallbackIntervalMs = 100;
+/// @brief 渲染跟不上时的最大刷新间隔（帧）
+const int kMaxFramesPerFlush = 8;
+/// @brief 帧耗时平滑系数
+const double kFrameTimeSmoothing = 0.2;
+}
+
+UiFlushScheduler::UiFlushScheduler(QObject* parent)
+    : QObject(parent)
+    , m_updatesPerSecond(0)
+    , m_requestsPerSecond(0)
+    , m_framesPerFlush(1)
+    , m_frameTimeMs(0.0)
+    , m_frameRequested(false)
+    , m_framesSinceFlush(0)
+    , m_flushCount(0)
+    , m_requestCount(0)
+{
+    m_fallbackTimer.setSingleShot(true);
+    m_fallbackTimer.setInterval(kFallbackIntervalMs);
+    connect(&m_fallbackTimer, &QTimer::timeout, this, &UiFlushScheduler::runPendingFlushes);
+
+    m_statisticsTimer.setInterval(1000);
+    connect(&m_statisticsTimer, &QTimer::timeout, this, &UiFlushScheduler::updateStatistics);
+
+    connect(qGuiApp, &QGuiApplication::focusWindowChanged, this, &UiFlushScheduler::onFocusWindowChanged);
+}
+
+void UiFlushScheduler::attachWindow(QQuickWindow* window)
+{
+    if (!window || window == m_window) {
+        return;
+    }
+
+    if (m_window) {
+        disconnect(m_window, &QQuickWindow::frameSwapped, this, &UiFlushScheduler::onFrameSwapped);
+    }
+    m_window = window;
+    m_frameRequested = false;
+
+    // frameSwapped 在渲染线程中发出，排队到GUI线程处理
+    connect(window, &QQuickWindow::frameSwapped, this, &UiFlushScheduler::onFrameSwapped, Qt::QueuedConnection);
+
+    if (!m_pending.isEmpty()) {
+        requestFrame();
+    }
+}
+
+void UiFlushScheduler::onFocusWindowChanged(QWindow* window)
+{
+    if (QQuickWindow* quickWindow = qobject_cast<QQuickWindow*>(window)) {
+        attachWindow(quickWindow);
+    }
+}
+
+void UiFlushScheduler::requestFlush(QObject* client, const std::function<void()>& flush)
+{
+    ++m_requestCount;
+    if (!m_statisticsTimer.isActive()) {
+        m_statisticsTimer.start();
+    }
+
+    bool merged = false;
+    for (PendingFlush& pending : m_pending) {
+        if (pending.client == client) {
+            pending.flush = flush;
+            merged = true;
+            break;
+        }
+    }
+    if (!merged) {
+        PendingFlush pending;
+        pending.client = client;
+        pending.flush = flush;
+        m_pending.append(pending);
+    }
+
+    requestFrame();
+}
+
+void UiFlushScheduler::flushNow(QObject* client)
+{
+    std::function<void()> flush;
+    if (takePending(client, flush)) {
+        ++m_flushCount;
+        flush();
+    }
+}
+
+void UiFlushScheduler::cancel(QObject* client)
+{
+    std::function<void()> flush;
+    takePending(client, flush);
+}
+
+bool UiFlushScheduler::takePending(QObject* client, std::function<void()>& flush)
+{
+    for (int i = 0; i < m_pending.size(); ++i) {
+        if (m_pending.at(i).client == client) {
+            flush = m_pending.at(i).flush;
+            m_pending.removeAt(i);
+            if (m_pending.isEmpty()) {
+                m_fallbackTimer.stop();
+            }
+            return true;
+        }
+    }
+    return false;
+}
+
+void UiFlushScheduler::requestFrame()
+{
+    if (!m_fallbackTimer.isActive()) {
+        m_fallbackTimer.start();
+    }
+
+    if (m_frameRequested || !m_window || !m_window->isExposed()) {
+        return;
+    }
+    m_frameRequested = true;
+    m_frameClock.start();
+    m_window->update();
+}
+
+void UiFlushScheduler::onFrameSwapped()
+{
+    if (m_frameRequested) {
+        m_frameRequested = false;
+        adaptToFrameTime(m_frameClock.nsecsElapsed() / 1000000.0);
+    }
+
+    if (m_pending.isEmpty()) {
+        return;
+    }
+
+    // 渲染跟不上时隔几帧刷新一次，其余帧只继续请求下一帧
+    if (++m_framesSinceFlush >= m_framesPerFlush) {
+        runPendingFlushes();
+    } else {
+        // 后备定时器只在没有新帧时触发，收到新帧后重新计时
+        m_fallbackTimer.start();
+        requestFrame();
+    }
+}
+
+void UiFlushScheduler::adaptToFrameTime(double frameTimeMs)
+{
+    const double smoothed = m_frameTimeMs <= 0.0
+        ? frameTimeMs
+        : m_frameTimeMs + (frameTimeMs - m_frameTimeMs) * kFrameTimeSmoothing;
+    setframeTimeMs(smoothed);
+
+    // 请求帧后通常在1~2个刷新周期内完成交换，超过3个周期说明渲染线程已经落后
+    qreal refreshRate = (m_window && m_window->screen()) ? m_window->screen()->refreshRate() : 60.0;
+    const double frameInterval = 1000.0 / (refreshRate > 0 ? refreshRate : 60.0);
+
+    if (smoothed > frameInterval * 3) {
+        setframesPerFlush(qMin(m_framesPerFlush * 2, kMaxFramesPerFlush));
+    } else if (smoothed < frameInterval * 2 && m_framesPerFlush > 1) {
+        setframesPerFlush(m_framesPerFlush - 1);
+    }
+}
+
+void UiFlushScheduler::runPendingFlushes()
+{
+    m_fallbackTimer.stop();
+    m_framesSinceFlush = 0;
+
+    // 刷新函数中可能再次登记刷新，先取出当前列表
+    QVector<PendingFlush> pending;
+    pending.swap(m_pending);
+    for (const PendingFlush& item : pending) {
+        if (item.client) {
+            ++m_flushCount;
+            item.flush();
+        }
+    }
+
+    if (!m_pending.isEmpty()) {
+        requestFrame();
+    }
+}
+
+void UiFlushScheduler::updateStatistics()
+{
+    setupdatesPerSecond(m_flushCount);
+    setrequestsPerSecond(m_requestCount);
+
+    if (m_flushCount > 0) {
+        LOG_DEBUG(lcUi) << "[UiFlushScheduler] UI updates/s:" << m_flushCount << "requests/s:" << m_requestCount
+                        << "frame time(ms):" << m_frameTimeMs << "frames per flush:" << m_framesPerFlush;
+    }
+
+    // 空闲一个统计周期后停止计时
+    if (m_flushCount == 0 && m_requestCount == 0 && m_pending.isEmpty()) {
+        m_statisticsTimer.stop();
+    }
+    m_flushCount = 0;
+    m_requestCount = 0;
+}
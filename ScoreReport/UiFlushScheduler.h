@@ -0,0 +1,89 @@
+﻿#ifndef UIFLUSHSCHEDULER_H
+#define UIFLUSHSCHEDULER_H
+
+#include <QObject>
+#include <QPointer>
+#include <QTimer>
+#include <QVector>
+#include <QElapsedTimer>
+#include <QQuickWindow>
+#include <functional>
+#include "CommonFunc.h"
+
+/**
+ * @brief 与QML渲染帧对齐的UI刷新调度器
+ *
+ * 流式回答的文本先累积在 ChatMessageModel 中，再通过 requestFlush() 登记刷新。
+ * 同一个对象在一帧内多次登记只保留一次，所有待刷新内容在窗口的 frameSwapped 之后
+ * 统一推送到模型，每帧最多刷新一次：
+ * - 有待刷新内容时调用 QQuickWindow::update() 请求下一帧，空闲时不触发任何渲染
+ * - 统计从请求帧到帧交换的耗时，渲染线程跟不上刷新率时加倍刷新间隔（最多每8帧一次），
+ *   恢复后逐步减回每帧一次
+ * - 窗口不可见或长时间没有新帧时由后备定时器兜底刷新
+ *
+ * 跟踪当前获得焦点的 QQuickWindow，main.cpp 中先关联主窗口。
+ */
+class UiFlushScheduler : public QObject
+{
+    Q_OBJECT
+
+    SINGLETON_CLASS(UiFlushScheduler)
+
+    /// @brief 最近一秒内实际执行的UI刷新次数
+    QUICK_PROPERTY(int, updatesPerSecond)
+
+    /// @brief 最近一秒内收到的刷新请求次数（合并前）
+    QUICK_PROPERTY(int, requestsPerSecond)
+
+    /// @brief 当前每隔多少帧刷新一次
+    QUICK_PROPERTY(int, framesPerFlush)
+
+    /// @brief 平滑后的帧耗时（毫秒，从请求帧到帧交换）
+    QUICK_PROPERTY(double, frameTimeMs)
+
+public:
+    /// @brief 关联用于对齐刷新的窗口
+    void attachWindow(QQuickWindow* window);
+
+    /**
+     * @brief 登记一次刷新，在下一个刷新时机调用
+     * @param client 发起刷新的对象，同一对象的多次登记合并为一次；对象销毁后自动忽略
+     * @param flush 刷新函数，在GUI线程中调用
+     */
+    void requestFlush(QObject* client, const std::function<void()>& flush);
+
+    /// @brief 立即执行指定对象已登记的刷新（流结束时使用）
+    void flushNow(QObject* client);
+
+    /// @brief 取消指定对象已登记的刷新
+    void cancel(QObject* client);
+
+private slots:
+    void onFrameSwapped();
+    void onFocusWindowChanged(QWindow* window);
+    void updateStatistics();
+
+private:
+    /// @brief 一个待执行的刷新
+    struct PendingFlush {
+        QPointer<QObject> client;
+        std::function<void()> flush;
+    };
+
+    void requestFrame();
+    void runPendingFlushes();
+    void adaptToFrameTime(double frameTimeMs);
+    bool takePending(QObject* client, std::function<void()>& flush);
+
+    QPointer<QQuickWindow> m_window;
+    QVector<PendingFlush> m_pending;
+    QTimer m_fallbackTimer;             ///< 没有新帧时的兜底刷新
+    QTimer m_statisticsTimer;           ///< 每秒更新一次计数
+    QElapsedTimer m_frameClock;         ///< 从请求帧开始计时
+    bool m_frameRequested;              ///< 已请求帧，等待 frameSwapped
+    int m_framesSinceFlush;
+    int m_flushCount;                   ///< 本统计周期内的刷新次数
+    int m_requestCount;                 ///< 本统计周期内的请求次数
+};
+
+#endif // UIFLUSHSCHEDULER_H
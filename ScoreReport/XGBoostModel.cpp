@@ -0,0 +1,156 @@
+﻿#include "XGBoostModel.h"
+#include <QFile>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QJsonArray>
+#include <QDebug>
+#include <cmath>
+
+XGBoostModel::XGBoostModel()
+    : m_activeTreeCount(0)
+    , m_featureCount(0)
+    , m_baseMargin(0.0f)
+    , m_loaded(false)
+{
+}
+
+bool XGBoostModel::fail(const QString& message)
+{
+    m_errorString = message;
+    m_loaded = false;
+    m_nodes.clear();
+    m_treeRoots.clear();
+    m_activeTreeCount = 0;
+    qWarning() << "[XGBoostModel]" << message;
+    return false;
+}
+
+bool XGBoostModel::load(const QString& modelPath, double baseScore)
+{
+    QFile file(modelPath);
+    if (!file.open(QIODevice::ReadOnly)) {
+        return fail(QStringLiteral("无法打开模型文件: %1").arg(modelPath));
+    }
+
+    QJsonParseError parseError;
+    QJsonDocument doc = QJsonDocument::fromJson(file.readAll(), &parseError);
+    file.close();
+    if (!doc.isObject()) {
+        return fail(QStringLiteral("模型文件解析失败: %1").arg(parseError.errorString()));
+    }
+
+    QJsonObject learner = doc.object().value("learner").toObject();
+    QString objective = learner.value("objective").toObject().value("name").toString();
+    if (objective != "binary:logistic") {
+        return fail(QStringLiteral("不支持的目标函数: %1").arg(objective));
+    }
+
+    QJsonObject learnerParam = learner.value("learner_model_param").toObject();
+    m_featureCount = learnerParam.value("num_feature").toString().toInt();
+
+    // base_score 在JSON中以概率形式保存，推理时需要转换为 margin
+    float prob = baseScore > 0.0 ? static_cast<float>(baseScore)
+                                 : learnerParam.value("base_score").toString().toFloat();
+    if (prob <= 0.0f || prob >= 1.0f) {
+        return fail(QStringLiteral("base_score 非法: %1").arg(prob));
+    }
+    m_baseMargin = -std::log(1.0f / prob - 1.0f);
+
+    QJsonObject gbtree = learner.value("gradient_booster").toObject();
+    if (gbtree.value("name").toString() != "gbtree") {
+        return fail(QStringLiteral("不支持的booster类型: %1").arg(gbtree.value("name").toString()));
+    }
+    QJsonObject model = gbtree.value("model").toObject();
+    QJsonArray trees = model.value("trees").toArray();
+
+    m_nodes.clear();
+    m_treeRoots.clear();
+    m_treeRoots.reserve(trees.size());
+
+    for (const QJsonValue& treeValue : trees) {
+        QJsonObject tree = treeValue.toObject();
+        QJsonArray leftChildren = tree.value("left_children").toArray();
+        QJsonArray rightChildren = tree.value("right_children").toArray();
+        QJsonArray splitIndices = tree.value("split_indices").toArray();
+        QJsonArray splitConditions = tree.value("split_conditions").toArray();
+        QJsonArray defaultLeft = tree.value("default_left").toArray();
+        QJsonArray splitType = tree.value("split_type").toArray();
+
+        const int nodeCount = leftChildren.size();
+        if (nodeCount == 0 || rightChildren.size() != nodeCount || splitIndices.size() != nodeCount
+            || splitConditions.size() != nodeCount || defaultLeft.size() != nodeCount) {
+            return fail(QStringLiteral("树结构不完整: tree %1").arg(m_treeRoots.size()));
+        }
+
+        const int offset = m_nodes.size();
+        m_treeRoots.append(offset);
+        for (int i = 0; i < nodeCount; ++i) {
+            if (splitType.at(i).toInt() != 0) {
+                return fail(QStringLiteral("不支持类别型分裂: tree %1").arg(m_treeRoots.size() - 1));
+            }
+
+            Node node;
+            int left = leftChildren.at(i).toInt();
+            int right = rightChildren.at(i).toInt();
+            node.leftChild = left < 0 ? -1 : offset + left;
+            node.rightChild = right < 0 ? -1 : offset + right;
+            node.splitIndex = splitIndices.at(i).toInt();
+            node.splitCondition = static_cast<float>(splitConditions.at(i).toDouble());
+            node.defaultLeft = defaultLeft.at(i).toInt() != 0;
+
+            if (node.leftChild >= 0 && (node.splitIndex < 0 || node.splitIndex >= m_featureCount)) {
+                return fail(QStringLiteral("分裂特征越界: tree %1").arg(m_treeRoots.size() - 1));
+            }
+            m_nodes.append(node);
+        }
+    }
+
+    if (m_treeRoots.isEmpty()) {
+        return fail(QStringLiteral("模型中没有树"));
+    }
+
+    // XGBClassifier.predict_proba 默认只使用 best_iteration 之前的树（早停模型）
+    m_activeTreeCount = m_treeRoots.size();
+    QString bestIteration = learner.value("attributes").toObject().value("best_iteration").toString();
+    if (!bestIteration.isEmpty()) {
+        int rounds = bestIteration.toInt() + 1;
+        QJsonArray indptr = model.value("iteration_indptr").toArray();
+        if (rounds < indptr.size()) {
+            m_activeTreeCount = indptr.at(rounds).toInt();
+        } else if (indptr.isEmpty()) {
+            int parallel = model.value("gbtree_model_param").toObject().value("num_parallel_tree").toString().toInt();
+            m_activeTreeCount = qMin(m_treeRoots.size(), rounds * qMax(parallel, 1));
+        }
+    }
+
+    m_errorString.clear();
+    m_loaded = true;
+    qDebug() << "[XGBoostModel] Loaded" << modelPath << "trees:" << m_treeRoots.size()
+             << "active:" << m_activeTreeCount << "features:" << m_featureCount;
+    return true;
+}
+
+float XGBoostModel::predictProbability(const float* features) const
+{
+    if (!m_loaded) {
+        return -1.0f;
+    }
+
+    float margin = m_baseMargin;
+    const Node* nodes = m_nodes.constData();
+    for (int t = 0; t < m_activeTreeCount; ++t) {
+        int index = m_treeRoots[t];
+        while (nodes[index].leftChild >= 0) {
+            const Node& node = nodes[index];
+            float value = features[node.splitIndex];
+            if (std::isnan(value)) {
+                index = node.defaultLeft ? node.leftChild : node.rightChild;
+            } else {
+                index = value < node.splitCondition ? node.leftChild : node.rightChild;
+            }
+        }
+        margin += nodes[index].splitCondition;
+    }
+
+    return 1.0f / (1.0f + std::exp(-margin));
+}
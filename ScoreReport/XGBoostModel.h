@@ -0,0 +1,65 @@
+﻿#ifndef XGBOOSTMODEL_H
+#define XGBOOSTMODEL_H
+
+#include <QString>
+#include <QVector>
+
+/**
+ * @brief XGBoost树模型推理类 - 在进程内直接计算二分类概率
+ *
+ * 读取 XGBoost save_model 导出的 JSON 模型（gbtree + binary:logistic），
+ * 将所有树展平为连续的节点数组，推理时只做比较和跳转，不依赖Python运行时。
+ *
+ * 与 Python 端 XGBClassifier.predict_proba 保持一致：
+ * - 特征值与分裂阈值均按 float 比较（fvalue < split_condition 走左子树）
+ * - 模型带有 best_iteration 属性时只使用前 best_iteration+1 轮的树
+ * - 输出 = sigmoid(logit(base_score) + Σ叶子权重)，按 float 累加
+ */
+class XGBoostModel
+{
+public:
+    XGBoostModel();
+
+    /**
+     * @brief 加载JSON格式的XGBoost模型
+     * @param modelPath 模型文件路径
+     * @param baseScore 覆盖模型中的base_score（概率值），小于等于0时使用模型自带值
+     * @return 是否加载成功，失败原因可通过 errorString() 获取
+     */
+    bool load(const QString& modelPath, double baseScore = 0.0);
+
+    /**
+     * @brief 计算正类概率
+     * @param features 特征数组，长度必须等于 featureCount()
+     * @return 正类概率；模型未加载时返回 -1
+     */
+    float predictProbability(const float* features) const;
+
+    bool isLoaded() const { return m_loaded; }
+    int featureCount() const { return m_featureCount; }
+    int treeCount() const { return m_treeRoots.size(); }
+    int activeTreeCount() const { return m_activeTreeCount; }
+    QString errorString() const { return m_errorString; }
+
+private:
+    /// @brief 展平后的树节点，叶子节点的 leftChild 为 -1，splitCondition 存放叶子权重
+    struct Node {
+        int leftChild;
+        int rightChild;
+        int splitIndex;
+        float splitCondition;
+        bool defaultLeft;
+    };
+
+    bool fail(const QString& message);
+
+    QVector<Node> m_nodes;          ///< 所有树的节点，子节点索引为全局索引
+    QVector<int> m_treeRoots;       ///< 每棵树根节点在 m_nodes 中的位置
+    int m_activeTreeCount;          ///< 推理时实际参与累加的树数量
+    int m_featureCount;
+    float m_baseMargin;             ///< logit(base_score)
+    bool m_loaded;
+    QString m_errorString;
+};
+
+#endif // XGBOOSTMODEL_H
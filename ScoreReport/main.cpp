@@ -1,14 +1,19 @@
 ﻿#include <QGuiApplication>
 #include <QQmlApplicationEngine>
 #include <QQmlContext>
+#include <QQuickWindow>
 #include <QFontDatabase>
 #include <QDebug>
 #include <QDateTime>
 #include <QDir>
+#include <QDirIterator>
+#include <QElapsedTimer>
 #include <QFile>
-#include <QTextStream>
+#include <QFileInfo>
+#include <QJsonDocument>
+#include <QJsonObject>
 #include <QStandardPaths>
-#include <QMutex>
+#include <QTemporaryDir>
 #include <QThread>
 #include <QSharedMemory>
 #include <QSystemSemaphore>
@@ -29,50 +34,32 @@
 #include "KnowledgeManager.h"
 #include "KnowledgeChatManager.h"
 #include "DiagnosisResultManager.h"
-// 全局日志文件指针和互斥锁
-static QFile* g_logFile = nullptr;
-static QTextStream* g_logStream = nullptr;
-static QMutex g_logMutex;
-
+#include "DocxReader.h"
+#include "ChatMessageModel.h"
+#include "UiFlushScheduler.h"
+#include "AsyncLogger.h"
+#include "LogArchiver.h"
+#include "LogCategories.h"
 /**
- * @brief 自定义消息处理器 - 将日志同时输出到文件和控制台
- * @param type 消息类型
- * @param context 消息上下文
- * @param msg 消息内容
+ * @brief 读取config.json的logging节
+ * @return logging节，配置文件不存在时为空对象（使用默认值）
  */
-void customMessageOutput(QtMsgType type, const QMessageLogContext &context, const QString &msg)
+QJsonObject loadLoggingConfig()
 {
-    QMutexLocker locker(&g_logMutex);
-    
-    // 格式化时间戳
-    QString timestamp = QDateTime::currentDateTime().toString("yyyy-MM-dd hh:mm:ss.zzz");
-    
-    // 确定消息类型字符串
-    QString typeStr;
-    switch (type) {
-    case QtDebugMsg:    typeStr = "DEBUG"; break;
-    case QtWarningMsg:  typeStr = "WARN "; break;
-    case QtCriticalMsg: typeStr = "CRIT "; break;
-    case QtFatalMsg:    typeStr = "FATAL"; break;
-    case QtInfoMsg:     typeStr = "INFO "; break;
-    }
-    
-    // 格式化日志消息
-    QString formattedMsg = QStringLiteral("[%1] [%2] %3").arg(timestamp, typeStr, msg);
-    
-    // 输出到控制台（保持原有行为）
-    fprintf(stderr, "%s\n", formattedMsg.toLocal8Bit().constData());
-    
-    // 输出到文件
-    if (g_logStream) {
-        *g_logStream << formattedMsg << Qt::endl;
-        g_logStream->flush(); // 确保立即写入文件
+    QFile configFile("AppData/config/config.json");
+    if (!configFile.open(QIODevice::ReadOnly)) {
+        return QJsonObject();
     }
+    return QJsonDocument::fromJson(configFile.readAll()).object().value("logging").toObject();
 }
 
 /**
  * @brief 初始化日志系统
  * @return 是否初始化成功
+ *
+ * 日志分段的滚动和保留空间可在config.json的logging节配置：
+ * maxFileSizeMB（单个分段大小，默认10）、maxFileAgeHours（单个分段时长，默认24）、
+ * retentionMB（所有分段总大小，默认200）。各分类的级别见 LogCategories。
  */
 bool initializeLogging()
 {
@@ -84,55 +71,157 @@ bool initializeLogging()
         return false;
     }
     
-    // 生成日志文件名（包含时间戳）
-    QString timestamp = QDateTime::currentDateTime().toString("yyyy-MM-dd_hh-mm-ss");
-    QString logFileName = QStringLiteral("ScoreReport_%1.log").arg(timestamp);
-    QString logFilePath = QDir(logDir).filePath(logFileName);
-    
-    // 创建日志文件
-    g_logFile = new QFile(logFilePath);
-    if (!g_logFile->open(QIODevice::WriteOnly | QIODevice::Append)) {
-        qWarning() << "Failed to open log file:" << logFilePath;
-        delete g_logFile;
-        g_logFile = nullptr;
+    QJsonObject loggingObj = loadLoggingConfig();
+    
+    // 各日志分类的运行期级别，config.json修改后自动重新应用
+    LogCategories::applyConfig(loggingObj);
+    LogCategories::watchConfigFile("AppData/config/config.json");
+    qint64 maxFileSize = loggingObj.value("maxFileSizeMB").toInt(10) * qint64(1024 * 1024);
+    qint64 maxFileAgeSecs = loggingObj.value("maxFileAgeHours").toInt(24) * qint64(3600);
+    qint64 retentionBytes = loggingObj.value("retentionMB").toInt(200) * qint64(1024 * 1024);
+    
+    auto* logger = GET_SINGLETON(AsyncLogger);
+    logger->setRotation(maxFileSize, maxFileAgeSecs);
+    GET_SINGLETON(LogArchiver)->configure(logDir, retentionBytes);
+    
+    // 启动异步日志写线程，日志同时输出到文件和控制台
+    if (!logger->start(logDir)) {
+        qWarning() << "Failed to open log file in:" << logDir;
         return false;
     }
     
-    // 创建文本流
-    g_logStream = new QTextStream(g_logFile);
-    g_logStream->setCodec("UTF-8");
+    // 压缩以前运行留下的分段，并清理超出保留空间的旧分段
+    GET_SINGLETON(LogArchiver)->archivePending(logger->filePath());
     
-    // 写入日志启动信息
-    QString startMsg = QStringLiteral("========== ScoreReport Log Started at %1 ==========")
-                       .arg(QDateTime::currentDateTime().toString("yyyy-MM-dd hh:mm:ss"));
-    *g_logStream << startMsg << Qt::endl;
-    g_logStream->flush();
-    
-    qInfo() << "Log system initialized successfully. Log file:" << logFilePath;
+    qInfo() << "Log system initialized successfully. Log file:" << logger->filePath();
     return true;
 }
 
 /**
- * @brief 清理日志系统
+ * @brief 清理日志系统 - 等待后台压缩结束，写完队列中剩余的日志并关闭文件
  */
 void cleanupLogging()
 {
-    if (g_logStream) {
-        QString endMsg = QStringLiteral("========== ScoreReport Log Ended at %1 ==========")
-                         .arg(QDateTime::currentDateTime().toString("yyyy-MM-dd hh:mm:ss"));
-        *g_logStream << endMsg << Qt::endl;
-        g_logStream->flush();
-        
-        delete g_logStream;
-        g_logStream = nullptr;
+    GET_SINGLETON(LogArchiver)->waitForDone();
+    GET_SINGLETON(AsyncLogger)->stop();
+}
+
+#ifdef QT_DEBUG
+/**
+ * @brief CCLS-AI推理结果校验（仅调试版本）：ScoreReport --ccls-golden [基准表路径]
+ * @param csvPath 基准表，由 Scripts/python/make_golden_table.py 调用 kidney_processor.py 生成
+ * @return 144种组合全部一致时返回0
+ */
+int runCclsGoldenCheck(const QString& csvPath)
+{
+    const int mismatches = GET_SINGLETON(CCLSAIScorer)->verifyGoldenTable(csvPath);
+    if (mismatches < 0) {
+        fprintf(stdout, "CCLS-AI golden check could not run: %s\n", csvPath.toLocal8Bit().constData());
+        return 1;
     }
-    
-    if (g_logFile) {
-        g_logFile->close();
-        delete g_logFile;
-        g_logFile = nullptr;
+    fprintf(stdout, "CCLS-AI golden check: %d mismatches\n", mismatches);
+    return mismatches == 0 ? 0 : 1;
+}
+#endif
+
+#ifdef QT_DEBUG
+/**
+ * @brief DOCX读取性能测试（仅调试版本）：ScoreReport --docx-benchmark 目录
+ * @param dirPath 测试文档所在目录，递归查找其中的 .docx 文件
+ * @return 全部文件读取成功时返回0
+ */
+int runDocxBenchmark(const QString& dirPath)
+{
+    QDirIterator it(dirPath, QStringList() << "*.docx", QDir::Files, QDirIterator::Subdirectories);
+    qint64 totalBytes = 0;
+    qint64 totalChars = 0;
+    qint64 totalNs = 0;
+    int fileCount = 0;
+    int failures = 0;
+
+    while (it.hasNext()) {
+        const QString filePath = it.next();
+        const qint64 fileSize = QFileInfo(filePath).size();
+
+        DocxReader reader;
+        QElapsedTimer timer;
+        timer.start();
+        const bool ok = reader.read(filePath);
+        const qint64 ns = timer.nsecsElapsed();
+
+        ++fileCount;
+        if (!ok) {
+            ++failures;
+            fprintf(stdout, "FAILED %s: %s\n", filePath.toLocal8Bit().constData(),
+                    reader.errorString().toLocal8Bit().constData());
+            continue;
+        }
+        totalBytes += fileSize;
+        totalChars += reader.text().size();
+        totalNs += ns;
+        fprintf(stdout, "%10lld bytes %10d chars %9.2f ms  %s\n", fileSize, reader.text().size(),
+                ns / 1e6, filePath.toLocal8Bit().constData());
+    }
+
+    if (fileCount == 0) {
+        fprintf(stdout, "No .docx files found in %s\n", dirPath.toLocal8Bit().constData());
+        return 1;
+    }
+    const double seconds = totalNs / 1e9;
+    fprintf(stdout, "%d files (%d failed), %lld bytes, %lld chars in %.2f ms, %.1f MB/s\n",
+            fileCount, failures, totalBytes, totalChars, totalNs / 1e6,
+            seconds > 0 ? totalBytes / seconds / (1024 * 1024) : 0.0);
+    return failures == 0 ? 0 : 1;
+}
+#endif
+
+#ifdef QT_DEBUG
+/**
+ * @brief 聊天消息模型流式追加基准测试（仅调试版本）：ScoreReport --chat-model-benchmark
+ * @return 进程退出码
+ *
+ * 向会话最后一条消息流式追加10000个token，比较不同消息条数下 appendToLast 和 dataChanged 的耗时。
+ */
+int runChatModelBenchmark()
+{
+    for (int messageCount : {1, 50, 100, 200}) {
+        ChatMessageModel::runBenchmark(messageCount, 10000);
+    }
+    return 0;
+}
+#endif
+
+#ifdef QT_DEBUG
+/**
+ * @brief 日志性能基准测试（仅调试版本）：ScoreReport --log-benchmark
+ * @return 进程退出码
+ *
+ * 日志写入临时目录并在结束后删除，不会触发 AppData/logs 的分段滚动，也不会挤占真实日志的保留空间。
+ */
+int runLogBenchmark()
+{
+    QTemporaryDir tempDir;
+    if (!tempDir.isValid()) {
+        fprintf(stderr, "Failed to create temporary log directory\n");
+        return 1;
+    }
+
+    auto* logger = GET_SINGLETON(AsyncLogger);
+    GET_SINGLETON(LogArchiver)->configure(tempDir.path(), 1024 * 1024 * 1024);
+    if (!logger->start(tempDir.path())) {
+        fprintf(stderr, "Failed to open log file in: %s\n", tempDir.path().toLocal8Bit().constData());
+        return 1;
     }
+
+    qInstallMessageHandler(AsyncLogger::messageHandler);
+    for (int threadCount : {1, 2, 4, 8}) {
+        AsyncLogger::runBenchmark(threadCount, 100000);
+    }
+    qInstallMessageHandler(nullptr);
+    cleanupLogging();
+    return 0;
 }
+#endif
 
 int main(int argc, char *argv[])
 {
@@ -145,6 +234,47 @@ int main(int argc, char *argv[])
 
     QGuiApplication app(argc, argv);
     
+    // CCLS-AI推理结果与Python脚本的一致性校验（仅调试版本）
+#ifdef QT_DEBUG
+    int goldenIndex = app.arguments().indexOf("--ccls-golden");
+    if (goldenIndex >= 0) {
+        return runCclsGoldenCheck(goldenIndex + 1 < app.arguments().size()
+            ? app.arguments().at(goldenIndex + 1) : QStringLiteral("Scripts/model/ccls_ai_golden.csv"));
+    }
+#endif
+    
+    // DOCX正文读取吞吐量测试（仅调试版本）
+#ifdef QT_DEBUG
+    int docxIndex = app.arguments().indexOf("--docx-benchmark");
+    if (docxIndex >= 0 && docxIndex + 1 < app.arguments().size()) {
+        return runDocxBenchmark(app.arguments().at(docxIndex + 1));
+    }
+#endif
+    
+    // 检索日志（含压缩分段）：ScoreReport --log-search 文本
+    int searchIndex = app.arguments().indexOf("--log-search");
+    if (searchIndex >= 0 && searchIndex + 1 < app.arguments().size()) {
+        const QStringList lines = LogArchiver::search("AppData/logs", app.arguments().at(searchIndex + 1));
+        for (const QString& line : lines) {
+            fprintf(stdout, "%s\n", line.toLocal8Bit().constData());
+        }
+        return 0;
+    }
+    
+    // 聊天消息模型流式追加基准测试（仅调试版本）
+#ifdef QT_DEBUG
+    if (app.arguments().contains("--chat-model-benchmark")) {
+        return runChatModelBenchmark();
+    }
+#endif
+    
+    // 日志性能基准测试（仅调试版本），使用临时日志目录
+#ifdef QT_DEBUG
+    if (app.arguments().contains("--log-benchmark")) {
+        return runLogBenchmark();
+    }
+#endif
+    
     // 单实例检查 - 使用共享内存确保只能运行一个实例
     // 使用系统信号量来处理崩溃情况
     const QString semaphoreKey = "ScoreReportSingleInstanceSemaphore";
@@ -238,8 +368,8 @@ int main(int argc, char *argv[])
         qCritical() << "Failed to initialize logging system";
     }
     
-    // 安装自定义消息处理器
-    qInstallMessageHandler(customMessageOutput);
+    // 安装异步日志消息处理器，调用线程只入队不写文件
+    qInstallMessageHandler(AsyncLogger::messageHandler);
     
     // 设置应用程序信息，解决FileDialog的QSettings错误
     QCoreApplication::setOrganizationName("AETHERMIND");
@@ -296,6 +426,10 @@ int main(int argc, char *argv[])
     auto* knowledgeChatManager = new KnowledgeChatManager();
     engine.rootContext()->setContextProperty("$knowledgeChatManager", knowledgeChatManager);
 
+    // 流式文本按渲染帧刷新UI，计数器供QML显示
+    auto* uiFlushScheduler = GET_SINGLETON(UiFlushScheduler);
+    engine.rootContext()->setContextProperty("$uiFlushScheduler", uiFlushScheduler);
+
     // 初始化语言管理器
     auto* languageManager = GET_SINGLETON(LanguageManager);
     languageManager->initializeTranslator(&engine);
@@ -312,8 +446,10 @@ int main(int argc, char *argv[])
             sharedMemory->detach();
             delete sharedMemory;
         }
+        cleanupLogging();
         return -1;
     }
+    uiFlushScheduler->attachWindow(qobject_cast<QQuickWindow*>(engine.rootObjects().first()));
     
     int result = app.exec();
     
@@ -324,5 +460,6 @@ int main(int argc, char *argv[])
         delete sharedMemory;
     }
     
+    cleanupLogging();
     return result;
 }
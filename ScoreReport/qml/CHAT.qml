@@ -57,7 +57,7 @@ Rectangle {
             width: parent.width
             height: chatManager.files.length > 0 ? 518 - 24 : 630 - 12  // 调整以适应新的文件列表高度
             color: "transparent"
-            visible: !specialPage || chatManager.messages.length > 0
+            visible: !specialPage || chatManager.messages.count > 0
             ScrollView {
                 id: scrollView
                 anchors.fill: parent
@@ -75,18 +75,18 @@ Rectangle {
                         delegate: Column {
                             id: messageItem
                             width: messageBubble.width
-                            anchors.right: modelData.type === "user" ? parent.right : undefined
-                            anchors.rightMargin: modelData.type === "user" ? 24 : 0
-                            anchors.left: (modelData.type === "ai" || modelData.type === "thinking" || modelData.type === "interrupt") ? parent.left : undefined
-                            anchors.leftMargin: (modelData.type === "ai" || modelData.type === "thinking" || modelData.type === "interrupt") ? 24 : 0
+                            anchors.right: model.type === "user" ? parent.right : undefined
+                            anchors.rightMargin: model.type === "user" ? 24 : 0
+                            anchors.left: (model.type === "ai" || model.type === "thinking" || model.type === "interrupt") ? parent.left : undefined
+                            anchors.leftMargin: (model.type === "ai" || model.type === "thinking" || model.type === "interrupt") ? 24 : 0
                             spacing: 8
                             
                             // 消息气泡
                             Rectangle {
                                 id: messageBubble
-                                width: (modelData.type !== "thinking" && modelData.type !== "interrupt") ? messageContent.width : thinkingRow.width
-                                height: (modelData.type !== "thinking" && modelData.type !== "interrupt") ? messageContent.height : thinkingRow.height
-                                color: modelData.type === "user" ? "#F5F5F5" : "transparent"
+                                width: (model.type !== "thinking" && model.type !== "interrupt") ? messageContent.width : thinkingRow.width
+                                height: (model.type !== "thinking" && model.type !== "interrupt") ? messageContent.height : thinkingRow.height
+                                color: model.type === "user" ? "#F5F5F5" : "transparent"
                                 radius: 12
                                 
                                 // 普通消息内容
@@ -94,14 +94,14 @@ Rectangle {
                                     id: messageContent
                                     anchors.centerIn: parent
                                     width: Math.min(implicitWidth, messagesColumn.width - 48)
-                                    text: (modelData.type === "thinking" || modelData.type === "interrupt") ? "" : modelData.content
-                                    padding: modelData.type === "user" ? 12 : 0
+                                    text: (model.type === "thinking" || model.type === "interrupt") ? "" : model.content
+                                    padding: model.type === "user" ? 12 : 0
                                     font.family: "Alibaba PuHuiTi 3.0"
                                     font.pixelSize: 16
                                     color: "#D9000000"
                                     wrapMode: Text.Wrap
                                     textFormat: Text.MarkdownText
-                                    visible: (modelData.type !== "thinking" && modelData.type !== "interrupt")
+                                    visible: (model.type !== "thinking" && model.type !== "interrupt")
                                 }
                                 
                                 // 思考中动画
@@ -109,10 +109,10 @@ Rectangle {
                                     id: thinkingRow
                                     anchors.centerIn: parent
                                     spacing: 2
-                                    visible: modelData.type === "thinking" || modelData.type === "interrupt"
+                                    visible: model.type === "thinking" || model.type === "interrupt"
                                     
                                     Text {
-                                        text: qsTr(modelData.content)
+                                        text: qsTr(model.content)
                                          font.weight: Font.Bold
                                         font.family: "Alibaba PuHuiTi 3.0"
                                         font.pixelSize: 16
@@ -123,7 +123,7 @@ Rectangle {
                                         id: dots
                                         text: "."
                                         font.weight: Font.Bold
-                                        visible: modelData.type === "thinking"
+                                        visible: model.type === "thinking"
                                         font.family: "Alibaba PuHuiTi 3.0"
                                         font.pixelSize: 16
                                         color: "#D9000000"
@@ -131,7 +131,7 @@ Rectangle {
                                         Timer {
                                             id: dotsTimer
                                             interval: 500
-                                            running: modelData.type === "thinking"
+                                            running: model.type === "thinking"
                                             repeat: true
                                             property int dotCount: 1
                                             
@@ -148,7 +148,7 @@ Rectangle {
                             Row {
                                 id: actionButtons
                                 spacing: 4
-                                visible: modelData.type === "ai" && index === (chatManager.messages.length - 1) && !chatManager.isSending && index !== 0
+                                visible: model.type === "ai" && index === (chatManager.messages.count - 1) && !chatManager.isSending && index !== 0
                                 
                                 Rectangle {
                                     id: regenerateBtn
@@ -218,7 +218,7 @@ Rectangle {
                                         anchors.fill: parent
                                         cursorShape: Qt.PointingHandCursor
                                         onClicked: {
-                                            chatManager.copyToClipboard(modelData.content)
+                                            chatManager.copyToClipboard(model.content)
                                             messageManager.success("已复制！")
                                         }
                                         onPressed: parent.scale = 0.9
@@ -708,13 +708,25 @@ Rectangle {
         return hasExtension && isPath
     }
 
-    // 监听消息变化，自动滚动到底部
+    // 监听消息变化，自动滚动到底部：新增消息、流式回答追加文本、消息增删时都滚动
     Connections {
-        target: chatManager
-        function onMessagesChanged() {
+        target: chatManager ? chatManager.messages : null
+        function onRowsInserted() {
             scrollToBottom.start()
         }
-        
+
+        function onDataChanged() {
+            scrollToBottom.start()
+        }
+
+        function onCountChanged() {
+            scrollToBottom.start()
+        }
+    }
+
+    // 监听文件操作结果
+    Connections {
+        target: chatManager
         function onFileOperationResult(message, type) {
             if (messageManager) {
                 switch(type) {
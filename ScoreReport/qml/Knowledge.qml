@@ -91,7 +91,15 @@ Rectangle {
             }
         }
         
+        function onDuplicateFilesSkipped(fileNames) {
+            messageManager.warning("已跳过 " + fileNames.length + " 个知识库中已有的文件")
+        }
+        
         function onBatchUploadCompleted(successCount, totalCount, message) {
+            if(totalCount === 0){
+                // 选择的文件都已在知识库中，跳过时已提示
+                return
+            }
             if(successCount === totalCount){
                 messageManager.success("批量上传完成！成功上传 " + successCount + " 个文件")
             }else if(successCount > 0){